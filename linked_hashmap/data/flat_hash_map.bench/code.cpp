@@ -0,0 +1,79 @@
+// flat_hash_map benchmark: insert, hit and miss lookups and erase of random 64-bit keys,
+// against linked_hashmap and std::unordered_map, from 1K entries up to max_entries by powers of ten.
+// the node based maps take about 60 bytes an entry and stop at 10M, flat_hash_map goes on (100M needs about 2.5GB)
+// usage: ./code [max_entries]
+
+#include "flat_hash_map.hpp"
+#include "linked_hashmap.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// a bijection, so key(2i) are the n keys in the map and key(2i + 1) never are
+static inline unsigned long long key(unsigned long long i) {
+    unsigned long long z = i + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// std::unordered_map behind the interface the other two share
+struct std_map : std::unordered_map<unsigned long long, unsigned long long> {
+    typedef std::unordered_map<unsigned long long, unsigned long long> base;
+    void erase(base::iterator it) { base::erase(it); }
+};
+
+// lookups and erasure go through the keys in a scattered order, i * stride mod n
+static size_t stride_for(size_t n) {
+    size_t s = 1000003;
+    while (n % s == 0) s += 2;
+    return s % n ? s % n : 1;
+}
+
+template<class Map>
+void bench(const char *name, size_t n) {
+    // small maps are built again and again, so that every measurement covers at least 4M operations
+    size_t reps = n < 4000000 ? 4000000 / n : 1, stride = stride_for(n);
+    double ins = 0, hit = 0, miss = 0, era = 0;
+    unsigned long long sum = 0;
+    for (size_t r = 0; r < reps; ++r) {
+        Map map;
+        ins += timeit([&] {
+            for (size_t i = 0; i < n; ++i) map[key(2 * i)] = i;
+        });
+        hit += timeit([&] {
+            for (size_t i = 0, j = 0; i < n; ++i, j = (j + stride) % n) sum += map.find(key(2 * j))->second;
+        });
+        miss += timeit([&] {
+            for (size_t i = 0, j = 0; i < n; ++i, j = (j + stride) % n) sum += map.count(key(2 * j + 1));
+        });
+        era += timeit([&] {
+            for (size_t i = 0, j = 0; i < n; ++i, j = (j + stride) % n) map.erase(map.find(key(2 * j)));
+        });
+        if (map.size()) std::printf("not empty\n");
+    }
+    double ops = (double) n * reps;
+    std::printf("%10zu  %-20s insert %6.1f  hit %6.1f  miss %6.1f  erase %6.1f  ns/op  (%llu)\n",
+                n, name, ins / ops, hit / ops, miss / ops, era / ops, sum);
+}
+
+int main(int argc, char *argv[]) {
+    size_t max_entries = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    std::printf("random 64-bit keys and values\n");
+    for (size_t n = 1000; n <= max_entries; n *= 10) {
+        bench<sjtu::flat_hash_map<unsigned long long, unsigned long long> >("flat_hash_map", n);
+        if (n > 10000000) continue;
+        bench<sjtu::linked_hashmap<unsigned long long, unsigned long long> >("linked_hashmap", n);
+        bench<std_map>("std::unordered_map", n);
+    }
+    return 0;
+}
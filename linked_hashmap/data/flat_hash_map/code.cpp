@@ -0,0 +1,250 @@
+// correctness of flat_hash_map against std::unordered_map: insert and erase churn through tombstones,
+// a hasher that sends every key to one group, reserve and clear, copies, try_emplace and insert_or_assign
+#include "flat_hash_map.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+void report(int id, const char *title, bool ok) {
+	printf("Test %d: %-55s%s\n", id, title, ok ? "PASSED" : "FAILED");
+}
+
+// counts its live objects to catch leaks and double destruction
+class Counted {
+public:
+	static int counter;
+	int val;
+	Counted(int val = 0) : val(val) {
+		counter++;
+	}
+	Counted(const Counted &rhs) : val(rhs.val) {
+		counter++;
+	}
+	Counted &operator=(const Counted &rhs) {
+		val = rhs.val;
+		return *this;
+	}
+	~Counted() {
+		counter--;
+	}
+};
+
+int Counted::counter = 0;
+
+struct same_hash {
+	size_t operator()(int) const {
+		return 42;
+	}
+};
+
+template<class Map>
+bool same(Map &map, const std::unordered_map<int, int> &ref) {
+	if (map.size() != ref.size() || map.empty() != ref.empty()) return false;
+	std::vector<std::pair<int, int>> got, expected(ref.begin(), ref.end());
+	for (typename Map::const_iterator it = map.cbegin(); it != map.cend(); ++it) got.push_back(std::make_pair(it->first, (int)it->second.val));
+	// and backwards from end()
+	size_t n = 0;
+	for (typename Map::iterator it = map.end(); it != map.begin();) {
+		--it;
+		n++;
+		if (!ref.count(it->first)) return false;
+	}
+	std::sort(got.begin(), got.end());
+	std::sort(expected.begin(), expected.end());
+	return n == ref.size() && got == expected;
+}
+
+template<class Map>
+bool churn(Map &map, int range, int ops, unsigned seed) {
+	std::mt19937 rng(seed);
+	std::unordered_map<int, int> ref;
+	for (int op = 0; op < ops; op++) {
+		int key = (int)(rng() % range);
+		switch (rng() % 5) {
+		case 0:
+		case 1: {
+			sjtu::pair<typename Map::iterator, bool> r = map.insert(typename Map::value_type(key, Counted(op)));
+			bool inserted = ref.insert(std::make_pair(key, op)).second;
+			if (r.second != inserted || r.first->first != key || r.first->second.val != ref[key]) return false;
+			break;
+		}
+		case 2:
+			if (map.count(key)) {
+				map.erase(map.find(key));
+				ref.erase(key);
+			} else if (ref.count(key)) {
+				return false;
+			}
+			break;
+		case 3:
+			map[key].val = op;
+			ref[key] = op;
+			break;
+		default:
+			if (map.count(key) != ref.count(key)) return false;
+			if (ref.count(key) && map.at(key).val != ref[key]) return false;
+		}
+		if (op % 10007 == 0 && !same(map, ref)) return false;
+	}
+	return same(map, ref);
+}
+
+// a small key range keeps the size flat, so the tombstones pile up and get dropped by rehashes in place
+bool test_tombstones() {
+	{
+		sjtu::flat_hash_map<int, Counted> small, large;
+		if (!churn(small, 100, 300000, 1) || !churn(large, 50000, 300000, 2)) return false;
+		// erase everything in slot order, then refill
+		while (!small.empty()) small.erase(small.begin());
+		if (!churn(small, 1000, 50000, 3)) return false;
+	}
+	return Counted::counter == 0;
+}
+
+bool test_degenerate_hash() {
+	{
+		sjtu::flat_hash_map<int, Counted, same_hash> map;
+		if (!churn(map, 600, 30000, 4)) return false;
+	}
+	return Counted::counter == 0;
+}
+
+bool test_reserve_and_clear() {
+	sjtu::flat_hash_map<int, Counted> map;
+	map.reserve(5000);
+	map[0] = Counted(-1);
+	// no insertion within the reserved room rehashes, so the element stays where it is
+	const Counted *first = &map.at(0);
+	for (int i = 1; i < 5000; i++) map[i] = Counted(i);
+	if (&map.at(0) != first || map.size() != 5000) return false;
+	map.clear();
+	if (!map.empty() || map.begin() != map.end() || map.count(0) || Counted::counter != 0) return false;
+	std::unordered_map<int, int> ref;
+	for (int i = 0; i < 3000; i++) {
+		map[i * 7] = Counted(i);
+		ref[i * 7] = i;
+	}
+	for (int i = 0; i < 3000; i += 2) {
+		map.erase(map.find(i * 7));
+		ref.erase(i * 7);
+	}
+	// reserving drops the tombstones too
+	map.reserve(10000);
+	first = &map.at(7);
+	for (int i = 3000; i < 9000; i++) {
+		map[i * 7] = Counted(i);
+		ref[i * 7] = i;
+	}
+	if (&map.at(7) != first || !same(map, ref)) return false;
+	sjtu::flat_hash_map<int, Counted> empty;
+	empty.clear();
+	empty.reserve(0);
+	return empty.empty() && empty.begin() == empty.end();
+}
+
+bool test_copy() {
+	{
+		std::unordered_map<int, int> ref;
+		sjtu::flat_hash_map<int, Counted> map;
+		for (int i = 0; i < 4000; i++) {
+			map[i] = Counted(i);
+			ref[i] = i;
+		}
+		for (int i = 0; i < 4000; i += 3) {
+			map.erase(map.find(i));
+			ref.erase(i);
+		}
+		sjtu::flat_hash_map<int, Counted> copy(map), other;
+		other[-1] = Counted(-1);
+		other = copy;
+		other = other;
+		for (int i = 0; i < 4000; i++) copy[i].val = -i;
+		map.clear();
+		if (!same(other, ref) || copy.size() != 4000 || !map.empty()) return false;
+		map = copy;
+		copy.clear();
+		for (int i = 0; i < 4000; i++) {
+			if (map.at(i).val != -i) return false;
+		}
+		sjtu::flat_hash_map<int, Counted, same_hash> narrow, wide;
+		for (int i = 0; i < 300; i++) narrow[i] = Counted(i);
+		wide = narrow;
+		narrow.erase(narrow.find(150));
+		if (wide.size() != 300 || narrow.size() != 299 || wide.at(150).val != 150) return false;
+	}
+	return Counted::counter == 0;
+}
+
+bool test_try_emplace_and_assign() {
+	typedef sjtu::flat_hash_map<std::string, std::string> smap;
+	typedef sjtu::pair<smap::iterator, bool> result;
+	smap map;
+	std::string value = "first";
+	result r1 = map.try_emplace("key", std::move(value));
+	if (!r1.second || r1.first->second != "first" || !value.empty()) return false;
+	// the key exists, so the argument is left alone
+	value = "second";
+	result r2 = map.try_emplace("key", std::move(value));
+	if (r2.second || r2.first->second != "first" || value != "second") return false;
+	std::string key = "other";
+	result r3 = map.try_emplace(std::move(key), 3, 'x');
+	if (!r3.second || r3.first->second != "xxx" || map.at("other") != "xxx") return false;
+	result r4 = map.insert_or_assign("key", value);
+	if (r4.second || r4.first->second != "second" || map.size() != 2) return false;
+	result r5 = map.insert_or_assign(std::string("new"), "third");
+	if (!r5.second || map.at("new") != "third" || map.size() != 3) return false;
+	result r6 = map.emplace("key", "fourth");
+	if (r6.second || map.at("key") != "second") return false;
+	// enough to rehash in between
+	for (int i = 0; i < 1000; i++) {
+		std::string k = "k" + std::to_string(i);
+		if (!map.try_emplace(k, k).second || map.insert_or_assign(k, k + "!").second) return false;
+	}
+	for (int i = 0; i < 1000; i++) {
+		std::string k = "k" + std::to_string(i);
+		if (map.at(k) != k + "!") return false;
+	}
+	return map.size() == 1003;
+}
+
+bool test_errors() {
+	sjtu::flat_hash_map<int, int> map, other;
+	map[1] = 1;
+	try {
+		map.at(2);
+		return false;
+	} catch (sjtu::index_out_of_bound &) {}
+	try {
+		map.erase(map.end());
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		map.erase(other.begin());
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		sjtu::flat_hash_map<int, int>::iterator it = map.end();
+		++it;
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		sjtu::flat_hash_map<int, int>::iterator it = map.begin();
+		--it;
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	return true;
+}
+
+int main() {
+	report(1, "Insert and erase churn through tombstones...", test_tombstones());
+	report(2, "A hasher that sends every key to one group...", test_degenerate_hash());
+	report(3, "Reserve and clear...", test_reserve_and_clear());
+	report(4, "Copy constructor and operator = testing...", test_copy());
+	report(5, "try_emplace, insert_or_assign and emplace...", test_try_emplace_and_assign());
+	report(6, "Exceptions...", test_errors());
+	return 0;
+}
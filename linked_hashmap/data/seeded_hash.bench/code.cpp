@@ -0,0 +1,63 @@
+// seeded hash benchmark: linked_hashmap with std::hash and with a hasher that keeps a random seed,
+// on random keys and on keys that are all multiples of the final bucket count,
+// which std::hash (the identity on integers) sends to one bucket
+// usage: ./code [keys]
+
+#include "linked_hashmap.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// the splitmix64 finalizer over key + seed, the seed is per map and unknown to whoever chooses the keys
+struct seeded_hash {
+    unsigned long long seed;
+    explicit seeded_hash(unsigned long long seed = 0) : seed(seed) {}
+    size_t operator()(long long x) const {
+        unsigned long long z = (unsigned long long) x + seed;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+};
+
+template<class Map>
+void bench(const char *name, Map map, const std::vector<long long> &keys) {
+    long long sum = 0;
+    double ins = timeit([&] {
+        for (size_t i = 0; i < keys.size(); ++i) map[keys[i]] = (long long) i;
+    });
+    double look = timeit([&] {
+        for (size_t i = 0; i < keys.size(); ++i) sum += map.at(keys[i]);
+    });
+    std::printf("%-28s insert %9.1f ms  lookup %9.1f ms  (%lld)\n", name, ins, look, sum);
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 50000;
+    std::mt19937_64 rng(42);
+    std::vector<long long> random_keys(n), bad_keys(n);
+    for (int i = 0; i < n; ++i) random_keys[i] = (long long) (rng() >> 1);
+    // up to 75002 keys linked_hashmap ends with 100003 buckets
+    for (int i = 0; i < n; ++i) bad_keys[i] = 100003LL * i;
+    unsigned long long seed = ((unsigned long long) std::random_device()() << 32) | std::random_device()();
+
+    typedef sjtu::linked_hashmap<long long, long long> plain_map;
+    typedef sjtu::linked_hashmap<long long, long long, seeded_hash> seeded_map;
+    std::printf("%d keys, sizeof: std::hash %zu, seeded_hash %zu\n", n, sizeof(plain_map), sizeof(seeded_map));
+    bench("random, std::hash", plain_map(), random_keys);
+    bench("random, seeded_hash", seeded_map(seeded_hash(seed)), random_keys);
+    bench("colliding, std::hash", plain_map(), bad_keys);
+    bench("colliding, seeded_hash", seeded_map(seeded_hash(seed)), bad_keys);
+    return 0;
+}
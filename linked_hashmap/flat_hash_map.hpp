@@ -0,0 +1,610 @@
+/**
+ * implement an unordered map with open addressing, like a Swiss table
+ */
+#ifndef SJTU_FLAT_HASH_MAP_HPP
+#define SJTU_FLAT_HASH_MAP_HPP
+
+// only for std::equal_to<T> and std::hash<T>
+#include <functional>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace sjtu {
+    /**
+     * a hash map that keeps its elements inline in one array of slots, without nodes or chains.
+     * every slot has a control byte: empty, deleted, or the low 7 bits of the hash of its key.
+     * a lookup probes groups of 16 slots and compares their control bytes with those 7 bits at once
+     *   (with SSE2, or a loop without it), so it usually compares a single key.
+     * an erased slot becomes a tombstone, unless its group still has an empty slot and no probe can have
+     *   passed it. tombstones are dropped at the next rehash.
+     *
+     * the interface is the one of linked_hashmap without the order: iteration goes through the slots.
+     * an insertion may rehash and invalidate every iterator and reference, erasure only the erased ones.
+     */
+    template<
+            class Key,
+            class T,
+            class Hash = std::hash<Key>,
+            class Equal = std::equal_to<Key>
+    > class flat_hash_map : private functor_holder<Hash, 0>, private functor_holder<Equal, 1> {
+    public:
+        typedef pair<const Key, T> value_type;
+    private:
+        typedef signed char ctrl_t;
+        // full slots hold 0 to 127, the free ones have the sign bit set
+        static const ctrl_t empty_ctrl=-128;
+        static const ctrl_t deleted_ctrl=-2;
+        static const size_t group_width=16;
+
+        /**
+         * the control bytes of an aligned group of slots, every match is a bit mask over its slots
+         */
+        struct group{
+#if defined(__SSE2__)
+            __m128i bytes;
+            explicit group(const ctrl_t *p):bytes(_mm_loadu_si128((const __m128i *) p)){}
+            unsigned match(ctrl_t h2) const {
+                return (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8((char) h2),bytes));
+            }
+            unsigned match_free() const {return (unsigned) _mm_movemask_epi8(bytes);}
+#else
+            const ctrl_t *bytes;
+            explicit group(const ctrl_t *p):bytes(p){}
+            unsigned match(ctrl_t h2) const {
+                unsigned res=0;
+                for (size_t i=0;i<group_width;++i)
+                    if (bytes[i]==h2) res|=1u<<i;
+                return res;
+            }
+            unsigned match_free() const {
+                unsigned res=0;
+                for (size_t i=0;i<group_width;++i)
+                    if (bytes[i]<0) res|=1u<<i;
+                return res;
+            }
+#endif
+            unsigned match_empty() const {return match(empty_ctrl);}
+        };
+        static inline size_t lowest_bit(unsigned mask){
+#if defined(__GNUC__)
+            return __builtin_ctz(mask);
+#else
+            size_t i=0;
+            while (!(mask>>i&1)) ++i;
+            return i;
+#endif
+        }
+
+        // one block: capacity slots, then their control bytes
+        value_type *slots;
+        ctrl_t *ctrl;
+        // group_width times a power of two, 0 until the first insertion
+        size_t capacity;
+        size_t length;
+        // the empty slots that may still be taken before a rehash, the load stays at most 7 / 8
+        size_t growth_left;
+
+        /**
+         * the hasher and the key equality of this map, they take no space if they are empty
+         */
+        inline const Hash &hasher() const {return functor_holder<Hash, 0>::get();}
+        inline const Equal &equal() const {return functor_holder<Equal, 1>::get();}
+        static inline size_t max_load(size_t cap) {return cap-cap/8;}
+        inline size_t group_mask() const {return capacity/group_width-1;}
+        /**
+         * the hash of key, mixed because std::hash is the identity on integers:
+         *   the bits from 7 on pick the first group to probe, the low 7 go to the control byte
+         */
+        inline size_t hash_of(const Key &key) const{
+            unsigned long long h=(unsigned long long) hasher()(key)*0x9e3779b97f4a7c15ull;
+            return (size_t) (h^(h>>32));
+        }
+        /**
+         * the slot of key with hash h, capacity if there is none.
+         * the groups are probed at offsets 0, 1, 3, 6, ... from the first one, which visits all of them
+         */
+        size_t find_index(const Key &key,size_t h) const{
+            if (!length) return capacity;
+            size_t g=(h>>7)&group_mask();
+            for (size_t step=1;;++step){
+                group grp(ctrl+g*group_width);
+                for (unsigned m=grp.match((ctrl_t) (h&0x7f));m;m&=m-1){
+                    size_t i=g*group_width+lowest_bit(m);
+                    if (equal()(slots[i].first,key)) return i;
+                }
+                // the key would have been put into this empty slot
+                if (grp.match_empty()) return capacity;
+                g=(g+step)&group_mask();
+            }
+        }
+        size_t find_index(const Key &key) const{
+            return length?find_index(key,hash_of(key)):capacity;
+        }
+        /**
+         * the first empty or deleted slot on the probe sequence of h, there is always one
+         */
+        size_t free_index(size_t h) const{
+            size_t g=(h>>7)&group_mask();
+            for (size_t step=1;;++step){
+                if (unsigned m=group(ctrl+g*group_width).match_free()) return g*group_width+lowest_bit(m);
+                g=(g+step)&group_mask();
+            }
+        }
+        /**
+         * a free slot for a new element with hash h. if it would take an empty slot and none is left,
+         *   rehash first: into twice the slots, or into as many if it is mostly tombstones that fill them
+         */
+        size_t free_slot(size_t h){
+            size_t i;
+            if (capacity&&(ctrl[i=free_index(h)]!=empty_ctrl||growth_left)) return i;
+            if (!capacity) rehash(group_width);
+            else rehash(length+1>max_load(capacity)/2?capacity*2:capacity);
+            return free_index(h);
+        }
+        /**
+         * mark the slot i, which holds a new element with hash h, as full
+         */
+        inline void fill(size_t i,size_t h){
+            if (ctrl[i]==empty_ctrl) --growth_left;
+            ctrl[i]=(ctrl_t) (h&0x7f);
+            ++length;
+        }
+        /**
+         * allocate cap slots, all empty
+         */
+        void allocate(size_t cap){
+            void *block=malloc(cap*(sizeof(value_type)+1));
+            if (!block) throw std::bad_alloc();
+            slots=(value_type *) block;
+            ctrl=(ctrl_t *) (slots+cap);
+            memset(ctrl,empty_ctrl,cap);
+            capacity=cap;
+        }
+        void destroy_values(){
+            if (std::is_trivially_destructible<value_type>::value) return;
+            for (size_t i=0;i<capacity;++i)
+                if (ctrl[i]>=0) slots[i].~value_type();
+        }
+        void destroy(){
+            destroy_values();
+            free(slots);
+            slots=nullptr;
+            ctrl=nullptr;
+            capacity=length=growth_left=0;
+        }
+        /**
+         * move the elements into cap slots, which drops the tombstones.
+         * every key is hashed before the first element moves, and the old slots are only released
+         *   once every element is in place, so a throwing hash or copy (when moving may throw)
+         *   leaves the map as it was
+         */
+        void rehash(size_t cap){
+            size_t *hashes=nullptr;
+            if (length){
+                hashes=(size_t *) malloc(sizeof(size_t)*length);
+                if (!hashes) throw std::bad_alloc();
+                try{
+                    for (size_t i=0,k=0;i<capacity;++i)
+                        if (ctrl[i]>=0) hashes[k++]=hash_of(slots[i].first);
+                }catch (...){
+                    free(hashes);
+                    throw;
+                }
+            }
+            value_type *old_slots=slots;
+            ctrl_t *old_ctrl=ctrl;
+            size_t old_capacity=capacity;
+            try{
+                allocate(cap);
+                for (size_t i=0,k=0;i<old_capacity;++i)
+                    if (old_ctrl[i]>=0){
+                        size_t h=hashes[k++],j=free_index(h);
+                        new(slots+j) value_type(std::move_if_noexcept(old_slots[i]));
+                        ctrl[j]=(ctrl_t) (h&0x7f);
+                    }
+            }catch (...){
+                if (slots!=old_slots){
+                    destroy_values();
+                    free(slots);
+                }
+                free(hashes);
+                slots=old_slots;
+                ctrl=old_ctrl;
+                capacity=old_capacity;
+                throw;
+            }
+            free(hashes);
+            for (size_t i=0;i<old_capacity;++i)
+                if (old_ctrl[i]>=0) old_slots[i].~value_type();
+            free(old_slots);
+            growth_left=max_load(capacity)-length;
+        }
+        /**
+         * copy the slots of other one by one, tombstones included, so nothing is hashed again
+         */
+        void copy(const flat_hash_map &other){
+            if (!other.length) return;
+            allocate(other.capacity);
+            try{
+                for (size_t i=0;i<capacity;++i)
+                    if (other.ctrl[i]>=0){
+                        new(slots+i) value_type(other.slots[i]);
+                        ctrl[i]=other.ctrl[i];
+                    }
+            }catch (...){
+                destroy();
+                throw;
+            }
+            memcpy(ctrl,other.ctrl,capacity);
+            length=other.length;
+            growth_left=other.growth_left;
+        }
+        void erase_index(size_t i){
+            slots[i].~value_type();
+            --length;
+            // a group with an empty slot has never been full since the last rehash, so no probe went past it
+            if (group(ctrl+i/group_width*group_width).match_empty()){
+                ctrl[i]=empty_ctrl;
+                ++growth_left;
+            }else
+                ctrl[i]=deleted_ctrl;
+        }
+        /**
+         * the first full slot from i on, capacity if there is none
+         */
+        size_t next_full(size_t i) const{
+            while (i<capacity&&ctrl[i]<0) ++i;
+            return i;
+        }
+        /**
+         * the last full slot before i, capacity if there is none
+         */
+        size_t prev_full(size_t i) const{
+            while (i--)
+                if (ctrl[i]>=0) return i;
+            return capacity;
+        }
+
+        /**
+         * insert an element with key and the mapped value constructed from args, if key does not exist.
+         * nothing is constructed or moved from when it does
+         */
+        template<class K, class... Args>
+        pair<size_t, bool> emplace_key(K &&key, Args&&... args){
+            size_t h=hash_of(key),i=find_index(key,h);
+            if (i<capacity) return pair<size_t,bool>(i,false);
+            i=free_slot(h);
+            new(slots+i) value_type(std::piecewise_construct,std::forward_as_tuple(std::forward<K>(key)),
+                                    std::forward_as_tuple(std::forward<Args>(args)...));
+            fill(i,h);
+            return pair<size_t,bool>(i,true);
+        }
+
+    public:
+        class const_iterator;
+        class iterator {
+            friend class flat_hash_map;
+        private:
+            flat_hash_map *ptr;
+            size_t pos;
+        public:
+            using difference_type = std::ptrdiff_t;
+            using value_type = typename flat_hash_map::value_type;
+            using pointer = value_type*;
+            using reference = value_type&;
+            using iterator_category = std::output_iterator_tag;
+
+            iterator(flat_hash_map *_ptr=nullptr,size_t _pos=0):ptr(_ptr),pos(_pos) {}
+            iterator(const iterator &other):ptr(other.ptr),pos(other.pos) {}
+            iterator operator++(int) {
+                iterator tmp=*this;
+                ++*this;
+                return tmp;
+            }
+            iterator & operator++() {
+                if (!ptr||pos==ptr->capacity) throw invalid_iterator();
+                pos=ptr->next_full(pos+1);
+                return *this;
+            }
+            iterator operator--(int) {
+                iterator tmp=*this;
+                --*this;
+                return tmp;
+            }
+            iterator & operator--() {
+                if (!ptr) throw invalid_iterator();
+                size_t i=ptr->prev_full(pos);
+                if (i==ptr->capacity) throw invalid_iterator();
+                pos=i;
+                return *this;
+            }
+            value_type & operator*() const {
+                if (!ptr||pos==ptr->capacity) throw invalid_iterator();
+                return ptr->slots[pos];
+            }
+            bool operator==(const iterator &rhs) const {
+                return ptr==rhs.ptr&&pos==rhs.pos;
+            }
+            bool operator==(const const_iterator &rhs) const {
+                return ptr==rhs.ptr&&pos==rhs.pos;
+            }
+            bool operator!=(const iterator &rhs) const {
+                return ptr!=rhs.ptr||pos!=rhs.pos;
+            }
+            bool operator!=(const const_iterator &rhs) const {
+                return ptr!=rhs.ptr||pos!=rhs.pos;
+            }
+            value_type* operator->() const noexcept {
+                return ptr->slots+pos;
+            }
+        };
+
+        class const_iterator {
+            friend class flat_hash_map;
+        private:
+            const flat_hash_map *ptr;
+            size_t pos;
+        public:
+            const_iterator(const flat_hash_map *_ptr=nullptr,size_t _pos=0):ptr(_ptr),pos(_pos) {}
+            const_iterator(const const_iterator &other):ptr(other.ptr),pos(other.pos) {}
+            const_iterator(const iterator &other):ptr(other.ptr),pos(other.pos) {}
+            const_iterator operator++(int) {
+                const_iterator tmp=*this;
+                ++*this;
+                return tmp;
+            }
+            const_iterator & operator++() {
+                if (!ptr||pos==ptr->capacity) throw invalid_iterator();
+                pos=ptr->next_full(pos+1);
+                return *this;
+            }
+            const_iterator operator--(int) {
+                const_iterator tmp=*this;
+                --*this;
+                return tmp;
+            }
+            const_iterator & operator--() {
+                if (!ptr) throw invalid_iterator();
+                size_t i=ptr->prev_full(pos);
+                if (i==ptr->capacity) throw invalid_iterator();
+                pos=i;
+                return *this;
+            }
+            const value_type & operator*() const {
+                if (!ptr||pos==ptr->capacity) throw invalid_iterator();
+                return ptr->slots[pos];
+            }
+            bool operator==(const iterator &rhs) const {
+                return ptr==rhs.ptr&&pos==rhs.pos;
+            }
+            bool operator==(const const_iterator &rhs) const {
+                return ptr==rhs.ptr&&pos==rhs.pos;
+            }
+            bool operator!=(const iterator &rhs) const {
+                return ptr!=rhs.ptr||pos!=rhs.pos;
+            }
+            bool operator!=(const const_iterator &rhs) const {
+                return ptr!=rhs.ptr||pos!=rhs.pos;
+            }
+            const value_type* operator->() const noexcept {
+                return ptr->slots+pos;
+            }
+        };
+
+        /**
+         * an empty map allocates nothing until the first insertion
+         */
+        flat_hash_map():flat_hash_map(Hash()) {}
+        /**
+         * an empty map that hashes with hash and compares keys with eq, both are copied into the map
+         */
+        explicit flat_hash_map(const Hash &hash, const Equal &eq = Equal())
+            :functor_holder<Hash, 0>(hash),functor_holder<Equal, 1>(eq),
+             slots(nullptr),ctrl(nullptr),capacity(0),length(0),growth_left(0) {}
+        flat_hash_map(const flat_hash_map &other)
+            :functor_holder<Hash, 0>(other),functor_holder<Equal, 1>(other),
+             slots(nullptr),ctrl(nullptr),capacity(0),length(0),growth_left(0) {
+            copy(other);
+        }
+        flat_hash_map & operator=(const flat_hash_map &other) {
+            if (this==&other) return *this;
+            destroy();
+            functor_holder<Hash, 0>::operator=(other);
+            functor_holder<Equal, 1>::operator=(other);
+            copy(other);
+            return *this;
+        }
+        ~flat_hash_map() {
+            destroy();
+        }
+
+        /**
+         * access specified element with bounds checking, throw index_out_of_bound if key is not found.
+         */
+        T & at(const Key &key) {
+            size_t i=find_index(key);
+            if (i==capacity) throw index_out_of_bound();
+            return slots[i].second;
+        }
+        const T & at(const Key &key) const {
+            size_t i=find_index(key);
+            if (i==capacity) throw index_out_of_bound();
+            return slots[i].second;
+        }
+        /**
+         * access specified element, inserting a default constructed value if key does not exist.
+         */
+        T & operator[](const Key &key) {
+            size_t i=emplace_key(key).first;
+            return slots[i].second;
+        }
+        T & operator[](Key &&key) {
+            size_t i=emplace_key(std::move(key)).first;
+            return slots[i].second;
+        }
+        /**
+         * behave like at() throw index_out_of_bound if such key does not exist.
+         */
+        const T & operator[](const Key &key) const {
+            return at(key);
+        }
+
+        /**
+         * iteration visits the slots in order, begin() skips the free ones at the front
+         */
+        iterator begin() {
+            return iterator(this,next_full(0));
+        }
+        const_iterator cbegin() const {
+            return const_iterator(this,next_full(0));
+        }
+        iterator end() {
+            return iterator(this,capacity);
+        }
+        const_iterator cend() const {
+            return const_iterator(this,capacity);
+        }
+
+        bool empty() const {
+            return length==0;
+        }
+        size_t size() const {
+            return length;
+        }
+        /**
+         * returns a copy of the hasher and of the key equality.
+         */
+        Hash hash_function() const {
+            return hasher();
+        }
+        Equal key_eq() const {
+            return equal();
+        }
+
+        /**
+         * clears the contents, the slots are kept for the next insertions
+         */
+        void clear() {
+            if (!capacity) return;
+            destroy_values();
+            memset(ctrl,empty_ctrl,capacity);
+            length=0;
+            growth_left=max_load(capacity);
+        }
+        /**
+         * make room for n elements, so that inserting up to n of them does not rehash
+         */
+        void reserve(size_t n) {
+            if (n<=length||n-length<=growth_left) return;
+            size_t cap=group_width;
+            while (max_load(cap)<n) cap*=2;
+            // tombstones may be what uses up the room, then a rehash into as many slots drops them
+            rehash(cap>capacity?cap:capacity);
+        }
+
+        /**
+         * insert an element.
+         * return a pair, the first of the pair is
+         *   the iterator to the new element (or the element that prevented the insertion),
+         *   the second one is true if insert successfully, or false.
+         */
+        pair<iterator, bool> insert(const value_type &value) {
+            pair<size_t,bool> p=emplace_key(value.first,value.second);
+            return pair<iterator,bool>(iterator(this,p.first),p.second);
+        }
+        pair<iterator, bool> insert(value_type &&value) {
+            pair<size_t,bool> p=emplace_key(value.first,std::move(value.second));
+            return pair<iterator,bool>(iterator(this,p.first),p.second);
+        }
+
+        /**
+         * construct an element from a key and a mapped value in place and insert it if its key does not exist.
+         * nothing is constructed if it does
+         */
+        template<class K, class M>
+        pair<iterator, bool> emplace(K &&key, M &&obj) {
+            pair<size_t,bool> p=emplace_key(std::forward<K>(key),std::forward<M>(obj));
+            return pair<iterator,bool>(iterator(this,p.first),p.second);
+        }
+        /**
+         * construct an element from any other args and insert it like insert.
+         * the key is only known once the element exists, so it is built aside first and moved into its slot
+         */
+        template<class... Args>
+        pair<iterator, bool> emplace(Args&&... args) {
+            return insert(value_type(std::forward<Args>(args)...));
+        }
+
+        /**
+         * insert an element with key and the value constructed in place from args if key does not exist.
+         * if it does, nothing is constructed and args are not moved from.
+         */
+        template<class... Args>
+        pair<iterator, bool> try_emplace(const Key &key, Args&&... args) {
+            pair<size_t,bool> p=emplace_key(key,std::forward<Args>(args)...);
+            return pair<iterator,bool>(iterator(this,p.first),p.second);
+        }
+        template<class... Args>
+        pair<iterator, bool> try_emplace(Key &&key, Args&&... args) {
+            pair<size_t,bool> p=emplace_key(std::move(key),std::forward<Args>(args)...);
+            return pair<iterator,bool>(iterator(this,p.first),p.second);
+        }
+
+        /**
+         * assign obj to the mapped value of key, or insert an element constructed from key and obj if key does not exist.
+         * the second one of the result is true if an element was inserted.
+         */
+        template<class M>
+        pair<iterator, bool> insert_or_assign(const Key &key, M &&obj) {
+            pair<size_t,bool> p=emplace_key(key,std::forward<M>(obj));
+            if (!p.second) slots[p.first].second=std::forward<M>(obj);
+            return pair<iterator,bool>(iterator(this,p.first),p.second);
+        }
+        template<class M>
+        pair<iterator, bool> insert_or_assign(Key &&key, M &&obj) {
+            pair<size_t,bool> p=emplace_key(std::move(key),std::forward<M>(obj));
+            if (!p.second) slots[p.first].second=std::forward<M>(obj);
+            return pair<iterator,bool>(iterator(this,p.first),p.second);
+        }
+
+        /**
+         * erase the element at pos.
+         *
+         * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
+         */
+        void erase(iterator pos) {
+            if (pos.ptr!=this||pos.pos>=capacity||ctrl[pos.pos]<0) throw invalid_iterator();
+            erase_index(pos.pos);
+        }
+
+        /**
+         * Returns the number of elements with key, which is either 1 or 0.
+         */
+        size_t count(const Key &key) const {
+            return find_index(key)<capacity?1:0;
+        }
+
+        /**
+         * Finds an element with key equivalent to key, past-the-end (see end()) if there is none.
+         */
+        iterator find(const Key &key) {
+            return iterator(this,find_index(key));
+        }
+        const_iterator find(const Key &key) const {
+            return const_iterator(this,find_index(key));
+        }
+    };
+
+}
+
+#endif
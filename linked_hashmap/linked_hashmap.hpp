@@ -7,6 +7,8 @@
 // only for std::equal_to<T> and std::hash<T>
 #include <functional>
 #include <cstddef>
+#include <cstdlib>
+#include <new>
 #include "utility.hpp"
 #include "exceptions.hpp"
 
@@ -26,7 +28,7 @@ namespace sjtu {
             class T,
             class Hash = std::hash<Key>,
             class Equal = std::equal_to<Key>
-    > class linked_hashmap {
+    > class linked_hashmap : private functor_holder<Hash, 0>, private functor_holder<Equal, 1> {
     public:
         /**
          * the internal type of data.
@@ -35,6 +37,8 @@ namespace sjtu {
          */
         typedef pair<const Key, T> value_type;
     private:
+        // selects the node constructor that builds the element in place from its arguments
+        struct emplace_tag{};
         struct node{
             value_type *data;
             node *after,*pre,*next;
@@ -43,6 +47,17 @@ namespace sjtu {
                 data=(value_type *) malloc(sizeof(value_type));
                 new(data) value_type(x.first,x.second);
             }
+            template<class... Args>
+            node(emplace_tag,Args&&... args):after(nullptr),pre(nullptr),next(nullptr){
+                data=(value_type *) malloc(sizeof(value_type));
+                if (!data) throw std::bad_alloc();
+                try{
+                    new(data) value_type(std::forward<Args>(args)...);
+                }catch (...){
+                    free(data);
+                    throw;
+                }
+            }
             ~node(){
                 if (data) {
                     data->first.~Key();
@@ -61,14 +76,14 @@ namespace sjtu {
                 x->after=_head;
                 _head=x;
             }
-            node *erase(const Key &key){
+            node *erase(const Key &key,const Equal &eq){
                 if (!_head) return nullptr;
                 node *p=_head;
-                if (Equal()(_head->data->first, key)){
+                if (eq(_head->data->first, key)){
                     _head=p->after;
                     return p;
                 }
-                while (p->after&&!Equal()(p->after->data->first,key)){
+                while (p->after&&!eq(p->after->data->first,key)){
                     p=p->after;
                 }
                 if (p->after){
@@ -78,9 +93,9 @@ namespace sjtu {
                 }
                 return nullptr;
             }
-            node *find(const Key &key) const{
+            node *find(const Key &key,const Equal &eq) const{
                 node *p=_head;
-                while (p&&!Equal()(p->data->first,key)){
+                while (p&&!eq(p->data->first,key)){
                     p=p->after;
                 }
                 return p;
@@ -95,16 +110,51 @@ namespace sjtu {
         static constexpr size_t mod[5]={1009,10007,100003,1000003,10000019};
         int crt;
 
+        /**
+         * the hasher and the key equality of this map, they take no space if they are empty
+         */
+        inline const Hash &hasher() const {return functor_holder<Hash, 0>::get();}
+        inline const Equal &equal() const {return functor_holder<Equal, 1>::get();}
+        inline bucketList &bucket(const Key &key) const {return storage[hasher()(key)%capacity];}
+        inline node *find_node(const Key &key) const {return bucket(key).find(key,equal());}
+
         void resize(){
             if (crt==4) return;
             capacity=mod[++crt];
             delete[] storage;
             storage=new bucketList[capacity];
             for (node *p=head->next;p!=tail;p=p->next){
-                storage[Hash()(p->data->first)%capacity].insert(p);
+                bucket(p->data->first).insert(p);
             }
         }
 
+        /**
+         * put the new node p, whose key is not in the map yet, into its bucket and at the end of the list
+         */
+        node *link(node *p){
+            if (length>capacity*LOAD_FACTOR) resize();
+            bucket(p->data->first).insert(p);
+            p->pre=tail->pre;
+            p->next=tail;
+            tail->pre->next=p;
+            tail->pre=p;
+            length++;
+            return p;
+        }
+
+        /**
+         * insert an element with key and the mapped value constructed from args, if key does not exist.
+         * nothing is constructed or moved from when it does
+         */
+        template<class K, class... Args>
+        pair<node*, bool> emplace_key(K &&key, Args&&... args){
+            if (node *p=find_node(key)){
+                return pair<node*,bool>(p,false);
+            }
+            return pair<node*,bool>(link(new node(emplace_tag(),std::piecewise_construct,std::forward_as_tuple(std::forward<K>(key)),
+                                                  std::forward_as_tuple(std::forward<Args>(args)...))),true);
+        }
+
     public:
         /**
          * see BidirectionalIterator at CppReference for help.
@@ -300,7 +350,12 @@ namespace sjtu {
         /**
          * TODO two constructors
          */
-        linked_hashmap() {
+        linked_hashmap():linked_hashmap(Hash()) {}
+        /**
+         * an empty map that hashes with hash and compares keys with eq, both are copied into the map
+         */
+        explicit linked_hashmap(const Hash &hash, const Equal &eq = Equal())
+            :functor_holder<Hash, 0>(hash),functor_holder<Equal, 1>(eq) {
             head=new node;
             tail=new node;
             head->next=tail;
@@ -310,7 +365,8 @@ namespace sjtu {
             capacity=mod[crt];
             storage=new bucketList[capacity];
         }
-        linked_hashmap(const linked_hashmap &other) {
+        linked_hashmap(const linked_hashmap &other)
+            :functor_holder<Hash, 0>(other),functor_holder<Equal, 1>(other) {
             crt=other.crt;
             capacity=mod[crt];
             storage=new bucketList[capacity];
@@ -318,7 +374,7 @@ namespace sjtu {
             tail=new node;
             node *p=other.head->next,*q=head;
             while (p!=other.tail){
-                size_t hash=Hash()(p->data->first)%capacity;
+                size_t hash=hasher()(p->data->first)%capacity;
                 q->next=new node(*(p->data),storage[hash]._head,q);
                 storage[hash]._head=q=q->next;
                 p=p->next;
@@ -340,12 +396,14 @@ namespace sjtu {
                 p=p->next;
                 delete q;
             }
+            functor_holder<Hash, 0>::operator=(other);
+            functor_holder<Equal, 1>::operator=(other);
             crt=other.crt;
             capacity=mod[crt];
             storage=new bucketList[capacity];
             p=other.head->next,q=head;
             while (p!=other.tail){
-                size_t hash=Hash()(p->data->first)%capacity;
+                size_t hash=hasher()(p->data->first)%capacity;
                 q->next=new node(*(p->data),storage[hash]._head,q);
                 storage[hash]._head=q=q->next;
                 p=p->next;
@@ -378,7 +436,7 @@ namespace sjtu {
          * If no such element exists, an exception of type `index_out_of_bound'
          */
         T & at(const Key &key) {
-            node *p=storage[Hash()(key)%capacity].find(key);
+            node *p=find_node(key);
             if (p){
                 return p->data->second;
             }else{
@@ -386,7 +444,7 @@ namespace sjtu {
             }
         }
         const T & at(const Key &key) const {
-            node *p=storage[Hash()(key)%capacity].find(key);
+            node *p=find_node(key);
             if (p){
                 return p->data->second;
             }else{
@@ -401,18 +459,16 @@ namespace sjtu {
          *   performing an insertion if such key does not already exist.
          */
         T & operator[](const Key &key) {
-            node *p=storage[Hash()(key)%capacity].find(key);
-            if (p){
-                return p->data->second;
-            }else{
-                return insert(value_type(key,T())).first->second;
-            }
+            return emplace_key(key).first->data->second;
+        }
+        T & operator[](Key &&key) {
+            return emplace_key(std::move(key)).first->data->second;
         }
         /**
          * behave like at() throw index_out_of_bound if such key does not exist.
          */
         const T & operator[](const Key &key) const {
-            node *p=storage[Hash()(key)%capacity].find(key);
+            node *p=find_node(key);
             if (p){
                 return p->data->second;
             }else{
@@ -456,6 +512,16 @@ namespace sjtu {
             return length;
         }
 
+        /**
+         * returns a copy of the hasher and of the key equality.
+         */
+        Hash hash_function() const {
+            return hasher();
+        }
+        Equal key_eq() const {
+            return equal();
+        }
+
         /**
          * clears the contents
          */
@@ -482,18 +548,62 @@ namespace sjtu {
          *   the second one is true if insert successfully, or false.
          */
         pair<iterator, bool> insert(const value_type &value) {
-            size_t hash=Hash()(value.first)%capacity;
-            if (node *p=storage[hash].find(value.first)){
+            if (node *p=find_node(value.first)){
                 return pair<iterator,bool>(iterator(this,p),false);
             }
-            if (length>capacity*LOAD_FACTOR) resize();
-            hash=Hash()(value.first)%capacity;
-            node *p=new node(value, storage[hash]._head, tail->pre, tail);
-            tail->pre->next=p;
-            tail->pre=p;
-            storage[hash]._head=p;
-            length++;
-            return pair<iterator,bool>(iterator(this,p),true);
+            return pair<iterator,bool>(iterator(this,link(new node(emplace_tag(),value))),true);
+        }
+        pair<iterator, bool> insert(value_type &&value) {
+            if (node *p=find_node(value.first)){
+                return pair<iterator,bool>(iterator(this,p),false);
+            }
+            return pair<iterator,bool>(iterator(this,link(new node(emplace_tag(),std::move(value)))),true);
+        }
+
+        /**
+         * construct an element in place from args and insert it if its key does not exist, like insert.
+         * the element is built once, before the search, so it is destroyed again if the key exists.
+         */
+        template<class... Args>
+        pair<iterator, bool> emplace(Args&&... args) {
+            node *p=new node(emplace_tag(),std::forward<Args>(args)...);
+            if (node *q=find_node(p->data->first)){
+                delete p;
+                return pair<iterator,bool>(iterator(this,q),false);
+            }
+            return pair<iterator,bool>(iterator(this,link(p)),true);
+        }
+
+        /**
+         * insert an element with key and the value constructed in place from args if key does not exist.
+         * if it does, nothing is constructed and args are not moved from.
+         */
+        template<class... Args>
+        pair<iterator, bool> try_emplace(const Key &key, Args&&... args) {
+            pair<node*,bool> p=emplace_key(key,std::forward<Args>(args)...);
+            return pair<iterator,bool>(iterator(this,p.first),p.second);
+        }
+        template<class... Args>
+        pair<iterator, bool> try_emplace(Key &&key, Args&&... args) {
+            pair<node*,bool> p=emplace_key(std::move(key),std::forward<Args>(args)...);
+            return pair<iterator,bool>(iterator(this,p.first),p.second);
+        }
+
+        /**
+         * assign obj to the mapped value of key, or insert an element constructed from key and obj if key does not exist.
+         * the second one of the result is true if an element was inserted.
+         */
+        template<class M>
+        pair<iterator, bool> insert_or_assign(const Key &key, M &&obj) {
+            pair<node*,bool> p=emplace_key(key,std::forward<M>(obj));
+            if (!p.second) p.first->data->second=std::forward<M>(obj);
+            return pair<iterator,bool>(iterator(this,p.first),p.second);
+        }
+        template<class M>
+        pair<iterator, bool> insert_or_assign(Key &&key, M &&obj) {
+            pair<node*,bool> p=emplace_key(std::move(key),std::forward<M>(obj));
+            if (!p.second) p.first->data->second=std::forward<M>(obj);
+            return pair<iterator,bool>(iterator(this,p.first),p.second);
         }
 
         /**
@@ -505,7 +615,7 @@ namespace sjtu {
             if (pos.ptr!=this||pos==end()) throw invalid_iterator();
             pos.pos->pre->next=pos.pos->next;
             pos.pos->next->pre=pos.pos->pre;
-            delete storage[Hash()(pos->first)%capacity].erase(pos->first);
+            delete bucket(pos->first).erase(pos->first,equal());
             length--;
         }
 
@@ -516,7 +626,7 @@ namespace sjtu {
          *     since this container does not allow duplicates.
          */
         size_t count(const Key &key) const {
-            node *p=storage[Hash()(key)%capacity].find(key);
+            node *p=find_node(key);
             if (p){
                 return 1;
             }else{
@@ -531,7 +641,7 @@ namespace sjtu {
          *   If no such element is found, past-the-end (see end()) iterator is returned.
          */
         iterator find(const Key &key) {
-            node *p=storage[Hash()(key)%capacity].find(key);
+            node *p=find_node(key);
             if (p){
                 return iterator(this,p);
             }else{
@@ -539,7 +649,7 @@ namespace sjtu {
             }
         }
         const_iterator find(const Key &key) const {
-            node *p=storage[Hash()(key)%capacity].find(key);
+            node *p=find_node(key);
             if (p){
                 return const_iterator(this,p);
             }else{
@@ -1,6 +1,9 @@
 #ifndef SJTU_UTILITY_HPP
 #define SJTU_UTILITY_HPP
 
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
 namespace sjtu {
@@ -15,11 +18,43 @@ public:
 	pair(pair &&other) = default;
 	pair(const T1 &x, const T2 &y) : first(x), second(y) {}
 	template<class U1, class U2>
-	pair(U1 &&x, U2 &&y) : first(x), second(y) {}
+	pair(U1 &&x, U2 &&y) : first(std::forward<U1>(x)), second(std::forward<U2>(y)) {}
 	template<class U1, class U2>
 	pair(const pair<U1, U2> &other) : first(other.first), second(other.second) {}
 	template<class U1, class U2>
-	pair(pair<U1, U2> &&other) : first(other.first), second(other.second) {}
+	pair(pair<U1, U2> &&other) : first(std::forward<U1>(other.first)), second(std::forward<U2>(other.second)) {}
+	/**
+	 * construct first and second in place from the arguments in the tuples
+	 */
+	template<class... Args1, class... Args2>
+	pair(std::piecewise_construct_t, std::tuple<Args1...> first_args, std::tuple<Args2...> second_args)
+		: pair(first_args, second_args, std::index_sequence_for<Args1...>(), std::index_sequence_for<Args2...>()) {}
+private:
+	template<class Tuple1, class Tuple2, std::size_t... I1, std::size_t... I2>
+	pair(Tuple1 &first_args, Tuple2 &second_args, std::index_sequence<I1...>, std::index_sequence<I2...>)
+		: first(std::forward<typename std::tuple_element<I1, Tuple1>::type>(std::get<I1>(first_args))...),
+		  second(std::forward<typename std::tuple_element<I2, Tuple2>::type>(std::get<I2>(second_args))...) {}
+};
+
+/**
+ * keeps a function object of a container, like a comparator or a hasher.
+ * an empty one is a base class, so that it takes no space, any other one a member.
+ * Tag tells several of them apart in one class.
+ */
+template<class F, int Tag = 0, bool = std::is_empty<F>::value && !std::is_final<F>::value>
+class functor_holder : private F {
+public:
+	functor_holder() : F() {}
+	explicit functor_holder(const F &f) : F(f) {}
+	const F &get() const { return *this; }
+};
+template<class F, int Tag>
+class functor_holder<F, Tag, false> {
+	F fn;
+public:
+	functor_holder() : fn() {}
+	explicit functor_holder(const F &f) : fn(f) {}
+	const F &get() const { return fn; }
 };
 
 }
@@ -1,48 +1,1484 @@
-#ifndef SJTU_ALGORITHM_HPP
-#define SJTU_ALGORITHM_HPP
-
-#include <functional>
-
-namespace sjtu{
-
-template<typename T>
-void sort(T *begin, T *end, std::function<bool(const T&, const T&)> cmp){
-    int len = end - begin;
-    if (len <= 1) return ;
-    T *i = begin, *j = end - 1;
-    T pivot = *(begin + (len + 1) / 2 - 1);
-    while (j - i >= 0){
-        while (cmp(*i, pivot)) i++;
-        while (cmp(pivot, *j)) j--;
-        if (j - i >= 0){
-            std::swap(*i, *j);
-            i++, j--;
-        }
-    }
-    if (j - begin > 0) sort(begin, i, cmp);
-    if (end - i > 1) sort(i, end, cmp);
-}
-
-template<class T>
-T *upper_bound(const T *begin, const T *end, const T &num){
-    int l = -1, r = end - begin;
-    while (l + 1 < r){
-        int mid = (l + r) >> 1;
-        if (num < *(begin + mid)) r = mid; else l = mid;
-    }
-    return const_cast<T *>(begin + r);
-}
-
-template<class T>
-T *lower_bound(const T *begin, const T *end, const T &num){
-    int l = -1, r = end - begin;
-    while (l + 1 < r){
-        int mid = (l + r) >> 1;
-        if (num <= *(begin + mid)) r = mid; else l = mid;
-    }
-    return const_cast<T *>(begin + r);
-}
-
-};
-
-#endif //SJTU_ALGORITHM_HPP
+#ifndef SJTU_ALGORITHM_HPP
+#define SJTU_ALGORITHM_HPP
+
+#include "exceptions.hpp"
+#include "utility.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace sjtu{
+
+namespace detail{
+
+/**
+ * tuning constants of the pattern-defeating introsort below
+ * ranges shorter than insertion_sort_threshold are finished by insertion sort,
+ * ranges longer than ninther_threshold pick the pivot with Tukey's ninther.
+ */
+const std::ptrdiff_t insertion_sort_threshold = 24;
+const std::ptrdiff_t ninther_threshold = 128;
+const std::size_t partial_insertion_sort_limit = 8;
+const std::size_t block_size = 64;
+const std::size_t cacheline_size = 64;
+const std::ptrdiff_t partial_sort_heap_limit = 1024;
+
+/**
+ * the iterators of sjtu containers only offer +, -, ++, -- and ==,
+ * so ordering of two positions is derived from their distance.
+ */
+template<class RandomIt>
+inline bool iter_before(const RandomIt &a, const RandomIt &b){
+    return b - a > 0;
+}
+
+template<class RandomIt>
+inline void iter_swap(RandomIt a, RandomIt b){
+    using std::swap;
+    swap(*a, *b);
+}
+
+template<class RandomIt>
+struct iter_value{
+    typedef typename std::decay<decltype(*std::declval<RandomIt>())>::type type;
+};
+
+inline int log2(std::size_t n){
+    int log = 0;
+    while (n >>= 1) ++log;
+    return log;
+}
+
+template<class RandomIt, class Compare>
+inline void insertion_sort(RandomIt begin, RandomIt end, Compare &cmp){
+    typedef typename iter_value<RandomIt>::type T;
+    if (begin == end) return ;
+    for (RandomIt cur = begin + 1; cur != end; ++cur){
+        RandomIt sift = cur, sift_1 = cur - 1;
+        if (cmp(*sift, *sift_1)){
+            T tmp(std::move(*sift));
+            do { *sift = std::move(*sift_1); --sift; } while (sift != begin && cmp(tmp, *--sift_1));
+            *sift = std::move(tmp);
+        }
+    }
+}
+
+/**
+ * insertion sort which assumes *(begin - 1) is not greater than any element in [begin, end),
+ * so the inner loop needs no bound check.
+ */
+template<class RandomIt, class Compare>
+inline void unguarded_insertion_sort(RandomIt begin, RandomIt end, Compare &cmp){
+    typedef typename iter_value<RandomIt>::type T;
+    if (begin == end) return ;
+    for (RandomIt cur = begin + 1; cur != end; ++cur){
+        RandomIt sift = cur, sift_1 = cur - 1;
+        if (cmp(*sift, *sift_1)){
+            T tmp(std::move(*sift));
+            do { *sift = std::move(*sift_1); --sift; } while (cmp(tmp, *--sift_1));
+            *sift = std::move(tmp);
+        }
+    }
+}
+
+/**
+ * insertion sort that gives up (returning false) once more than
+ * partial_insertion_sort_limit elements have been moved.
+ */
+template<class RandomIt, class Compare>
+inline bool partial_insertion_sort(RandomIt begin, RandomIt end, Compare &cmp){
+    typedef typename iter_value<RandomIt>::type T;
+    if (begin == end) return true;
+    std::size_t limit = 0;
+    for (RandomIt cur = begin + 1; cur != end; ++cur){
+        RandomIt sift = cur, sift_1 = cur - 1;
+        if (cmp(*sift, *sift_1)){
+            T tmp(std::move(*sift));
+            do { *sift = std::move(*sift_1); --sift; } while (sift != begin && cmp(tmp, *--sift_1));
+            *sift = std::move(tmp);
+            limit += cur - sift;
+        }
+        if (limit > partial_insertion_sort_limit) return false;
+    }
+    return true;
+}
+
+template<class RandomIt, class Compare>
+inline void sift_down(RandomIt begin, std::ptrdiff_t pos, std::ptrdiff_t len, Compare &cmp){
+    typedef typename iter_value<RandomIt>::type T;
+    T tmp(std::move(*(begin + pos)));
+    std::ptrdiff_t child;
+    while ((child = 2 * pos + 1) < len){
+        if (child + 1 < len && cmp(*(begin + child), *(begin + (child + 1)))) ++child;
+        if (!cmp(tmp, *(begin + child))) break;
+        *(begin + pos) = std::move(*(begin + child));
+        pos = child;
+    }
+    *(begin + pos) = std::move(tmp);
+}
+
+template<class RandomIt, class Compare>
+inline void heap_sort(RandomIt begin, RandomIt end, Compare &cmp){
+    std::ptrdiff_t len = end - begin;
+    for (std::ptrdiff_t i = len / 2 - 1; i >= 0; --i) sift_down(begin, i, len, cmp);
+    for (std::ptrdiff_t i = len - 1; i > 0; --i){
+        iter_swap(begin, begin + i);
+        sift_down(begin, 0, i, cmp);
+    }
+}
+
+template<class RandomIt, class Compare>
+inline void sort2(RandomIt a, RandomIt b, Compare &cmp){
+    if (cmp(*b, *a)) iter_swap(a, b);
+}
+
+template<class RandomIt, class Compare>
+inline void sort3(RandomIt a, RandomIt b, RandomIt c, Compare &cmp){
+    sort2(a, b, cmp);
+    sort2(b, c, cmp);
+    sort2(a, b, cmp);
+}
+
+/**
+ * partition [begin, end) around the pivot *begin,
+ * elements equal to the pivot go to the right part.
+ * return the final position of the pivot and whether no swap was needed.
+ */
+template<class RandomIt, class Compare>
+inline std::pair<RandomIt, bool> partition_right(RandomIt begin, RandomIt end, Compare &cmp, std::false_type){
+    typedef typename iter_value<RandomIt>::type T;
+    T pivot(std::move(*begin));
+    RandomIt first = begin, last = end;
+    while (cmp(*++first, pivot));
+    if (first - 1 == begin) while (iter_before(first, last) && !cmp(*--last, pivot));
+    else while (!cmp(*--last, pivot));
+    bool already_partitioned = !iter_before(first, last);
+    while (iter_before(first, last)){
+        iter_swap(first, last);
+        while (cmp(*++first, pivot));
+        while (!cmp(*--last, pivot));
+    }
+    RandomIt pivot_pos = first - 1;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+    return std::pair<RandomIt, bool>(pivot_pos, already_partitioned);
+}
+
+template<class RandomIt>
+inline void swap_offsets(RandomIt first, RandomIt last, unsigned char *offsets_l, unsigned char *offsets_r,
+                         std::size_t num, bool use_swaps){
+    typedef typename iter_value<RandomIt>::type T;
+    if (use_swaps){
+        // the two blocks have equally many misplaced elements, plain swaps keep them all in place
+        for (std::size_t i = 0; i < num; ++i)
+            iter_swap(first + offsets_l[i], last - offsets_r[i]);
+    } else if (num > 0){
+        // otherwise a cyclic permutation needs one move per element instead of three
+        RandomIt l = first + offsets_l[0], r = last - offsets_r[0];
+        T tmp(std::move(*l));
+        *l = std::move(*r);
+        for (std::size_t i = 1; i < num; ++i){
+            l = first + offsets_l[i];
+            *r = std::move(*l);
+            r = last - offsets_r[i];
+            *l = std::move(*r);
+        }
+        *r = std::move(tmp);
+    }
+}
+
+/**
+ * same contract as partition_right, but comparisons are recorded as offsets
+ * in small blocks first and the elements are swapped afterwards,
+ * so the comparison results never feed a branch (BlockQuicksort).
+ * used for arithmetic types stored in raw arrays.
+ */
+template<class RandomIt, class Compare>
+inline std::pair<RandomIt, bool> partition_right(RandomIt begin, RandomIt end, Compare &cmp, std::true_type){
+    typedef typename iter_value<RandomIt>::type T;
+    T pivot(std::move(*begin));
+    RandomIt first = begin, last = end;
+    while (cmp(*++first, pivot));
+    if (first - 1 == begin) while (first < last && !cmp(*--last, pivot));
+    else while (!cmp(*--last, pivot));
+    bool already_partitioned = first >= last;
+    if (!already_partitioned){
+        iter_swap(first, last);
+        ++first;
+
+        alignas(cacheline_size) unsigned char offsets_l[block_size];
+        alignas(cacheline_size) unsigned char offsets_r[block_size];
+        RandomIt offsets_l_base = first, offsets_r_base = last;
+        std::size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+        while (first < last){
+            // fill whichever block is empty, splitting the unknown region if both are
+            std::size_t num_unknown = last - first;
+            std::size_t left_split = num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+            std::size_t right_split = num_r == 0 ? (num_unknown - left_split) : 0;
+            if (left_split > block_size) left_split = block_size;
+            if (right_split > block_size) right_split = block_size;
+
+            for (std::size_t i = 0; i < left_split; ++i){
+                offsets_l[num_l] = (unsigned char) i;
+                num_l += !cmp(*first, pivot);
+                ++first;
+            }
+            for (std::size_t i = 0; i < right_split;){
+                offsets_r[num_r] = (unsigned char) ++i;
+                num_r += cmp(*--last, pivot);
+            }
+
+            std::size_t num = num_l < num_r ? num_l : num_r;
+            swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r,
+                         num, num_l == num_r);
+            num_l -= num; num_r -= num;
+            start_l += num; start_r += num;
+            if (num_l == 0){
+                start_l = 0;
+                offsets_l_base = first;
+            }
+            if (num_r == 0){
+                start_r = 0;
+                offsets_r_base = last;
+            }
+        }
+
+        // at most one block still holds misplaced elements, move them next to the boundary
+        if (num_l){
+            while (num_l--) iter_swap(offsets_l_base + offsets_l[start_l + num_l], --last);
+            first = last;
+        }
+        if (num_r){
+            while (num_r--) iter_swap(offsets_r_base - offsets_r[start_r + num_r], first), ++first;
+            last = first;
+        }
+    }
+    RandomIt pivot_pos = first - 1;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+    return std::pair<RandomIt, bool>(pivot_pos, already_partitioned);
+}
+
+/**
+ * partition [begin, end) around the pivot *begin,
+ * elements equal to the pivot go to the left part.
+ * used when the pivot equals the element before the range,
+ * so the whole run of equal elements is finished at once.
+ */
+template<class RandomIt, class Compare>
+inline RandomIt partition_left(RandomIt begin, RandomIt end, Compare &cmp){
+    typedef typename iter_value<RandomIt>::type T;
+    T pivot(std::move(*begin));
+    RandomIt first = begin, last = end;
+    while (cmp(pivot, *--last));
+    if (last + 1 == end) while (iter_before(first, last) && !cmp(pivot, *++first));
+    else while (!cmp(pivot, *++first));
+    while (iter_before(first, last)){
+        iter_swap(first, last);
+        while (cmp(pivot, *--last));
+        while (!cmp(pivot, *++first));
+    }
+    RandomIt pivot_pos = last;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+    return pivot_pos;
+}
+
+/**
+ * move the pivot of [begin, end) to *begin: median of three, or Tukey's ninther for long ranges.
+ * afterwards *begin is not greater than *(end - 1),
+ * which bounds the unguarded scans of partition_right.
+ */
+template<class RandomIt, class Compare>
+inline void choose_pivot(RandomIt begin, RandomIt end, Compare &cmp){
+    std::ptrdiff_t size = end - begin, s2 = size / 2;
+    if (size > ninther_threshold){
+        sort3(begin, begin + s2, end - 1, cmp);
+        sort3(begin + 1, begin + (s2 - 1), end - 2, cmp);
+        sort3(begin + 2, begin + (s2 + 1), end - 3, cmp);
+        sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), cmp);
+        iter_swap(begin, begin + s2);
+    } else sort3(begin + s2, begin, end - 1, cmp);
+}
+
+/**
+ * swap a few elements of both sides of an unbalanced partition,
+ * so that the pattern which produced it does not produce it again.
+ */
+template<class RandomIt>
+inline void break_patterns(RandomIt begin, RandomIt pivot_pos, RandomIt end){
+    std::ptrdiff_t l_size = pivot_pos - begin;
+    std::ptrdiff_t r_size = end - (pivot_pos + 1);
+    if (l_size >= insertion_sort_threshold){
+        iter_swap(begin, begin + l_size / 4);
+        iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+        if (l_size > ninther_threshold){
+            iter_swap(begin + 1, begin + (l_size / 4 + 1));
+            iter_swap(begin + 2, begin + (l_size / 4 + 2));
+            iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+            iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+        }
+    }
+    if (r_size >= insertion_sort_threshold){
+        iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        iter_swap(end - 1, end - r_size / 4);
+        if (r_size > ninther_threshold){
+            iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+            iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+            iter_swap(end - 2, end - (1 + r_size / 4));
+            iter_swap(end - 3, end - (2 + r_size / 4));
+        }
+    }
+}
+
+template<class RandomIt, class Compare, class Branchless>
+void introsort_loop(RandomIt begin, RandomIt end, Compare &cmp, int bad_allowed, bool leftmost){
+    while (true){
+        std::ptrdiff_t size = end - begin;
+        if (size < insertion_sort_threshold){
+            if (leftmost) insertion_sort(begin, end, cmp);
+            else unguarded_insertion_sort(begin, end, cmp);
+            return ;
+        }
+        choose_pivot(begin, end, cmp);
+
+        // the pivot equals the element before the range, which is a lower bound of it,
+        // so every element equal to the pivot is already in its final place after partition_left
+        if (!leftmost && !cmp(*(begin - 1), *begin)){
+            begin = partition_left(begin, end, cmp) + 1;
+            continue;
+        }
+
+        std::pair<RandomIt, bool> part = partition_right(begin, end, cmp, Branchless());
+        RandomIt pivot_pos = part.first;
+        std::ptrdiff_t l_size = pivot_pos - begin;
+        std::ptrdiff_t r_size = end - (pivot_pos + 1);
+
+        if (l_size < size / 8 || r_size < size / 8){
+            // too many bad partitions, fall back to heap sort to keep O(nlogn)
+            if (--bad_allowed == 0){
+                heap_sort(begin, end, cmp);
+                return ;
+            }
+            break_patterns(begin, pivot_pos, end);
+        } else if (part.second && partial_insertion_sort(begin, pivot_pos, cmp)
+                               && partial_insertion_sort(pivot_pos + 1, end, cmp)){
+            // the range looked sorted already and insertion sort finished it cheaply
+            return ;
+        }
+
+        introsort_loop<RandomIt, Compare, Branchless>(begin, pivot_pos, cmp, bad_allowed, leftmost);
+        begin = pivot_pos + 1;
+        leftmost = false;
+    }
+}
+
+/**
+ * restore the max-heap [begin, begin + len) after its root was replaced by value.
+ */
+template<class RandomIt, class T, class Compare>
+inline void replace_heap_top(RandomIt begin, std::ptrdiff_t len, T &&value, Compare &cmp){
+    std::ptrdiff_t pos = 0, child;
+    while ((child = 2 * pos + 1) < len){
+        if (child + 1 < len && cmp(*(begin + child), *(begin + (child + 1)))) ++child;
+        if (!cmp(value, *(begin + child))) break;
+        *(begin + pos) = std::move(*(begin + child));
+        pos = child;
+    }
+    *(begin + pos) = std::forward<T>(value);
+}
+
+/**
+ * move the len smallest elements of [begin, end) into [begin, begin + len) as a max-heap, in O(nlog(len)).
+ */
+template<class RandomIt, class Compare>
+inline void heap_select(RandomIt begin, std::ptrdiff_t len, RandomIt end, Compare &cmp){
+    typedef typename iter_value<RandomIt>::type T;
+    for (std::ptrdiff_t i = len / 2 - 1; i >= 0; --i) sift_down(begin, i, len, cmp);
+    for (RandomIt it = begin + len; it != end; ++it)
+        if (cmp(*it, *begin)){
+            T tmp(std::move(*it));
+            *it = std::move(*begin);
+            replace_heap_top(begin, len, std::move(tmp), cmp);
+        }
+}
+
+template<class RandomIt, class Compare>
+inline void sort_heap(RandomIt begin, std::ptrdiff_t len, Compare &cmp){
+    for (std::ptrdiff_t i = len - 1; i > 0; --i){
+        iter_swap(begin, begin + i);
+        sift_down(begin, 0, i, cmp);
+    }
+}
+
+/**
+ * quickselect with the pivot selection and partitioning of introsort_loop.
+ * only the side that contains nth is followed, after too many bad partitions
+ * the rest is finished by heap selection, so the worst case is O(nlogn).
+ */
+template<class RandomIt, class Compare, class Branchless>
+void introselect(RandomIt begin, RandomIt nth, RandomIt end, Compare &cmp, int bad_allowed){
+    bool leftmost = true;
+    while (true){
+        std::ptrdiff_t size = end - begin;
+        if (size < insertion_sort_threshold){
+            if (leftmost) insertion_sort(begin, end, cmp);
+            else unguarded_insertion_sort(begin, end, cmp);
+            return ;
+        }
+        choose_pivot(begin, end, cmp);
+
+        // [begin, pivot_pos] are all equal to the pivot afterwards, see introsort_loop
+        if (!leftmost && !cmp(*(begin - 1), *begin)){
+            RandomIt pivot_pos = partition_left(begin, end, cmp);
+            if (!iter_before(pivot_pos, nth)) return ;
+            begin = pivot_pos + 1;
+            continue;
+        }
+
+        RandomIt pivot_pos = partition_right(begin, end, cmp, Branchless()).first;
+        if (pivot_pos == nth) return ;
+        std::ptrdiff_t l_size = pivot_pos - begin;
+        std::ptrdiff_t r_size = end - (pivot_pos + 1);
+        if (l_size < size / 8 || r_size < size / 8){
+            if (--bad_allowed == 0){
+                if (iter_before(nth, pivot_pos)) end = pivot_pos;
+                else begin = pivot_pos + 1;
+                std::ptrdiff_t k = nth - begin;
+                // the k + 1 smallest elements form a max-heap whose root is the answer
+                heap_select(begin, k + 1, end, cmp);
+                iter_swap(begin, nth);
+                return ;
+            }
+            break_patterns(begin, pivot_pos, end);
+        }
+        if (iter_before(nth, pivot_pos)) end = pivot_pos;
+        else {
+            begin = pivot_pos + 1;
+            leftmost = false;
+        }
+    }
+}
+
+}
+
+/**
+ * sort [begin, end) in ascending order of cmp (not stable).
+ * pattern-defeating introsort: median-of-3 / ninther pivots, insertion sort for short ranges,
+ * heap sort fallback after too many unbalanced partitions, so the worst case is O(nlogn).
+ * RandomIt may be a raw pointer or an iterator of sjtu::vector.
+ */
+template<class RandomIt, class Compare>
+void sort(RandomIt begin, RandomIt end, Compare cmp){
+    typedef typename detail::iter_value<RandomIt>::type T;
+    typedef std::integral_constant<bool, std::is_pointer<RandomIt>::value && std::is_arithmetic<T>::value> Branchless;
+    std::ptrdiff_t len = end - begin;
+    if (len <= 1) return ;
+    detail::introsort_loop<RandomIt, Compare, Branchless>(begin, end, cmp, detail::log2(len), true);
+}
+
+template<class RandomIt>
+void sort(RandomIt begin, RandomIt end){
+    sjtu::sort(begin, end, std::less<typename detail::iter_value<RandomIt>::type>());
+}
+
+/**
+ * rearrange [begin, end) so that *nth is the element that would be there if the range were sorted,
+ * no element before nth is greater than it and no element after nth is less than it.
+ * introselect: O(n) on average, O(nlogn) in the worst case.
+ */
+template<class RandomIt, class Compare>
+void nth_element(RandomIt begin, RandomIt nth, RandomIt end, Compare cmp){
+    typedef typename detail::iter_value<RandomIt>::type T;
+    typedef std::integral_constant<bool, std::is_pointer<RandomIt>::value && std::is_arithmetic<T>::value> Branchless;
+    std::ptrdiff_t len = end - begin;
+    if (len <= 1 || nth == end) return ;
+    detail::introselect<RandomIt, Compare, Branchless>(begin, nth, end, cmp, detail::log2(len));
+}
+
+template<class RandomIt>
+void nth_element(RandomIt begin, RandomIt nth, RandomIt end){
+    sjtu::nth_element(begin, nth, end, std::less<typename detail::iter_value<RandomIt>::type>());
+}
+
+/**
+ * put the middle - begin smallest elements of [begin, end) in ascending order into [begin, middle),
+ * the order of the remaining elements is unspecified.
+ * small prefixes use a bounded heap (O(nlog(k))), large ones introselect followed by sjtu::sort.
+ */
+template<class RandomIt, class Compare>
+void partial_sort(RandomIt begin, RandomIt middle, RandomIt end, Compare cmp){
+    std::ptrdiff_t len = end - begin, k = middle - begin;
+    if (k <= 0) return ;
+    if (k >= len){
+        sjtu::sort(begin, end, cmp);
+        return ;
+    }
+    if (k <= detail::partial_sort_heap_limit){
+        detail::heap_select(begin, k, end, cmp);
+        detail::sort_heap(begin, k, cmp);
+    } else {
+        sjtu::nth_element(begin, middle - 1, end, cmp);
+        sjtu::sort(begin, middle - 1, cmp);
+    }
+}
+
+template<class RandomIt>
+void partial_sort(RandomIt begin, RandomIt middle, RandomIt end){
+    sjtu::partial_sort(begin, middle, end, std::less<typename detail::iter_value<RandomIt>::type>());
+}
+
+/**
+ * a streaming accumulator of the k smallest elements (in the order of Compare) seen so far.
+ * elements are appended to a buffer of 2k slots, a full buffer is cut back to its k smallest
+ * by introselect, and afterwards anything not less than the k-th smallest is rejected with one comparison.
+ * so every pushed element costs amortized O(1).
+ */
+template<class T, class Compare = std::less<T>>
+class top_k : private functor_holder<Compare, 0>{
+private:
+    T *buf;
+    size_t k;
+    size_t length;
+    bool bounded;   // whether buf[k - 1] is the k-th smallest element seen so far
+
+    const Compare &compare() const {
+        return functor_holder<Compare, 0>::get();
+    }
+    void reduce(){
+        if (length <= k) return ;
+        sjtu::nth_element(buf, buf + (k - 1), buf + length, compare());
+        for (size_t i = k; i < length; ++i) buf[i].~T();
+        length = k;
+        bounded = true;
+    }
+
+public:
+    /**
+     * keep the k smallest elements in the order of comp, which is copied and used for every comparison
+     */
+    explicit top_k(size_t _k, const Compare &comp = Compare()) : functor_holder<Compare, 0>(comp), k(_k), length(0), bounded(false){
+        buf = (T *) malloc(sizeof(T) * (2 * k + 1));
+        if (!buf) throw std::bad_alloc();
+    }
+    top_k(const top_k &other) : functor_holder<Compare, 0>(other), k(other.k), length(other.length), bounded(other.bounded){
+        buf = (T *) malloc(sizeof(T) * (2 * k + 1));
+        if (!buf) throw std::bad_alloc();
+        for (size_t i = 0; i < length; ++i) new(buf + i) T(other.buf[i]);
+    }
+    top_k &operator=(const top_k &other){
+        if (this == &other) return *this;
+        clear();
+        free(buf);
+        functor_holder<Compare, 0>::operator=(other);
+        k = other.k;
+        length = other.length;
+        bounded = other.bounded;
+        buf = (T *) malloc(sizeof(T) * (2 * k + 1));
+        if (!buf) throw std::bad_alloc();
+        for (size_t i = 0; i < length; ++i) new(buf + i) T(other.buf[i]);
+        return *this;
+    }
+    ~top_k(){
+        clear();
+        free(buf);
+    }
+    /**
+     * offer one element
+     */
+    void push(const T &x){
+        if (k == 0 || (bounded && !compare()(x, buf[k - 1]))) return ;
+        new(buf + length) T(x);
+        if (++length == 2 * k) reduce();
+    }
+    /**
+     * offer a chunk of elements
+     */
+    template<class InputIt>
+    void push(InputIt first, InputIt last){
+        for (; first != last; ++first) push(*first);
+    }
+    /**
+     * the number of kept elements, min(k, number of pushed elements)
+     */
+    size_t size() const {
+        return length < k ? length : k;
+    }
+    bool empty() const {
+        return length == 0;
+    }
+    void clear(){
+        for (size_t i = 0; i < length; ++i) buf[i].~T();
+        length = 0;
+        bounded = false;
+    }
+    /**
+     * write the kept elements in ascending order to out, return the end of the written range
+     */
+    template<class OutputIt>
+    OutputIt copy(OutputIt out){
+        reduce();
+        sjtu::sort(buf, buf + length, compare());
+        for (size_t i = 0; i < length; ++i, ++out) *out = buf[i];
+        return out;
+    }
+};
+
+/**
+ * copy the min(last - first, d_last - d_first) smallest elements of [first, last) in ascending order
+ * to [d_first, ...) and return the end of the copied range.
+ * [first, last) is read once and may come from any container (e.g. sjtu::list).
+ * short outputs keep a bounded heap (O(nlog(k))), longer ones collect the elements in a top_k,
+ * which selects with introselect in O(n) and needs a buffer of 2(d_last - d_first) elements.
+ */
+template<class InputIt, class RandomIt, class Compare>
+RandomIt partial_sort_copy(InputIt first, InputIt last, RandomIt d_first, RandomIt d_last, Compare cmp){
+    std::ptrdiff_t k = 0, cap = d_last - d_first;
+    if (cap <= 0) return d_first;
+    if (cap > detail::partial_sort_heap_limit){
+        top_k<typename detail::iter_value<RandomIt>::type, Compare> acc(cap, cmp);
+        acc.push(first, last);
+        return acc.copy(d_first);
+    }
+    for (; first != last && k < cap; ++first, ++k) *(d_first + k) = *first;
+    for (std::ptrdiff_t i = k / 2 - 1; i >= 0; --i) detail::sift_down(d_first, i, k, cmp);
+    for (; first != last; ++first)
+        if (cmp(*first, *d_first))
+            detail::replace_heap_top(d_first, k, *first, cmp);
+    detail::sort_heap(d_first, k, cmp);
+    return d_first + k;
+}
+
+template<class InputIt, class RandomIt>
+RandomIt partial_sort_copy(InputIt first, InputIt last, RandomIt d_first, RandomIt d_last){
+    return sjtu::partial_sort_copy(first, last, d_first, d_last, std::less<typename detail::iter_value<RandomIt>::type>());
+}
+
+namespace detail{
+
+/**
+ * map an arithmetic key to an unsigned integer with the same order,
+ * signed integers get their sign bit flipped, floating point numbers
+ * get the sign bit flipped if positive and all bits flipped if negative.
+ */
+template<class K, bool Integral = std::is_integral<K>::value>
+struct radix_key{
+    typedef typename std::make_unsigned<K>::type type;
+    static type encode(K x){
+        return std::is_signed<K>::value ? (type) x ^ ((type) 1 << (sizeof(K) * 8 - 1)) : (type) x;
+    }
+};
+
+template<class K>
+struct radix_key<K, false>{
+    typedef typename std::conditional<sizeof(K) == 4, std::uint32_t, std::uint64_t>::type type;
+    static_assert(sizeof(K) == sizeof(type), "radix_sort supports float and double keys only");
+    static type encode(K x){
+        type bits;
+        std::memcpy(&bits, &x, sizeof(K));
+        type sign = (type) 1 << (sizeof(K) * 8 - 1);
+        return (bits & sign) ? ~bits : bits | sign;
+    }
+};
+
+/**
+ * an encoded key together with the position of its element, used when
+ * the elements themselves are too large or not trivially copyable to be moved on every pass.
+ */
+template<class U>
+struct radix_item{
+    U key;
+    std::size_t index;
+};
+
+/**
+ * least-significant-digit radix sort of n trivially copyable items by get(item).
+ * 11-bit digits for 32- and 64-bit keys (three and six passes), 8-bit digits for narrower ones.
+ * the histograms of all digits are built in a single read pass,
+ * and a pass is skipped when every item falls into the same bucket.
+ * return the array (a or buf) that holds the sorted items.
+ */
+template<class U, class Item, class GetKey>
+Item *lsd_radix_sort(Item *a, Item *buf, std::size_t n, GetKey get){
+    const int key_bits = sizeof(U) * 8;
+    const int digit_bits = key_bits >= 32 ? 11 : 8;
+    const int passes = (key_bits + digit_bits - 1) / digit_bits;
+    const std::size_t radix = (std::size_t) 1 << digit_bits;
+    const U mask = (U) (radix - 1);
+
+    std::size_t *count = (std::size_t *) calloc(passes * radix, sizeof(std::size_t));
+    if (!count) throw std::bad_alloc();
+    for (std::size_t i = 0; i < n; ++i){
+        U key = get(a[i]);
+        for (int p = 0; p < passes; ++p) ++count[p * radix + ((key >> (p * digit_bits)) & mask)];
+    }
+    for (int p = 0; p < passes; ++p){
+        std::size_t *cnt = count + p * radix;
+        int shift = p * digit_bits;
+        if (cnt[(get(a[0]) >> shift) & mask] == n) continue;
+        std::size_t sum = 0;
+        for (std::size_t d = 0; d < radix; ++d){
+            std::size_t c = cnt[d];
+            cnt[d] = sum;
+            sum += c;
+        }
+        for (std::size_t i = 0; i < n; ++i) buf[cnt[(get(a[i]) >> shift) & mask]++] = a[i];
+        Item *tmp = a;
+        a = buf;
+        buf = tmp;
+    }
+    free(count);
+    return a;
+}
+
+const std::size_t radix_direct_size = 16;
+// the largest elements apply_order gathers, the buffer stays within the size of the (key, index) items
+const std::size_t radix_gather_size = 32;
+const std::ptrdiff_t msd_radix_cutoff = 32;
+
+/**
+ * rearrange [begin, begin + n) so that the element at position i is the one
+ * originally at order[i], following permutation cycles so that every element is moved once.
+ * order is destroyed.
+ * small trivially copyable elements are gathered into a buffer and copied back instead,
+ *   one random read per element where a cycle step misses on the order, the source and the target.
+ */
+template<class RandomIt>
+void apply_order(RandomIt begin, std::size_t *order, std::size_t n){
+    typedef typename iter_value<RandomIt>::type T;
+    if (std::is_trivially_copyable<T>::value && sizeof(T) <= radix_gather_size){
+        T *buf = (T *) malloc(sizeof(T) * n);
+        if (buf){
+            for (std::size_t i = 0; i < n; ++i) std::memcpy((void *) (buf + i), (const void *) &*(begin + order[i]), sizeof(T));
+            for (std::size_t i = 0; i < n; ++i) std::memcpy((void *) &*(begin + i), (const void *) (buf + i), sizeof(T));
+            free(buf);
+            return ;
+        }
+    }
+    for (std::size_t i = 0; i < n; ++i){
+        if (order[i] == i) continue;
+        T tmp(std::move(*(begin + i)));
+        std::size_t j = i;
+        while (order[j] != i){
+            std::size_t k = order[j];
+            *(begin + j) = std::move(*(begin + k));
+            order[j] = j;
+            j = k;
+        }
+        *(begin + j) = std::move(tmp);
+        order[j] = j;
+    }
+}
+
+template<class T>
+struct radix_identity{
+    const T &operator()(const T &x) const {
+        return x;
+    }
+};
+
+
+/**
+ * arithmetic keys: sort the elements in place when they are small trivially copyable values
+ * in a raw array, otherwise sort (key, index) items and permute the elements afterwards.
+ */
+template<class RandomIt, class KeyOf>
+void radix_sort(RandomIt begin, std::size_t n, KeyOf &key_of, std::true_type){
+    typedef typename iter_value<RandomIt>::type T;
+    typedef typename std::decay<decltype(key_of(*begin))>::type K;
+    typedef typename radix_key<K>::type U;
+    if (std::is_pointer<RandomIt>::value && std::is_trivially_copyable<T>::value && sizeof(T) <= radix_direct_size){
+        T *a = &*begin;
+        T *buf = (T *) malloc(sizeof(T) * n);
+        if (!buf) throw std::bad_alloc();
+        T *res = lsd_radix_sort<U>(a, buf, n, [&key_of](const T &x){ return radix_key<K>::encode(key_of(x)); });
+        if (res != a) std::memcpy((void *) a, (const void *) res, sizeof(T) * n);
+        free(buf);
+        return ;
+    }
+    radix_item<U> *items = (radix_item<U> *) malloc(sizeof(radix_item<U>) * n * 2);
+    if (!items) throw std::bad_alloc();
+    for (std::size_t i = 0; i < n; ++i){
+        items[i].key = radix_key<K>::encode(key_of(*(begin + i)));
+        items[i].index = i;
+    }
+    radix_item<U> *res = lsd_radix_sort<U>(items, items + n, n, [](const radix_item<U> &x){ return x.key; });
+    // the order goes into the half of the items the sorted ones are not in
+    std::size_t *order = (std::size_t *) (res == items ? items + n : items);
+    for (std::size_t i = 0; i < n; ++i) order[i] = res[i].index;
+    apply_order(begin, order, n);
+    free(items);
+}
+
+/**
+ * the byte of a string key at depth, shifted by one so that 0 means the key has ended.
+ */
+template<class S>
+inline unsigned msd_byte(const S &s, std::size_t depth){
+    return depth < (std::size_t) s.size() ? (unsigned) (unsigned char) s[depth] + 1 : 0;
+}
+
+template<class S>
+inline bool msd_less(const S &x, const S &y, std::size_t depth){
+    std::size_t nx = x.size(), ny = y.size();
+    for (; depth < nx && depth < ny; ++depth)
+        if (x[depth] != y[depth]) return (unsigned char) x[depth] < (unsigned char) y[depth];
+    return nx < ny;
+}
+
+template<class S>
+struct msd_item{
+    const S *key;
+    std::size_t index;
+};
+
+/**
+ * most-significant-digit radix sort of the n items whose keys share their first depth bytes,
+ * buckets smaller than msd_radix_cutoff are finished by a comparison sort from depth on.
+ */
+template<class S>
+void msd_radix_sort(msd_item<S> *a, msd_item<S> *buf, std::size_t n, std::size_t depth){
+    while (true){
+        if ((std::ptrdiff_t) n < msd_radix_cutoff){
+            auto cmp = [depth](const msd_item<S> &x, const msd_item<S> &y){ return msd_less(*x.key, *y.key, depth); };
+            insertion_sort(a, a + n, cmp);
+            return ;
+        }
+        std::size_t count[258] = {0};
+        for (std::size_t i = 0; i < n; ++i) ++count[msd_byte(*a[i].key, depth) + 1];
+        // skip a depth shared by all keys instead of scattering them
+        unsigned same = msd_byte(*a[0].key, depth);
+        if (count[same + 1] == n){
+            if (same == 0) return ;
+            ++depth;
+            continue;
+        }
+        for (int d = 1; d < 258; ++d) count[d] += count[d - 1];
+        for (std::size_t i = 0; i < n; ++i) buf[count[msd_byte(*a[i].key, depth)]++] = a[i];
+        std::memcpy((void *) a, (const void *) buf, sizeof(msd_item<S>) * n);
+        // bucket 0 holds the keys that have ended, they are all equal
+        std::size_t start = count[0];
+        for (int d = 1; d < 257; ++d){
+            if (count[d] - start > 1) msd_radix_sort(a + start, buf + start, count[d] - start, depth + 1);
+            start = count[d];
+        }
+        return ;
+    }
+}
+
+/**
+ * the string keys of the elements: a copy of every key when key_of returns by value,
+ * or pointers straight into the elements when it returns a reference.
+ */
+template<class RandomIt, class KeyOf,
+         bool Reference = std::is_lvalue_reference<decltype(std::declval<KeyOf &>()(*std::declval<RandomIt>()))>::value>
+class msd_keys{
+public:
+    typedef typename std::decay<decltype(std::declval<KeyOf &>()(*std::declval<RandomIt>()))>::type S;
+private:
+    S *cache;
+    std::size_t size;
+public:
+    msd_keys(RandomIt begin, std::size_t n, KeyOf &key_of) : size(0){
+        cache = (S *) malloc(sizeof(S) * n);
+        if (!cache) throw std::bad_alloc();
+        for (; size < n; ++size) new(cache + size) S(key_of(*(begin + size)));
+    }
+    ~msd_keys(){
+        for (std::size_t i = 0; i < size; ++i) cache[i].~S();
+        free(cache);
+    }
+    const S *get(RandomIt, std::size_t i, KeyOf &) const {
+        return cache + i;
+    }
+};
+
+template<class RandomIt, class KeyOf>
+class msd_keys<RandomIt, KeyOf, true>{
+public:
+    typedef typename std::decay<decltype(std::declval<KeyOf &>()(*std::declval<RandomIt>()))>::type S;
+    msd_keys(RandomIt, std::size_t, KeyOf &){}
+    const S *get(RandomIt begin, std::size_t i, KeyOf &key_of) const {
+        return &key_of(*(begin + i));
+    }
+};
+
+/**
+ * byte string keys (anything with size() and operator[] over chars):
+ * sort (key pointer, index) items by msd radix sort, then permute the elements.
+ */
+template<class RandomIt, class KeyOf>
+void radix_sort(RandomIt begin, std::size_t n, KeyOf &key_of, std::false_type){
+    typedef msd_keys<RandomIt, KeyOf> keys_type;
+    typedef typename keys_type::S S;
+    std::size_t *order = (std::size_t *) malloc(sizeof(std::size_t) * n);
+    if (!order) throw std::bad_alloc();
+    msd_item<S> *items = (msd_item<S> *) malloc(sizeof(msd_item<S>) * n * 2);
+    if (!items){
+        free(order);
+        throw std::bad_alloc();
+    }
+    {
+        keys_type keys(begin, n, key_of);
+        for (std::size_t i = 0; i < n; ++i){
+            items[i].key = keys.get(begin, i, key_of);
+            items[i].index = i;
+        }
+        msd_radix_sort(items, items + n, n, 0);
+        for (std::size_t i = 0; i < n; ++i) order[i] = items[i].index;
+    }
+    free(items);
+    apply_order(begin, order, n);
+    free(order);
+}
+
+}
+
+/**
+ * sort [begin, end) in ascending order of key_of(element) (not stable) by radix sort.
+ * arithmetic keys (integers of any width, float, double) use an lsd radix sort,
+ * string keys (std::string, std::array<char, N>, ... compared bytewise as unsigned char)
+ * use an msd radix sort.
+ * elements that are large or not trivially copyable are sorted indirectly
+ * and moved to their final place once.
+ */
+template<class RandomIt, class KeyOf>
+void radix_sort(RandomIt begin, RandomIt end, KeyOf key_of){
+    typedef typename std::decay<decltype(key_of(*begin))>::type K;
+    std::ptrdiff_t n = end - begin;
+    if (n <= 1) return ;
+    detail::radix_sort(begin, (std::size_t) n, key_of, std::integral_constant<bool, std::is_arithmetic<K>::value>());
+}
+
+template<class RandomIt>
+void radix_sort(RandomIt begin, RandomIt end){
+    sjtu::radix_sort(begin, end, detail::radix_identity<typename detail::iter_value<RandomIt>::type>());
+}
+
+namespace detail{
+
+inline void prefetch(const void *addr){
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(addr);
+#endif
+}
+
+/**
+ * drop the trailing one bits of k and the zero bit before them.
+ */
+inline std::size_t drop_trailing_ones(std::size_t k){
+#if defined(__GNUC__) || defined(__clang__)
+    return ~k ? k >> (__builtin_ctzll(~(unsigned long long) k) + 1) : 0;
+#else
+    while (k & 1) k >>= 1;
+    return k >> 1;
+#endif
+}
+
+/**
+ * the number of search lanes interleaved by the batch searches,
+ * their independent memory accesses overlap instead of waiting for each other.
+ */
+const std::size_t search_batch = 16;
+
+/**
+ * branchless binary search shared by lower_bound (Strict) and upper_bound (!Strict):
+ * the range shrinks by half every step without a data-dependent branch,
+ * and both possible next probes are prefetched.
+ */
+template<bool Strict, class RandomIt, class T, class Compare>
+inline RandomIt branchless_bound(RandomIt begin, RandomIt end, const T &value, Compare &cmp){
+    std::ptrdiff_t len = end - begin;
+    if (len <= 0) return begin;
+    RandomIt base = begin;
+    while (len > 1){
+        std::ptrdiff_t half = len / 2;
+        prefetch(&*(base + half / 2));
+        prefetch(&*(base + (half + half / 2)));
+        bool right = Strict ? cmp(*(base + half), value) : !cmp(value, *(base + half));
+        base = right ? base + half : base;
+        len -= half;
+    }
+    bool right = Strict ? cmp(*base, value) : !cmp(value, *base);
+    return base + (std::ptrdiff_t) right;
+}
+
+template<bool Strict, class RandomIt, class T, class Compare>
+void branchless_bound_batch(RandomIt begin, RandomIt end, const T *values, std::size_t m, std::size_t *out, Compare &cmp){
+    std::ptrdiff_t n = end - begin;
+    std::ptrdiff_t base[search_batch];
+    for (std::size_t i = 0; i < m; i += search_batch){
+        std::size_t lanes = m - i < search_batch ? m - i : search_batch;
+        if (n <= 0){
+            for (std::size_t j = 0; j < lanes; ++j) out[i + j] = 0;
+            continue;
+        }
+        for (std::size_t j = 0; j < lanes; ++j) base[j] = 0;
+        // every lane walks the same sequence of lengths, so the steps can be interleaved
+        std::ptrdiff_t len = n;
+        while (len > 1){
+            std::ptrdiff_t half = len / 2;
+            for (std::size_t j = 0; j < lanes; ++j){
+                prefetch(&*(begin + (base[j] + half / 2)));
+                prefetch(&*(begin + (base[j] + half + half / 2)));
+            }
+            for (std::size_t j = 0; j < lanes; ++j){
+                const T &v = values[i + j];
+                bool right = Strict ? cmp(*(begin + (base[j] + half)), v) : !cmp(v, *(begin + (base[j] + half)));
+                base[j] += right ? half : 0;
+            }
+            len -= half;
+        }
+        for (std::size_t j = 0; j < lanes; ++j){
+            const T &v = values[i + j];
+            bool right = Strict ? cmp(*(begin + base[j]), v) : !cmp(v, *(begin + base[j]));
+            out[i + j] = base[j] + right;
+        }
+    }
+}
+
+}
+
+/**
+ * return the first position in the sorted range [begin, end) whose element is not less than value
+ * (end if there is none), using a branchless binary search with prefetching.
+ */
+template<class RandomIt, class T, class Compare>
+RandomIt lower_bound(RandomIt begin, RandomIt end, const T &value, Compare cmp){
+    return detail::branchless_bound<true>(begin, end, value, cmp);
+}
+
+template<class RandomIt, class T>
+RandomIt lower_bound(RandomIt begin, RandomIt end, const T &value){
+    std::less<T> cmp;
+    return detail::branchless_bound<true>(begin, end, value, cmp);
+}
+
+/**
+ * return the first position in the sorted range [begin, end) whose element is greater than value
+ * (end if there is none), using a branchless binary search with prefetching.
+ */
+template<class RandomIt, class T, class Compare>
+RandomIt upper_bound(RandomIt begin, RandomIt end, const T &value, Compare cmp){
+    return detail::branchless_bound<false>(begin, end, value, cmp);
+}
+
+template<class RandomIt, class T>
+RandomIt upper_bound(RandomIt begin, RandomIt end, const T &value){
+    std::less<T> cmp;
+    return detail::branchless_bound<false>(begin, end, value, cmp);
+}
+
+/**
+ * batch versions of lower_bound / upper_bound: answer the m queries in values at once,
+ * writing the index of the result (from 0 to end - begin) of query i to out[i].
+ * several searches are interleaved to hide the memory latency of each step.
+ */
+template<class RandomIt, class T, class Compare>
+void lower_bound_batch(RandomIt begin, RandomIt end, const T *values, std::size_t m, std::size_t *out, Compare cmp){
+    detail::branchless_bound_batch<true>(begin, end, values, m, out, cmp);
+}
+
+template<class RandomIt, class T, class Compare>
+void upper_bound_batch(RandomIt begin, RandomIt end, const T *values, std::size_t m, std::size_t *out, Compare cmp){
+    detail::branchless_bound_batch<false>(begin, end, values, m, out, cmp);
+}
+
+/**
+ * a static search index over a sorted sequence.
+ * the elements are copied in Eytzinger (breadth-first) order: the children of slot k are 2k and 2k+1,
+ * so the first levels of every search share a few cache lines and the next levels can be prefetched.
+ * results are reported as indices into the original sorted sequence.
+ */
+template<class T, class Compare = std::less<T>>
+class eytzinger_index : private functor_holder<Compare, 0>{
+private:
+    T *data;            // slots 1..n, slot 0 is unused
+    std::size_t *rank;  // index in the sorted sequence of every slot
+    std::size_t n;
+
+    /**
+     * how many slots fit in a cache line, the descendants of slot k four levels down
+     * start at slot 16k and share few cache lines.
+     */
+    static constexpr std::size_t prefetch_step = 16;
+
+    const Compare &compare() const {
+        return functor_holder<Compare, 0>::get();
+    }
+
+    template<class InputIt>
+    void build(InputIt &it, std::size_t &index, std::size_t k){
+        if (k > n) return ;
+        build(it, index, 2 * k);
+        new(data + k) T(*it);
+        rank[k] = index;
+        ++it, ++index;
+        build(it, index, 2 * k + 1);
+    }
+    void alloc(std::size_t size){
+        n = size;
+        data = (T *) malloc(sizeof(T) * (n + 1));
+        rank = (std::size_t *) malloc(sizeof(std::size_t) * (n + 1));
+        if (!data || !rank){
+            free(data);
+            free(rank);
+            throw std::bad_alloc();
+        }
+        rank[0] = n;
+    }
+    void release(){
+        for (std::size_t k = 1; k <= n; ++k) data[k].~T();
+        free(data);
+        free(rank);
+    }
+    /**
+     * the descent records every step in the bits of k, the answer is the last slot
+     * where the search went left: strip the trailing ones and the zero before them.
+     */
+    template<bool Strict>
+    std::size_t search(const T &value) const {
+        const Compare &cmp = compare();
+        std::size_t k = 1;
+        while (k <= n){
+            if (k * prefetch_step <= n) detail::prefetch(data + k * prefetch_step);
+            bool right = Strict ? cmp(data[k], value) : !cmp(value, data[k]);
+            k = 2 * k + right;
+        }
+        return rank[detail::drop_trailing_ones(k)];
+    }
+    template<bool Strict>
+    void search_batch(const T *values, std::size_t m, std::size_t *out) const {
+        const Compare &cmp = compare();
+        std::size_t k[detail::search_batch];
+        for (std::size_t i = 0; i < m; i += detail::search_batch){
+            std::size_t lanes = m - i < detail::search_batch ? m - i : detail::search_batch;
+            for (std::size_t j = 0; j < lanes; ++j) k[j] = 1;
+            // the tree is complete except for the last level, so all lanes go down in lockstep
+            // and at most one extra step needs a bound check
+            bool active = n > 0;
+            while (active){
+                active = false;
+                for (std::size_t j = 0; j < lanes; ++j){
+                    if (k[j] > n) continue;
+                    if (k[j] * prefetch_step <= n) detail::prefetch(data + k[j] * prefetch_step);
+                    bool right = Strict ? cmp(data[k[j]], values[i + j]) : !cmp(values[i + j], data[k[j]]);
+                    k[j] = 2 * k[j] + right;
+                    active |= k[j] <= n;
+                }
+            }
+            for (std::size_t j = 0; j < lanes; ++j) out[i + j] = rank[detail::drop_trailing_ones(k[j])];
+        }
+    }
+
+public:
+    eytzinger_index() : data(nullptr), rank(nullptr), n(0){
+        alloc(0);
+    }
+    /**
+     * an empty index searched in the order of comp, which is copied and used for every comparison
+     */
+    explicit eytzinger_index(const Compare &comp) : functor_holder<Compare, 0>(comp), data(nullptr), rank(nullptr), n(0){
+        alloc(0);
+    }
+    /**
+     * build the index from the range [begin, end), sorted in the order of comp
+     */
+    template<class InputIt>
+    eytzinger_index(InputIt begin, InputIt end, const Compare &comp = Compare())
+        : functor_holder<Compare, 0>(comp), data(nullptr), rank(nullptr), n(0){
+        std::size_t size = 0;
+        for (InputIt it = begin; it != end; ++it) ++size;
+        alloc(size);
+        std::size_t index = 0;
+        build(begin, index, 1);
+    }
+    eytzinger_index(const eytzinger_index &other) : functor_holder<Compare, 0>(other), data(nullptr), rank(nullptr), n(0){
+        alloc(other.n);
+        for (std::size_t k = 1; k <= n; ++k){
+            new(data + k) T(other.data[k]);
+            rank[k] = other.rank[k];
+        }
+    }
+    eytzinger_index &operator=(const eytzinger_index &other){
+        if (this == &other) return *this;
+        release();
+        functor_holder<Compare, 0>::operator=(other);
+        alloc(other.n);
+        for (std::size_t k = 1; k <= n; ++k){
+            new(data + k) T(other.data[k]);
+            rank[k] = other.rank[k];
+        }
+        return *this;
+    }
+    ~eytzinger_index(){
+        release();
+    }
+    std::size_t size() const {
+        return n;
+    }
+    /**
+     * index of the first element not less than value, size() if there is none.
+     */
+    std::size_t lower_bound(const T &value) const {
+        return search<true>(value);
+    }
+    /**
+     * index of the first element greater than value, size() if there is none.
+     */
+    std::size_t upper_bound(const T &value) const {
+        return search<false>(value);
+    }
+    /**
+     * answer m queries at once, out[i] is the result for values[i].
+     */
+    void lower_bound(const T *values, std::size_t m, std::size_t *out) const {
+        search_batch<true>(values, m, out);
+    }
+    void upper_bound(const T *values, std::size_t m, std::size_t *out) const {
+        search_batch<false>(values, m, out);
+    }
+};
+
+/**
+ * a k-way merge of sorted runs, driven by a tournament (loser) tree.
+ * every inner node of the tree remembers the loser of the match played there
+ * and the root slot the overall winner, so taking the next element replays
+ * only the log(k) matches on the path of the run it came from.
+ * the runs are [first, last) ranges of one input iterator type
+ * (pointers, sjtu::vector or sjtu::list iterators, ...), none of them is copied.
+ * equivalent elements come out in the order of the runs they belong to.
+ *
+ * the merge is pulled lazily through front()/pop() or the input iterator from begin()/end(),
+ * or pushed to an output iterator by copy().
+ */
+template<class InputIt, class Compare = std::less<typename detail::iter_value<InputIt>::type>>
+class kway_merger{
+public:
+    typedef typename detail::iter_value<InputIt>::type value_type;
+
+private:
+    struct run{
+        InputIt cur, last;
+        run(const InputIt &f, const InputIt &l) : cur(f), last(l){}
+    };
+
+    run *runs;
+    size_t k;           // number of runs added
+    size_t capacity;    // allocated run slots
+    size_t leaves;      // number of leaves of the tree, a power of two not less than k
+    size_t *tree;       // tree[0] is the winner, tree[1..leaves) the losers of the inner nodes
+    bool built;
+    Compare cmp;
+
+    bool exhausted(size_t i) const {
+        return i >= k || !(runs[i].cur != runs[i].last);
+    }
+    /**
+     * whether run a should be taken before run b, exhausted runs lose to everything
+     */
+    bool beats(size_t a, size_t b) const {
+        if (exhausted(a)) return false;
+        if (exhausted(b)) return true;
+        if (cmp(*runs[b].cur, *runs[a].cur)) return false;
+        return cmp(*runs[a].cur, *runs[b].cur) || a < b;
+    }
+    size_t play(size_t node){
+        if (node >= leaves) return node - leaves;
+        size_t l = play(2 * node), r = play(2 * node + 1);
+        if (beats(l, r)){
+            tree[node] = r;
+            return l;
+        }
+        tree[node] = l;
+        return r;
+    }
+    void build(){
+        free(tree);
+        leaves = 1;
+        while (leaves < k) leaves <<= 1;
+        tree = (size_t *) malloc(sizeof(size_t) * leaves);
+        if (!tree) throw std::bad_alloc();
+        tree[0] = play(1);
+        built = true;
+    }
+    /**
+     * the run i has advanced, replay the matches from its leaf up to the root
+     */
+    void replay(size_t i){
+        size_t winner = i;
+        for (size_t node = (i + leaves) >> 1; node >= 1; node >>= 1)
+            if (beats(tree[node], winner)){
+                size_t tmp = tree[node];
+                tree[node] = winner;
+                winner = tmp;
+            }
+        tree[0] = winner;
+    }
+
+public:
+    class iterator{
+        friend class kway_merger;
+    private:
+        kway_merger *merger;
+        iterator(kway_merger *m) : merger(m){}
+    public:
+        using difference_type = std::ptrdiff_t;
+        using value_type = typename kway_merger::value_type;
+        using pointer = const value_type *;
+        using reference = const value_type &;
+        using iterator_category = std::input_iterator_tag;
+
+        iterator() : merger(nullptr){}
+        const value_type &operator*() const {
+            return merger->front();
+        }
+        const value_type *operator->() const {
+            return &merger->front();
+        }
+        iterator &operator++(){
+            merger->pop();
+            return *this;
+        }
+        /**
+         * two iterators are equal when both are at the end of the merge
+         */
+        bool operator==(const iterator &rhs) const {
+            return (!merger || merger->empty()) == (!rhs.merger || rhs.merger->empty());
+        }
+        bool operator!=(const iterator &rhs) const {
+            return !((*this) == rhs);
+        }
+    };
+
+    explicit kway_merger(const Compare &c = Compare())
+        : runs(nullptr), k(0), capacity(0), leaves(0), tree(nullptr), built(false), cmp(c){}
+    /**
+     * merge the sorted ranges [firsts[i], lasts[i]) for i in [0, n)
+     */
+    kway_merger(const InputIt *firsts, const InputIt *lasts, size_t n, const Compare &c = Compare())
+        : runs(nullptr), k(0), capacity(0), leaves(0), tree(nullptr), built(false), cmp(c){
+        for (size_t i = 0; i < n; ++i) add(firsts[i], lasts[i]);
+    }
+    kway_merger(const kway_merger &other)
+        : runs(nullptr), k(0), capacity(0), leaves(0), tree(nullptr), built(false), cmp(other.cmp){
+        for (size_t i = 0; i < other.k; ++i) add(other.runs[i].cur, other.runs[i].last);
+    }
+    kway_merger &operator=(const kway_merger &other){
+        if (this == &other) return *this;
+        clear();
+        cmp = other.cmp;
+        for (size_t i = 0; i < other.k; ++i) add(other.runs[i].cur, other.runs[i].last);
+        return *this;
+    }
+    ~kway_merger(){
+        clear();
+        free(runs);
+    }
+    /**
+     * add one more sorted run, the tree is rebuilt on the next access
+     */
+    void add(const InputIt &first, const InputIt &last){
+        if (k == capacity){
+            size_t new_capacity = capacity ? capacity * 2 : 8;
+            run *tmp = (run *) malloc(sizeof(run) * new_capacity);
+            if (!tmp) throw std::bad_alloc();
+            for (size_t i = 0; i < k; ++i){
+                new(tmp + i) run(runs[i]);
+                runs[i].~run();
+            }
+            free(runs);
+            runs = tmp;
+            capacity = new_capacity;
+        }
+        new(runs + k) run(first, last);
+        ++k;
+        built = false;
+    }
+    void clear(){
+        for (size_t i = 0; i < k; ++i) runs[i].~run();
+        k = 0;
+        free(tree);
+        tree = nullptr;
+        built = false;
+    }
+    /**
+     * whether every run is exhausted
+     */
+    bool empty(){
+        if (!built) build();
+        return exhausted(tree[0]);
+    }
+    /**
+     * the smallest remaining element
+     * throw container_is_empty if the merge is finished.
+     */
+    const value_type &front(){
+        if (empty()) throw container_is_empty();
+        return *runs[tree[0]].cur;
+    }
+    /**
+     * the index (in order of adding) of the run that front() comes from
+     */
+    size_t source(){
+        if (empty()) throw container_is_empty();
+        return tree[0];
+    }
+    /**
+     * drop the smallest remaining element
+     * throw container_is_empty if the merge is finished.
+     */
+    void pop(){
+        if (empty()) throw container_is_empty();
+        size_t i = tree[0];
+        ++runs[i].cur;
+        replay(i);
+    }
+    iterator begin(){
+        return iterator(this);
+    }
+    iterator end(){
+        return iterator(nullptr);
+    }
+    /**
+     * write the rest of the merge to out and return the end of the written range
+     */
+    template<class OutputIt>
+    OutputIt copy(OutputIt out){
+        if (!built) build();
+        while (!exhausted(tree[0])){
+            size_t i = tree[0];
+            *out = *runs[i].cur;
+            ++out;
+            ++runs[i].cur;
+            replay(i);
+        }
+        return out;
+    }
+};
+
+/**
+ * merge the n sorted ranges [firsts[i], lasts[i]) into out, return the end of the written range.
+ */
+template<class InputIt, class OutputIt, class Compare>
+OutputIt kway_merge(const InputIt *firsts, const InputIt *lasts, size_t n, OutputIt out, Compare cmp){
+    kway_merger<InputIt, Compare> merger(firsts, lasts, n, cmp);
+    return merger.copy(out);
+}
+
+template<class InputIt, class OutputIt>
+OutputIt kway_merge(const InputIt *firsts, const InputIt *lasts, size_t n, OutputIt out){
+    return sjtu::kway_merge(firsts, lasts, n, out, std::less<typename detail::iter_value<InputIt>::type>());
+}
+
+};
+
+#endif //SJTU_ALGORITHM_HPP
@@ -0,0 +1,57 @@
+// binary search benchmark: branchy search, sjtu::lower_bound, batch search and eytzinger_index
+// usage: ./code [max_n] [queries]
+
+#include "algorithm.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// the search used before: int indices and a branch on every step
+size_t branchy_lower_bound(const int *a, int n, int x) {
+    int l = -1, r = n;
+    while (l + 1 < r) {
+        int mid = (l + r) >> 1;
+        if (x <= a[mid]) r = mid; else l = mid;
+    }
+    return r;
+}
+
+int main(int argc, char *argv[]) {
+    long long max_n = argc > 1 ? std::atoll(argv[1]) : 1 << 24;
+    size_t m = argc > 2 ? std::atoll(argv[2]) : 1000000;
+    std::mt19937 rng(20230501);
+    std::printf("%10s %12s %12s %12s %12s %12s   (ns per query)\n",
+                "n", "branchy", "branchless", "batch", "eytzinger", "eytz-batch");
+    for (long long n = 1 << 10; n <= max_n; n <<= 2) {
+        std::vector<int> a(n);
+        for (long long i = 0; i < n; ++i) a[i] = (int) (i * 3);
+        std::vector<int> q(m);
+        for (auto &x : q) x = (int) (rng() % (3 * n));
+        std::vector<size_t> expected(m), out(m);
+        sjtu::eytzinger_index<int> index(a.begin(), a.end());
+
+        double t0 = timeit([&] { for (size_t i = 0; i < m; ++i) expected[i] = branchy_lower_bound(a.data(), n, q[i]); });
+        double t1 = timeit([&] {
+            for (size_t i = 0; i < m; ++i) out[i] = sjtu::lower_bound(a.data(), a.data() + n, q[i]) - a.data();
+        });
+        if (out != expected) { std::printf("WRONG ANSWER: lower_bound\n"); return 1; }
+        double t2 = timeit([&] { sjtu::lower_bound_batch(a.data(), a.data() + n, q.data(), m, out.data(), std::less<int>()); });
+        if (out != expected) { std::printf("WRONG ANSWER: lower_bound_batch\n"); return 1; }
+        double t3 = timeit([&] { for (size_t i = 0; i < m; ++i) out[i] = index.lower_bound(q[i]); });
+        if (out != expected) { std::printf("WRONG ANSWER: eytzinger_index\n"); return 1; }
+        double t4 = timeit([&] { index.lower_bound(q.data(), m, out.data()); });
+        if (out != expected) { std::printf("WRONG ANSWER: eytzinger_index batch\n"); return 1; }
+        std::printf("%10lld %12.1f %12.1f %12.1f %12.1f %12.1f\n", n, t0 / m, t1 / m, t2 / m, t3 / m, t4 / m);
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+// k-way merge benchmark: kway_merger (loser tree) against repeated pairwise list::merge
+// usage: ./code [total_elements]
+
+#include "list.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int total = argc > 1 ? std::atoi(argv[1]) : 2000000;
+    std::mt19937_64 rng(20230501);
+    int ks[] = {2, 16, 256};
+    for (int k : ks) {
+        std::vector<std::vector<long long>> runs(k);
+        for (int i = 0; i < total; ++i) runs[rng() % k].push_back((long long) (rng() >> 1));
+        std::vector<long long> expected;
+        for (auto &r : runs) {
+            std::sort(r.begin(), r.end());
+            expected.insert(expected.end(), r.begin(), r.end());
+        }
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<sjtu::list<long long>> lists(k);
+        for (int i = 0; i < k; ++i)
+            for (long long x : runs[i]) lists[i].push_back(x);
+
+        // loser tree over the list runs, pulled into an array
+        std::vector<long long> out;
+        out.reserve(total);
+        double t_kway_list = timeit([&] {
+            sjtu::kway_merger<sjtu::list<long long>::const_iterator> merger;
+            for (int i = 0; i < k; ++i) merger.add(lists[i].cbegin(), lists[i].cend());
+            merger.copy(std::back_inserter(out));
+        });
+        if (out != expected) { std::printf("WRONG ANSWER: kway list\n"); return 1; }
+
+        // loser tree over array runs
+        std::vector<const long long *> firsts(k), lasts(k);
+        for (int i = 0; i < k; ++i) {
+            firsts[i] = runs[i].data();
+            lasts[i] = runs[i].data() + runs[i].size();
+        }
+        out.assign(total, 0);
+        double t_kway_array = timeit([&] { sjtu::kway_merge(firsts.data(), lasts.data(), k, out.data()); });
+        if (out != expected) { std::printf("WRONG ANSWER: kway array\n"); return 1; }
+
+        // the old way: merge every run into an accumulator list one after another
+        double t_pairwise = timeit([&] {
+            for (int i = 1; i < k; ++i) lists[0].merge(lists[i]);
+        });
+        auto it = lists[0].cbegin();
+        for (size_t i = 0; i < expected.size(); ++i, ++it)
+            if (*it != expected[i]) { std::printf("WRONG ANSWER: pairwise\n"); return 1; }
+
+        std::printf("k = %3d  kway (lists) %9.2f ms  kway (arrays) %9.2f ms  pairwise list::merge %9.2f ms\n",
+                    k, t_kway_list, t_kway_array, t_pairwise);
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+// parallel sort scaling benchmark: sjtu::parallel_sort from 1 thread to all hardware threads
+// usage: ./code [n]
+
+#include "parallel.hpp"
+#include "list.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    unsigned hw = std::thread::hardware_concurrency();
+    std::mt19937_64 rng(20230501);
+    std::vector<long long> origin(n);
+    for (auto &x : origin) x = rng();
+    std::vector<long long> expected = origin;
+    std::sort(expected.begin(), expected.end());
+
+    std::printf("n = %d, hardware threads = %u\n", n, hw);
+    double base = 0;
+    for (unsigned threads = 1;; threads = threads * 2 > hw ? hw : threads * 2) {
+        std::vector<long long> a = origin;
+        double t = timeit([&] { sjtu::parallel_sort(a.data(), a.data() + n, std::less<long long>(), threads); });
+        if (a != expected) {
+            std::printf("WRONG ANSWER: %u threads\n", threads);
+            return 1;
+        }
+        if (threads == 1) base = t;
+        std::printf("threads %3u  %10.2f ms  speedup %5.2fx\n", threads, t, base / t);
+        if (threads == hw) break;
+    }
+
+    sjtu::list<long long> list;
+    for (int i = 0; i < n / 10; ++i) list.push_back(origin[i]);
+    sjtu::list<long long> copy = list;
+    double t_seq = timeit([&] { list.sort(); });
+    double t_par = timeit([&] { copy.sort(0); });
+    auto it = list.cbegin();
+    for (auto jt = copy.cbegin(); jt != copy.cend(); ++it, ++jt)
+        if (*it != *jt) {
+            std::printf("WRONG ANSWER: list::sort\n");
+            return 1;
+        }
+    std::printf("list::sort of %d elements: sequential %.2f ms, parallel %.2f ms\n", n / 10, t_seq, t_par);
+    return 0;
+}
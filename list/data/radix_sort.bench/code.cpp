@@ -0,0 +1,67 @@
+// radix sort benchmark: sjtu::radix_sort against the comparison sjtu::sort
+// usage: ./code [max_n]   (n runs over 1M, 10M, 100M up to max_n)
+
+#include "algorithm.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+struct Record {
+    long long key;
+    char payload[120];
+};
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename T, typename Gen, typename Key, typename Less>
+void run(const char *name, int n, Gen gen, Key key, Less less) {
+    std::vector<T> a(n);
+    for (int i = 0; i < n; ++i) a[i] = gen(i);
+    std::vector<T> b = a;
+    double t_radix = timeit([&] { sjtu::radix_sort(a.data(), a.data() + n, key); });
+    double t_sort = timeit([&] { sjtu::sort(b.data(), b.data() + n, less); });
+    for (int i = 0; i < n; ++i)
+        if (less(a[i], b[i]) || less(b[i], a[i])) {
+            std::printf("WRONG ANSWER: %s\n", name);
+            std::exit(1);
+        }
+    std::printf("%-22s n=%10d  radix_sort %10.2f ms   sort %10.2f ms   %5.2fx\n",
+                name, n, t_radix, t_sort, t_sort / t_radix);
+}
+
+int main(int argc, char *argv[]) {
+    long long max_n = argc > 1 ? std::atoll(argv[1]) : 10000000;
+    std::mt19937_64 rng(20230501);
+    for (long long n = 1000000; n <= max_n; n *= 10) {
+        run<unsigned>("uint32", n, [&](int) { return (unsigned) rng(); },
+                      [](unsigned x) { return x; }, std::less<unsigned>());
+        run<long long>("int64", n, [&](int) { return (long long) rng(); },
+                       [](long long x) { return x; }, std::less<long long>());
+        run<long long>("int64 (small range)", n, [&](int) { return (long long) (rng() % 100000); },
+                       [](long long x) { return x; }, std::less<long long>());
+        run<double>("double", n, [&](int) { return (double) (long long) rng() / 1e9; },
+                    [](double x) { return x; }, std::less<double>());
+        run<std::array<char, 16>>("16-byte string", n, [&](int) {
+            std::array<char, 16> s;
+            for (auto &c : s) c = 'a' + rng() % 26;
+            return s;
+        }, [](const std::array<char, 16> &s) -> const std::array<char, 16> & { return s; },
+           [](const std::array<char, 16> &x, const std::array<char, 16> &y) {
+            return std::memcmp(x.data(), y.data(), 16) < 0;
+        });
+        run<Record>("128-byte record", n, [&](int) { Record r; r.key = (long long) rng(); return r; },
+                    [](const Record &r) { return r.key; },
+                    [](const Record &x, const Record &y) { return x.key < y.key; });
+    }
+    return 0;
+}
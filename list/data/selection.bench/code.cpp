@@ -0,0 +1,65 @@
+// selection benchmark: nth_element, partial_sort, partial_sort_copy and streaming top_k
+// against a full sjtu::sort, for k in {10, 1000, n/2}
+// usage: ./code [n]
+
+#include "algorithm.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void check(bool ok, const char *name) {
+    if (!ok) {
+        std::printf("WRONG ANSWER: %s\n", name);
+        std::exit(1);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    std::mt19937_64 rng(20230501);
+    std::vector<long long> origin(n);
+    for (auto &x : origin) x = (long long) (rng() >> 1);
+    std::vector<long long> sorted = origin;
+    double t_sort = timeit([&] { sjtu::sort(sorted.data(), sorted.data() + n); });
+    std::printf("n = %d, full sjtu::sort %.2f ms\n", n, t_sort);
+
+    int ks[] = {10, 1000, n / 2};
+    for (int k : ks) {
+        std::vector<long long> a = origin;
+        double t_nth = timeit([&] { sjtu::nth_element(a.data(), a.data() + (k - 1), a.data() + n); });
+        check(a[k - 1] == sorted[k - 1], "nth_element");
+
+        a = origin;
+        double t_partial = timeit([&] { sjtu::partial_sort(a.data(), a.data() + k, a.data() + n); });
+        check(std::equal(a.begin(), a.begin() + k, sorted.begin()), "partial_sort");
+
+        std::vector<long long> out(k);
+        double t_copy = timeit([&] { sjtu::partial_sort_copy(origin.data(), origin.data() + n, out.data(), out.data() + k); });
+        check(std::equal(out.begin(), out.end(), sorted.begin()), "partial_sort_copy");
+
+        out.clear();
+        double t_stream = timeit([&] {
+            sjtu::top_k<long long> top(k);
+            const int chunk = 65536;
+            for (int i = 0; i < n; i += chunk)
+                top.push(origin.data() + i, origin.data() + std::min(n, i + chunk));
+            top.copy(std::back_inserter(out));
+        });
+        check(std::equal(out.begin(), out.end(), sorted.begin()), "top_k");
+
+        std::printf("k = %9d  nth_element %9.2f ms  partial_sort %9.2f ms  partial_sort_copy %9.2f ms  top_k %9.2f ms\n",
+                    k, t_nth, t_partial, t_copy, t_stream);
+    }
+    return 0;
+}
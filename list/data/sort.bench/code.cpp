@@ -0,0 +1,72 @@
+// sort benchmark: sjtu::sort against std::sort on several input patterns
+// usage: ./code [n]
+
+#include "algorithm.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+int n = 1000000;
+
+template<typename T>
+T make(long long x) {
+    return (T) x;
+}
+
+template<>
+std::string make<std::string>(long long x) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "key%012lld", x);
+    return buf;
+}
+
+template<typename T>
+std::vector<T> generate(const char *pattern) {
+    std::mt19937_64 rng(20230501);
+    std::vector<T> v(n);
+    std::string p = pattern;
+    for (int i = 0; i < n; ++i) {
+        if (p == "random") v[i] = make<T>(rng() % 1000000000);
+        else if (p == "sorted") v[i] = make<T>(i);
+        else if (p == "reversed") v[i] = make<T>(n - i);
+        else if (p == "duplicates") v[i] = make<T>(rng() % 16);
+        else v[i] = make<T>(i % 1000 == 0 ? (long long) (rng() % n) : i); // nearly sorted
+    }
+    return v;
+}
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename T>
+void run(const char *type) {
+    const char *patterns[] = {"random", "sorted", "reversed", "duplicates", "nearly"};
+    for (const char *pattern : patterns) {
+        std::vector<T> a = generate<T>(pattern), b = a;
+        double t_sjtu = timeit([&] { sjtu::sort(a.data(), a.data() + n, std::less<T>()); });
+        double t_std = timeit([&] { std::sort(b.begin(), b.end()); });
+        if (a != b) {
+            std::printf("WRONG ANSWER: %s %s\n", type, pattern);
+            std::exit(1);
+        }
+        std::printf("%-12s %-11s sjtu::sort %9.2f ms   std::sort %9.2f ms\n", type, pattern, t_sjtu, t_std);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1) n = std::atoi(argv[1]);
+    std::printf("n = %d\n", n);
+    run<int>("int");
+    run<double>("double");
+    run<std::string>("std::string");
+    return 0;
+}
@@ -8,6 +8,12 @@
 #include <cstddef>
 
 namespace sjtu {
+
+namespace detail {
+// sorts for list::sort(threads), defined in parallel.hpp
+template<class T> struct list_sorter;
+}
+
 /**
  * a data container like std::list
  * allocate random memory addresses for data and they are doubly-linked in a list.
@@ -64,6 +70,31 @@ protected:
         length--;
         return pos;
     }
+    /**
+     * move the values out into an array, sort it with sorter(first, last) and move them back
+     */
+    template<class Sorter>
+    void sort_array(Sorter sorter) {
+        T* arr=(T *) malloc(sizeof(T)*length);
+        size_t cnt=0;
+        node *p=head->next;
+        while (p!=tail){
+            new(arr+cnt) T(*(p->data));
+            p->data->~T();
+            cnt++;
+            p=p->next;
+        }
+        sorter(arr,arr+cnt);
+        cnt=0;
+        p=head->next;
+        while (p!=tail){
+            new(p->data) T(arr[cnt]);
+            arr[cnt].~T();
+            cnt++;
+            p=p->next;
+        }
+        free(arr);
+    }
 
 public:
     class const_iterator;
@@ -415,25 +446,15 @@ public:
      * sort the values in ascending order with operator< of T
      */
     void sort() {
-        T* arr=(T *) malloc(sizeof(T)*length);
-        size_t cnt=0;
-        node *p=head->next;
-        while (p!=tail){
-            new(arr+cnt) T(*(p->data));
-            p->data->~T();
-            cnt++;
-            p=p->next;
-        }
-        sjtu::sort<T>(arr,arr+cnt,std::less<T>());
-        cnt=0;
-        p=head->next;
-        while (p!=tail){
-            new(p->data) T(arr[cnt]);
-            arr[cnt].~T();
-            cnt++;
-            p=p->next;
-        }
-        free(arr);
+        sort_array([](T *first,T *last){ sjtu::sort(first,last,std::less<T>()); });
+    }
+    /**
+     * same as sort(), but sort with sjtu::parallel_sort using the given number of threads
+     * (0 for all hardware threads). include parallel.hpp to use it, list.hpp does not pull in threads.
+     */
+    template<class U=T>
+    void sort(size_t threads) {
+        sort_array(detail::list_sorter<U>(threads));
     }
     /**
      * merge two sorted lists into one (both in ascending order)
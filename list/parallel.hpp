@@ -0,0 +1,355 @@
+#ifndef SJTU_PARALLEL_HPP
+#define SJTU_PARALLEL_HPP
+
+#include "algorithm.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace sjtu{
+
+/**
+ * a small work-stealing thread pool.
+ * every worker owns a deque: it pushes and pops its own tasks at the back
+ * and steals from the front of the other deques when its own one is empty.
+ * tasks submitted by a thread outside the pool are spread over the deques.
+ */
+class task_pool{
+private:
+    struct task_queue{
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::thread> workers;
+    task_queue *queues;
+    size_t queue_num;
+    std::atomic<size_t> queued;
+    std::atomic<size_t> next_queue;
+    std::atomic<bool> stopped;
+    std::mutex sleep_lock;
+    std::condition_variable sleep_cv;
+
+    struct worker_info{
+        task_pool *pool;
+        size_t id;
+    };
+    static worker_info &current(){
+        static thread_local worker_info info = {nullptr, 0};
+        return info;
+    }
+
+    bool pop(size_t id, std::function<void()> &task){
+        std::lock_guard<std::mutex> guard(queues[id].lock);
+        if (queues[id].tasks.empty()) return false;
+        task = std::move(queues[id].tasks.back());
+        queues[id].tasks.pop_back();
+        return true;
+    }
+    bool steal(size_t id, std::function<void()> &task){
+        std::unique_lock<std::mutex> guard(queues[id].lock, std::try_to_lock);
+        if (!guard.owns_lock() || queues[id].tasks.empty()) return false;
+        task = std::move(queues[id].tasks.front());
+        queues[id].tasks.pop_front();
+        return true;
+    }
+    void work(size_t id){
+        current().pool = this;
+        current().id = id;
+        while (!stopped){
+            if (run_one()) continue;
+            std::unique_lock<std::mutex> guard(sleep_lock);
+            sleep_cv.wait(guard, [this]{ return stopped || queued > 0; });
+        }
+    }
+
+public:
+    /**
+     * start a pool with the given number of threads, 0 for all hardware threads.
+     */
+    explicit task_pool(size_t threads = 0) : queued(0), next_queue(0), stopped(false){
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 1;
+        queue_num = threads;
+        queues = new task_queue[queue_num];
+        for (size_t i = 0; i < threads; ++i)
+            workers.emplace_back(&task_pool::work, this, i);
+    }
+    task_pool(const task_pool &other) = delete;
+    task_pool &operator=(const task_pool &other) = delete;
+    ~task_pool(){
+        {
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            stopped = true;
+        }
+        sleep_cv.notify_all();
+        for (size_t i = 0; i < workers.size(); ++i) workers[i].join();
+        delete[] queues;
+    }
+    size_t size() const {
+        return workers.size();
+    }
+    /**
+     * queue a task, a worker of this pool queues it on its own deque.
+     */
+    void submit(std::function<void()> task){
+        size_t id = current().pool == this ? current().id : next_queue++ % queue_num;
+        {
+            std::lock_guard<std::mutex> guard(queues[id].lock);
+            queues[id].tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            ++queued;
+        }
+        sleep_cv.notify_one();
+    }
+    /**
+     * run one queued task on the calling thread, own deque first, then steal.
+     * return false if no task could be found.
+     */
+    bool run_one(){
+        std::function<void()> task;
+        size_t start = current().pool == this ? current().id : 0;
+        bool found = current().pool == this && pop(start, task);
+        for (size_t i = 0; !found && i < queue_num; ++i)
+            found = steal((start + i) % queue_num, task);
+        if (!found) return false;
+        --queued;
+        task();
+        return true;
+    }
+};
+
+/**
+ * a set of forked tasks that can be joined.
+ * wait() keeps running queued tasks instead of blocking,
+ * so nested fork-join on the same pool never deadlocks.
+ * the first exception thrown by a task is kept and rethrown by wait().
+ */
+class task_group{
+private:
+    task_pool &pool;
+    std::atomic<size_t> pending;
+    std::mutex error_lock;
+    std::exception_ptr error;
+
+    // counts a task as done when it returns or throws
+    struct done_guard{
+        task_group *group;
+        ~done_guard(){
+            --group->pending;
+        }
+    };
+    void join(){
+        while (pending > 0)
+            if (!pool.run_one()) std::this_thread::yield();
+    }
+
+public:
+    explicit task_group(task_pool &p) : pool(p), pending(0){}
+    task_group(const task_group &other) = delete;
+    task_group &operator=(const task_group &other) = delete;
+    /**
+     * waits for the tasks, an exception of theirs that was not rethrown by wait() is dropped.
+     */
+    ~task_group(){
+        join();
+    }
+    template<class F>
+    void run(F f){
+        ++pending;
+        pool.submit([this, f]{
+            done_guard guard = {this};
+            try{
+                f();
+            } catch (...){
+                std::lock_guard<std::mutex> lock(error_lock);
+                if (!error) error = std::current_exception();
+            }
+        });
+    }
+    void wait(){
+        join();
+        std::exception_ptr e;
+        {
+            std::lock_guard<std::mutex> lock(error_lock);
+            e = error;
+            error = nullptr;
+        }
+        if (e) std::rethrow_exception(e);
+    }
+};
+
+namespace detail{
+
+const std::ptrdiff_t parallel_sort_cutoff = 1 << 14;
+const std::ptrdiff_t parallel_merge_cutoff = 1 << 14;
+
+template<class InputIt, class OutputIt, class Compare>
+void sequential_merge(InputIt x, InputIt x_end, InputIt y, InputIt y_end, OutputIt out, Compare &cmp){
+    while (x != x_end && y != y_end){
+        if (cmp(*y, *x)) *out = std::move(*y), ++y;
+        else *out = std::move(*x), ++x;
+        ++out;
+    }
+    for (; x != x_end; ++x, ++out) *out = std::move(*x);
+    for (; y != y_end; ++y, ++out) *out = std::move(*y);
+}
+
+/**
+ * stable merge of [x, x_end) and [y, y_end) into out, split recursively by binary search
+ * so that both halves are merged concurrently.
+ */
+template<class InputIt, class OutputIt, class Compare>
+void parallel_merge(task_pool &pool, InputIt x, InputIt x_end, InputIt y, InputIt y_end, OutputIt out, Compare &cmp){
+    std::ptrdiff_t nx = x_end - x, ny = y_end - y;
+    if (nx + ny <= parallel_merge_cutoff){
+        sequential_merge(x, x_end, y, y_end, out, cmp);
+        return ;
+    }
+    InputIt x_mid = x, y_mid = y;
+    if (nx >= ny){
+        // elements of y strictly less than the pivot of x go before it
+        x_mid = x + nx / 2;
+        std::ptrdiff_t l = 0, r = ny;
+        while (l < r){
+            std::ptrdiff_t m = (l + r) >> 1;
+            if (cmp(*(y + m), *x_mid)) l = m + 1; else r = m;
+        }
+        y_mid = y + l;
+    } else {
+        // elements of x not greater than the pivot of y go before it
+        y_mid = y + ny / 2;
+        std::ptrdiff_t l = 0, r = nx;
+        while (l < r){
+            std::ptrdiff_t m = (l + r) >> 1;
+            if (cmp(*y_mid, *(x + m))) r = m; else l = m + 1;
+        }
+        x_mid = x + l;
+    }
+    OutputIt out_mid = out + ((x_mid - x) + (y_mid - y));
+    task_group group(pool);
+    group.run([&]{ parallel_merge(pool, x, x_mid, y, y_mid, out, cmp); });
+    parallel_merge(pool, x_mid, x_end, y_mid, y_end, out_mid, cmp);
+    group.wait();
+}
+
+/**
+ * sort the n elements at a, leaving the result in buf if into_buf, otherwise in a.
+ * the two halves are sorted into the other array, then merged back.
+ */
+template<class RandomIt, class BufferIt, class Compare>
+void parallel_merge_sort(task_pool &pool, RandomIt a, BufferIt buf, std::ptrdiff_t n, Compare &cmp, bool into_buf){
+    if (n <= parallel_sort_cutoff){
+        sjtu::sort(a, a + n, cmp);
+        if (into_buf)
+            for (std::ptrdiff_t i = 0; i < n; ++i) *(buf + i) = std::move(*(a + i));
+        return ;
+    }
+    std::ptrdiff_t mid = n / 2;
+    {
+        task_group group(pool);
+        group.run([&]{ parallel_merge_sort(pool, a, buf, mid, cmp, !into_buf); });
+        parallel_merge_sort(pool, a + mid, buf + mid, n - mid, cmp, !into_buf);
+        group.wait();
+    }
+    if (into_buf) parallel_merge(pool, a, a + mid, a + mid, a + n, buf, cmp);
+    else parallel_merge(pool, buf, buf + mid, buf + mid, buf + n, a, cmp);
+}
+
+/**
+ * the temporary array of parallel_sort, filled in chunks of chunk elements, built[c] of them constructed in chunk c.
+ * whatever was constructed is destroyed and the memory freed, also when the sort throws.
+ */
+template<class T>
+class sort_buffer{
+public:
+    std::vector<std::ptrdiff_t> built;
+    std::ptrdiff_t chunk;
+    T *data;
+
+    sort_buffer(std::ptrdiff_t n, std::ptrdiff_t chunk) : built((n + chunk - 1) / chunk, 0), chunk(chunk){
+        data = (T *) malloc(sizeof(T) * n);
+        if (!data) throw std::bad_alloc();
+    }
+    sort_buffer(const sort_buffer &other) = delete;
+    sort_buffer &operator=(const sort_buffer &other) = delete;
+    ~sort_buffer(){
+        for (size_t c = 0; c < built.size(); ++c)
+            for (std::ptrdiff_t i = 0; i < built[c]; ++i) data[c * chunk + i].~T();
+        free(data);
+    }
+};
+
+/**
+ * sorts the array behind list::sort(threads), declared in list.hpp
+ */
+template<class T>
+struct list_sorter{
+    size_t threads;
+    explicit list_sorter(size_t threads) : threads(threads){}
+    void operator()(T *first, T *last) const;
+};
+
+}
+
+/**
+ * sort [begin, end) in ascending order of cmp with a parallel merge sort on a work-stealing pool.
+ * ranges shorter than the sequential cutoff are left to sjtu::sort.
+ * threads is the number of worker threads, 0 for all hardware threads.
+ * RandomIt may be a raw pointer or an iterator of sjtu::vector.
+ * needs a temporary buffer of end - begin elements.
+ */
+template<class RandomIt, class Compare>
+void parallel_sort(RandomIt begin, RandomIt end, Compare cmp, size_t threads = 0){
+    typedef typename detail::iter_value<RandomIt>::type T;
+    std::ptrdiff_t n = end - begin;
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (n <= detail::parallel_sort_cutoff || threads <= 1){
+        sjtu::sort(begin, end, cmp);
+        return ;
+    }
+    task_pool pool(threads);
+    std::ptrdiff_t chunk = (n + threads - 1) / threads;
+    detail::sort_buffer<T> buf(n, chunk);
+    {
+        // the elements are moved into the buffer and sorted from there back into [begin, end),
+        // so that the sort itself only move-assigns
+        task_group group(pool);
+        for (std::ptrdiff_t l = 0, c = 0; l < n; l += chunk, ++c){
+            std::ptrdiff_t r = l + chunk < n ? l + chunk : n;
+            group.run([=, &buf]{
+                for (std::ptrdiff_t i = l; i < r; ++i){
+                    new(buf.data + i) T(std::move(*(begin + i)));
+                    ++buf.built[c];
+                }
+            });
+        }
+        group.wait();
+    }
+    detail::parallel_merge_sort(pool, buf.data, begin, n, cmp, true);
+}
+
+template<class RandomIt>
+void parallel_sort(RandomIt begin, RandomIt end){
+    sjtu::parallel_sort(begin, end, std::less<typename detail::iter_value<RandomIt>::type>());
+}
+
+template<class T>
+void detail::list_sorter<T>::operator()(T *first, T *last) const {
+    sjtu::parallel_sort(first, last, std::less<T>(), threads);
+}
+
+}
+
+#endif //SJTU_PARALLEL_HPP
@@ -0,0 +1,202 @@
+/**
+ * a map that keeps a monoid aggregate of the mapped values in every subtree
+ */
+#ifndef SJTU_AUGMENTED_MAP_HPP
+#define SJTU_AUGMENTED_MAP_HPP
+
+#include <functional>
+#include <cstddef>
+#include "map.hpp"
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * the node augmentation behind augmented_map: the aggregate of the mapped values
+ *   of a subtree in key order, combined from the children on every change.
+ */
+template<class Monoid>
+struct monoid_augment{
+    typedef typename Monoid::value_type value_type;
+    struct node_data{
+        value_type aggregate;
+    };
+    static const bool enabled=true;
+    template<class Node>
+    void operator()(Node *rt) const {
+        Monoid m;
+        value_type res=rt->left?m.combine(rt->left->aggregate,value_type(rt->data->second)):value_type(rt->data->second);
+        rt->aggregate=rt->right?m.combine(res,rt->right->aggregate):res;
+    }
+};
+
+/**
+ * an ordered map that answers aggregate(lo, hi), the combination of the mapped values
+ *   with keys in [lo, hi) in key order, in O(log n).
+ *
+ * Monoid has to provide
+ *   typedef ... value_type;  default constructible, every mapped value converts to it
+ *   value_type identity() const;
+ *   value_type combine(const value_type &a, const value_type &b) const;  associative
+ * combine need not be commutative, the values are always combined in key order.
+ *
+ * mapped values are only changed through insert, assign and erase, so that the aggregates stay valid:
+ *   there is no operator[] and the iterators are all const_iterator.
+ */
+template<
+	class Key,
+	class T,
+	class Monoid,
+	class Compare = std::less<Key>
+> class augmented_map : protected map<Key, T, Compare, monoid_augment<Monoid> > {
+private:
+    typedef map<Key, T, Compare, monoid_augment<Monoid> > base;
+    typedef typename base::AvlNode AvlNode;
+    typedef typename Monoid::value_type aggregate_type;
+
+    /**
+     * the aggregate of the keys not less than lo in the subtree rt
+     */
+    aggregate_type suffix(AvlNode *rt,const Key &lo) const{
+        Monoid m;
+        aggregate_type res=m.identity();
+        while (rt){
+            if (this->key_less(rt->data->first,lo))
+                rt=rt->right;
+            else{
+                aggregate_type cur(rt->data->second);
+                if (rt->right) cur=m.combine(cur,rt->right->aggregate);
+                res=m.combine(cur,res);
+                rt=rt->left;
+            }
+        }
+        return res;
+    }
+    /**
+     * the aggregate of the keys less than hi in the subtree rt
+     */
+    aggregate_type prefix(AvlNode *rt,const Key &hi) const{
+        Monoid m;
+        aggregate_type res=m.identity();
+        while (rt){
+            if (this->key_less(rt->data->first,hi)){
+                aggregate_type cur(rt->data->second);
+                if (rt->left) cur=m.combine(rt->left->aggregate,cur);
+                res=m.combine(res,cur);
+                rt=rt->right;
+            }else
+                rt=rt->left;
+        }
+        return res;
+    }
+
+public:
+    typedef typename base::value_type value_type;
+    typedef typename base::const_iterator const_iterator;
+
+	augmented_map() {}
+	explicit augmented_map(const Compare &comp):base(comp) {}
+	augmented_map(const augmented_map &other):base(other) {}
+	augmented_map & operator=(const augmented_map &other) {
+        base::operator=(other);
+        return *this;
+    }
+
+    using base::size;
+    using base::empty;
+    using base::clear;
+    using base::cbegin;
+    using base::cend;
+    using base::count;
+    using base::key_comp;
+	const_iterator begin() const {
+        return base::cbegin();
+    }
+	const_iterator end() const {
+        return base::cend();
+    }
+	const T & at(const Key &key) const {
+        return base::at(key);
+    }
+	const_iterator find(const Key &key) const {
+        return base::find(key);
+    }
+	const_iterator lower_bound(const Key &key) const {
+        return base::lower_bound(key);
+    }
+	const_iterator upper_bound(const Key &key) const {
+        return base::upper_bound(key);
+    }
+	/**
+	 * insert an element, see map::insert.
+	 */
+	pair<const_iterator, bool> insert(const value_type &value) {
+        pair<AvlNode*,bool> p=this->insert_node(value);
+        if (p.second) ++this->length;
+        return pair<const_iterator, bool>(const_iterator(this,p.first),p.second);
+    }
+	/**
+	 * set the mapped value of key to value, inserting it if key does not exist,
+	 *   and refresh the aggregates on the way to the root.
+	 * return true if a new element was inserted.
+	 */
+	bool assign(const Key &key, const T &value) {
+        AvlNode *pa,**pos=this->insert_pos(key,pa,typename base::three_way());
+        if (pos){
+            this->link_node(pa,pos,key,value);
+            ++this->length;
+            return true;
+        }
+        pa->data->second=value;
+        for (;pa->parent;pa=pa->parent) this->update_summary(pa);
+        return false;
+    }
+	/**
+	 * erase the element at pos, throw invalid_iterator if pos is end() or belongs to another map.
+	 */
+	void erase(const_iterator pos) {
+        this->erase_node(this->element_node(pos));
+        --this->length;
+    }
+	/**
+	 * erase the element with key, return the number of erased elements (0 or 1).
+	 */
+	size_t erase(const Key &key) {
+        AvlNode *p=this->find_node(key);
+        if (!p) return 0;
+        this->erase_node(p);
+        --this->length;
+        return 1;
+    }
+	/**
+	 * the combination of the mapped values with keys in [lo, hi) in key order,
+	 *   identity() if there is none.
+	 */
+	aggregate_type aggregate(const Key &lo, const Key &hi) const {
+        AvlNode *rt=this->end_node->left;
+        // the highest node in [lo, hi) splits the query into a suffix of its left subtree and a prefix of its right one
+        while (rt){
+            if (this->key_less(rt->data->first,lo))
+                rt=rt->right;
+            else if (!this->key_less(rt->data->first,hi))
+                rt=rt->left;
+            else
+                break;
+        }
+        if (!rt) return Monoid().identity();
+        Monoid m;
+        return m.combine(m.combine(suffix(rt->left,lo),aggregate_type(rt->data->second)),prefix(rt->right,hi));
+    }
+	/**
+	 * the combination of all mapped values in key order.
+	 */
+	aggregate_type aggregate() const {
+        AvlNode *rt=this->end_node->left;
+        return rt?rt->aggregate:Monoid().identity();
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,672 @@
+/**
+ * implement a container like std::map as a B+ tree
+ */
+#ifndef SJTU_BTREE_MAP_HPP
+#define SJTU_BTREE_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * an ordered map with the interface and the exceptions of sjtu::map, stored as a B+ tree.
+ * a node spans a few cache lines: an inner node keeps its separator keys contiguous,
+ *   a leaf keeps its elements in key order and is linked to its neighbours for iteration.
+ * a lookup visits about log_B(n) nodes instead of log_2(n), and there is no allocation per element.
+ *
+ * unlike sjtu::map, insert and erase move elements between nodes,
+ *   so they invalidate every iterator and reference into the map.
+ */
+template<
+	class Key,
+	class T,
+	class Compare = std::less<Key>
+> class btree_map : private functor_holder<Compare, 0> {
+public:
+	typedef pair<const Key, T> value_type;
+
+private:
+    static const size_t node_bytes=256;
+    static const size_t leaf_slots=node_bytes/sizeof(value_type)>8?node_bytes/sizeof(value_type):8;
+    static const size_t inner_slots=node_bytes/sizeof(Key)>8?node_bytes/sizeof(Key):8;
+    // a node other than the root below these is refilled from a sibling or merged into one
+    static const size_t leaf_min=leaf_slots/2;
+    static const size_t inner_min=inner_slots/2;
+    static const size_t max_depth=64;
+
+    struct Node{
+        bool leaf;
+        size_t count;
+        explicit Node(bool l):leaf(l),count(0){}
+    };
+    /**
+     * count elements in slots()[0, count), in key order
+     */
+    struct LeafNode:Node{
+        LeafNode *prev;
+        LeafNode *next;
+        typename std::aligned_storage<sizeof(value_type),alignof(value_type)>::type storage[leaf_slots];
+        LeafNode():Node(true),prev(nullptr),next(nullptr){}
+        value_type *slots(){return reinterpret_cast<value_type *>(storage);}
+    };
+    /**
+     * count separators in keys()[0, count) and count + 1 children,
+     * child[i] holds the keys in [keys()[i - 1], keys()[i])
+     */
+    struct InnerNode:Node{
+        typename std::aligned_storage<sizeof(Key),alignof(Key)>::type storage[inner_slots];
+        Node *child[inner_slots+1];
+        InnerNode():Node(false){}
+        Key *keys(){return reinterpret_cast<Key *>(storage);}
+    };
+    /**
+     * the inner nodes on the way from the root to a leaf and the child taken in each
+     */
+    struct Path{
+        InnerNode *node[max_depth];
+        size_t index[max_depth];
+        size_t depth;
+    };
+
+    Node *root;
+    LeafNode *head;
+    LeafNode *tail;
+    size_t length;
+
+    static LeafNode *as_leaf(Node *p){return static_cast<LeafNode *>(p);}
+    static InnerNode *as_inner(Node *p){return static_cast<InnerNode *>(p);}
+    /**
+     * the comparator of this map, it takes no space if it is empty
+     */
+    inline const Compare &compare() const {return functor_holder<Compare, 0>::get();}
+    inline bool key_less(const Key &x,const Key &y) const {return compare()(x,y);}
+
+    /**
+     * move *src into the raw memory dst, leaving src raw
+     */
+    template<class U>
+    static void relocate(U *dst,U *src){
+        new(dst) U(std::move(*src));
+        src->~U();
+    }
+    /**
+     * keys are only ever copy or move constructed, never assigned
+     */
+    static void replace_key(Key *dst,const Key &src){
+        dst->~Key();
+        new(dst) Key(src);
+    }
+    /**
+     * make a[pos] raw by moving a[pos, count) one step to the right
+     */
+    template<class U>
+    static void open_gap(U *a,size_t count,size_t pos){
+        for (size_t j=count;j>pos;--j) relocate(a+j,a+j-1);
+    }
+    /**
+     * fill the raw a[pos] by moving a[pos + 1, count) one step to the left
+     */
+    template<class U>
+    static void close_gap(U *a,size_t count,size_t pos){
+        for (size_t j=pos;j+1<count;++j) relocate(a+j,a+j+1);
+    }
+
+    /**
+     * the first index in p whose key is not less than x
+     */
+    size_t leaf_lower(LeafNode *p,const Key &x) const{
+        value_type *s=p->slots();
+        size_t l=0,n=p->count;
+        while (n>0){
+            size_t half=n>>1;
+            if (key_less(s[l+half].first,x)){
+                l+=half+1;
+                n-=half+1;
+            }else
+                n=half;
+        }
+        return l;
+    }
+    /**
+     * the child of p that holds x: the number of separators not greater than x
+     */
+    size_t inner_upper(InnerNode *p,const Key &x) const{
+        Key *k=p->keys();
+        size_t l=0,n=p->count;
+        while (n>0){
+            size_t half=n>>1;
+            if (!key_less(x,k[l+half])){
+                l+=half+1;
+                n-=half+1;
+            }else
+                n=half;
+        }
+        return l;
+    }
+    LeafNode *descend(const Key &x,Path *path) const{
+        Node *p=root;
+        if (path) path->depth=0;
+        while (!p->leaf){
+            InnerNode *q=as_inner(p);
+            size_t i=inner_upper(q,x);
+            if (path){
+                path->node[path->depth]=q;
+                path->index[path->depth]=i;
+                ++path->depth;
+            }
+            p=q->child[i];
+        }
+        return as_leaf(p);
+    }
+    /**
+     * the leaf and the index of the element with key x, or false
+     */
+    bool find_slot(const Key &x,LeafNode *&p,size_t &i) const{
+        p=descend(x,nullptr);
+        i=leaf_lower(p,x);
+        return i<p->count&&!key_less(x,p->slots()[i].first);
+    }
+
+    Node *clone(Node *other,LeafNode *&last){
+        if (other->leaf){
+            LeafNode *p=new LeafNode,*o=as_leaf(other);
+            for (size_t i=0;i<o->count;++i) new(p->slots()+i) value_type(o->slots()[i]);
+            p->count=o->count;
+            p->prev=last;
+            if (last) last->next=p; else head=p;
+            last=p;
+            return p;
+        }
+        InnerNode *p=new InnerNode,*o=as_inner(other);
+        for (size_t i=0;i<o->count;++i) new(p->keys()+i) Key(o->keys()[i]);
+        for (size_t i=0;i<=o->count;++i) p->child[i]=clone(o->child[i],last);
+        p->count=o->count;
+        return p;
+    }
+    void copy(const btree_map &other){
+        LeafNode *last=nullptr;
+        head=nullptr;
+        root=clone(other.root,last);
+        tail=last;
+        length=other.length;
+    }
+    void destroy(Node *p){
+        if (p->leaf){
+            LeafNode *q=as_leaf(p);
+            for (size_t i=0;i<q->count;++i) q->slots()[i].~value_type();
+            delete q;
+            return;
+        }
+        InnerNode *q=as_inner(p);
+        for (size_t i=0;i<q->count;++i) q->keys()[i].~Key();
+        for (size_t i=0;i<=q->count;++i) destroy(q->child[i]);
+        delete q;
+    }
+    void init(){
+        root=head=tail=new LeafNode;
+        length=0;
+    }
+
+    /**
+     * a child at level d of the path has been split: put sep and the new right half after it in its parent,
+     * splitting the parents as far as needed
+     */
+    void insert_up(Path &path,size_t d,const Key &sep,Node *right){
+        if (d==0){
+            InnerNode *r=new InnerNode;
+            new(r->keys()) Key(sep);
+            r->child[0]=root;
+            r->child[1]=right;
+            r->count=1;
+            root=r;
+            return;
+        }
+        InnerNode *u=path.node[d-1];
+        size_t i=path.index[d-1];
+        if (u->count<inner_slots){
+            insert_inner(u,i,sep,right);
+            return;
+        }
+        // the middle separator moves up, the ones after it go to a new sibling
+        size_t mid=inner_slots/2;
+        InnerNode *v=new InnerNode;
+        for (size_t j=mid+1;j<inner_slots;++j) relocate(v->keys()+(j-mid-1),u->keys()+j);
+        for (size_t j=mid+1;j<=inner_slots;++j) v->child[j-mid-1]=u->child[j];
+        v->count=inner_slots-mid-1;
+        Key up(std::move(u->keys()[mid]));
+        u->keys()[mid].~Key();
+        u->count=mid;
+        if (i<=mid) insert_inner(u,i,sep,right);
+        else insert_inner(v,i-mid-1,sep,right);
+        insert_up(path,d-1,up,v);
+    }
+    /**
+     * put sep at keys()[i] and right at child[i + 1] of a non-full u
+     */
+    void insert_inner(InnerNode *u,size_t i,const Key &sep,Node *right){
+        open_gap(u->keys(),u->count,i);
+        new(u->keys()+i) Key(sep);
+        open_gap(u->child,u->count+1,i+1);
+        u->child[i+1]=right;
+        ++u->count;
+    }
+    /**
+     * drop keys()[i] and child[i + 1] of u
+     */
+    void erase_inner(InnerNode *u,size_t i){
+        u->keys()[i].~Key();
+        close_gap(u->keys(),u->count,i);
+        close_gap(u->child,u->count+1,i+1);
+        --u->count;
+    }
+    /**
+     * insert value at index i of the leaf p at the end of path, p splits in halves if it is full
+     */
+    pair<LeafNode*,size_t> insert_leaf(Path &path,LeafNode *p,size_t i,const value_type &value){
+        if (p->count==leaf_slots){
+            size_t mid=leaf_slots/2;
+            LeafNode *q=new LeafNode;
+            for (size_t j=mid;j<leaf_slots;++j) relocate(q->slots()+(j-mid),p->slots()+j);
+            q->count=leaf_slots-mid;
+            p->count=mid;
+            q->next=p->next;
+            q->prev=p;
+            if (p->next) p->next->prev=q; else tail=q;
+            p->next=q;
+            if (i>mid){
+                i-=mid;
+                p=q;
+                open_gap(p->slots(),p->count,i);
+                new(p->slots()+i) value_type(value);
+                ++p->count;
+                insert_up(path,path.depth,q->slots()[0].first,q);
+                return pair<LeafNode*,size_t>(p,i);
+            }
+            insert_up(path,path.depth,q->slots()[0].first,q);
+        }
+        open_gap(p->slots(),p->count,i);
+        new(p->slots()+i) value_type(value);
+        ++p->count;
+        return pair<LeafNode*,size_t>(p,i);
+    }
+    /**
+     * the leaf p at the end of path has lost an element,
+     * refill it from a sibling or merge it with one if it is too small
+     */
+    void fix_leaf(Path &path,LeafNode *p){
+        if (path.depth==0||p->count>=leaf_min) return;
+        InnerNode *u=path.node[path.depth-1];
+        size_t i=path.index[path.depth-1];
+        if (i>0){
+            LeafNode *l=as_leaf(u->child[i-1]);
+            if (l->count>leaf_min){
+                open_gap(p->slots(),p->count,0);
+                relocate(p->slots(),l->slots()+(l->count-1));
+                ++p->count;
+                --l->count;
+                replace_key(u->keys()+(i-1),p->slots()[0].first);
+                return;
+            }
+            merge_leaves(l,p);
+            erase_inner(u,i-1);
+        }else{
+            LeafNode *r=as_leaf(u->child[1]);
+            if (r->count>leaf_min){
+                relocate(p->slots()+p->count,r->slots());
+                close_gap(r->slots(),r->count,0);
+                ++p->count;
+                --r->count;
+                replace_key(u->keys(),r->slots()[0].first);
+                return;
+            }
+            merge_leaves(p,r);
+            erase_inner(u,0);
+        }
+        fix_inner(path,path.depth-1);
+    }
+    void merge_leaves(LeafNode *l,LeafNode *r){
+        for (size_t j=0;j<r->count;++j) relocate(l->slots()+(l->count+j),r->slots()+j);
+        l->count+=r->count;
+        l->next=r->next;
+        if (r->next) r->next->prev=l; else tail=l;
+        delete r;
+    }
+    /**
+     * the inner node at level d of path has lost a separator,
+     * rotate one in through the parent or merge it with a sibling if it is too small
+     */
+    void fix_inner(Path &path,size_t d){
+        InnerNode *u=path.node[d];
+        if (d==0){
+            if (u->count==0){
+                root=u->child[0];
+                delete u;
+            }
+            return;
+        }
+        if (u->count>=inner_min) return;
+        InnerNode *pa=path.node[d-1];
+        size_t i=path.index[d-1];
+        if (i>0){
+            InnerNode *l=as_inner(pa->child[i-1]);
+            if (l->count>inner_min){
+                open_gap(u->keys(),u->count,0);
+                new(u->keys()) Key(std::move(pa->keys()[i-1]));
+                open_gap(u->child,u->count+1,0);
+                u->child[0]=l->child[l->count];
+                pa->keys()[i-1].~Key();
+                relocate(pa->keys()+(i-1),l->keys()+(l->count-1));
+                --l->count;
+                ++u->count;
+                return;
+            }
+            merge_inner(l,pa->keys()[i-1],u);
+            erase_inner(pa,i-1);
+        }else{
+            InnerNode *r=as_inner(pa->child[1]);
+            if (r->count>inner_min){
+                new(u->keys()+u->count) Key(std::move(pa->keys()[0]));
+                u->child[u->count+1]=r->child[0];
+                ++u->count;
+                pa->keys()[0].~Key();
+                relocate(pa->keys(),r->keys());
+                close_gap(r->keys(),r->count,0);
+                close_gap(r->child,r->count+1,0);
+                --r->count;
+                return;
+            }
+            merge_inner(u,pa->keys()[0],r);
+            erase_inner(pa,0);
+        }
+        fix_inner(path,d-1);
+    }
+    void merge_inner(InnerNode *l,const Key &sep,InnerNode *r){
+        new(l->keys()+l->count) Key(sep);
+        for (size_t j=0;j<r->count;++j) relocate(l->keys()+(l->count+1+j),r->keys()+j);
+        for (size_t j=0;j<=r->count;++j) l->child[l->count+1+j]=r->child[j];
+        l->count+=r->count+1;
+        delete r;
+    }
+
+public:
+	class const_iterator;
+	class iterator {
+        friend class btree_map;
+	private:
+        btree_map *map_ptr;
+        LeafNode *leaf;
+        size_t index;
+	public:
+		iterator():map_ptr(nullptr),leaf(nullptr),index(0) {}
+		iterator(const iterator &other):map_ptr(other.map_ptr),leaf(other.leaf),index(other.index) {}
+        iterator(btree_map *_map_ptr,LeafNode *_leaf,size_t _index):map_ptr(_map_ptr),leaf(_leaf),index(_index) {}
+		/**
+		 * iter++
+		 */
+		iterator operator++(int) {
+            iterator tmp=*this;
+            ++*this;
+            return tmp;
+        }
+		/**
+		 * ++iter, the end is one past the last element of the last leaf
+		 */
+		iterator & operator++() {
+            if (!leaf||index==leaf->count) throw invalid_iterator();
+            if (++index==leaf->count&&leaf->next){
+                leaf=leaf->next;
+                index=0;
+            }
+            return *this;
+        }
+		/**
+		 * iter--
+		 */
+		iterator operator--(int) {
+            iterator tmp=*this;
+            --*this;
+            return tmp;
+        }
+		/**
+		 * --iter
+		 */
+		iterator & operator--() {
+            if (!leaf||(index==0&&!leaf->prev)) throw invalid_iterator();
+            if (index==0){
+                leaf=leaf->prev;
+                index=leaf->count;
+            }
+            --index;
+            return *this;
+        }
+		value_type & operator*() const {
+            if (!leaf||index==leaf->count) throw invalid_iterator();
+            return leaf->slots()[index];
+        }
+		bool operator==(const iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&leaf==rhs.leaf&&index==rhs.index;
+        }
+		bool operator==(const const_iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&leaf==rhs.leaf&&index==rhs.index;
+        }
+		bool operator!=(const iterator &rhs) const {
+            return !(*this==rhs);
+        }
+		bool operator!=(const const_iterator &rhs) const {
+            return !(*this==rhs);
+        }
+		value_type* operator->() const noexcept {
+            return leaf->slots()+index;
+        }
+	};
+	class const_iterator {
+    friend class btree_map;
+    private:
+        const btree_map *map_ptr;
+        LeafNode *leaf;
+        size_t index;
+    public:
+        const_iterator():map_ptr(nullptr),leaf(nullptr),index(0) {}
+        const_iterator(const const_iterator &other):map_ptr(other.map_ptr),leaf(other.leaf),index(other.index) {}
+        const_iterator(const iterator &other):map_ptr(other.map_ptr),leaf(other.leaf),index(other.index) {}
+        const_iterator(const btree_map *_map_ptr,LeafNode *_leaf,size_t _index):map_ptr(_map_ptr),leaf(_leaf),index(_index) {}
+        const_iterator operator++(int) {
+            const_iterator tmp=*this;
+            ++*this;
+            return tmp;
+        }
+        const_iterator & operator++() {
+            if (!leaf||index==leaf->count) throw invalid_iterator();
+            if (++index==leaf->count&&leaf->next){
+                leaf=leaf->next;
+                index=0;
+            }
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator tmp=*this;
+            --*this;
+            return tmp;
+        }
+        const_iterator & operator--() {
+            if (!leaf||(index==0&&!leaf->prev)) throw invalid_iterator();
+            if (index==0){
+                leaf=leaf->prev;
+                index=leaf->count;
+            }
+            --index;
+            return *this;
+        }
+        const value_type & operator*() const {
+            if (!leaf||index==leaf->count) throw invalid_iterator();
+            return leaf->slots()[index];
+        }
+        bool operator==(const iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&leaf==rhs.leaf&&index==rhs.index;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&leaf==rhs.leaf&&index==rhs.index;
+        }
+        bool operator!=(const iterator &rhs) const {
+            return !(*this==rhs);
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this==rhs);
+        }
+        const value_type* operator->() const noexcept {
+            return leaf->slots()+index;
+        }
+	};
+
+	btree_map() {
+        init();
+    }
+	/**
+	 * an empty map ordered by comp, which is copied into the map and used for every comparison.
+	 */
+	explicit btree_map(const Compare &comp):functor_holder<Compare, 0>(comp) {
+        init();
+    }
+	btree_map(const btree_map &other):functor_holder<Compare, 0>(other) {
+        copy(other);
+    }
+	btree_map & operator=(const btree_map &other) {
+        if (this==&other) return *this;
+        destroy(root);
+        functor_holder<Compare, 0>::operator=(other);
+        copy(other);
+        return *this;
+    }
+	~btree_map() {
+        destroy(root);
+    }
+	/**
+	 * access specified element with bounds checking,
+	 *   throw index_out_of_bound if no such element exists.
+	 */
+	T & at(const Key &key) {
+        LeafNode *p;
+        size_t i;
+        if (!find_slot(key,p,i)) throw index_out_of_bound();
+        return p->slots()[i].second;
+    }
+	const T & at(const Key &key) const {
+        LeafNode *p;
+        size_t i;
+        if (!find_slot(key,p,i)) throw index_out_of_bound();
+        return p->slots()[i].second;
+    }
+	/**
+	 * access specified element, performing an insertion if such key does not already exist.
+	 */
+	T & operator[](const Key &key) {
+        Path path;
+        LeafNode *p=descend(key,&path);
+        size_t i=leaf_lower(p,key);
+        if (i<p->count&&!key_less(key,p->slots()[i].first)) return p->slots()[i].second;
+        pair<LeafNode*,size_t> pos=insert_leaf(path,p,i,value_type(key,T()));
+        ++length;
+        return pos.first->slots()[pos.second].second;
+    }
+	/**
+	 * behave like at() throw index_out_of_bound if such key does not exist.
+	 */
+	const T & operator[](const Key &key) const {
+        return at(key);
+    }
+	iterator begin() {
+        return iterator(this,head,0);
+    }
+	const_iterator cbegin() const {
+        return const_iterator(this,head,0);
+    }
+	iterator end() {
+        return iterator(this,tail,tail->count);
+    }
+	const_iterator cend() const {
+        return const_iterator(this,tail,tail->count);
+    }
+	bool empty() const {
+        return length==0;
+    }
+	size_t size() const {
+        return length;
+    }
+	/**
+	 * returns a copy of the comparator that orders the keys.
+	 */
+	Compare key_comp() const {
+        return compare();
+    }
+	void clear() {
+        destroy(root);
+        init();
+    }
+	/**
+	 * insert an element.
+	 * return a pair, the first of the pair is
+	 *   the iterator to the new element (or the element that prevented the insertion),
+	 *   the second one is true if insert successfully, or false.
+	 */
+	pair<iterator, bool> insert(const value_type &value) {
+        Path path;
+        LeafNode *p=descend(value.first,&path);
+        size_t i=leaf_lower(p,value.first);
+        if (i<p->count&&!key_less(value.first,p->slots()[i].first))
+            return pair<iterator, bool>(iterator(this,p,i),false);
+        pair<LeafNode*,size_t> pos=insert_leaf(path,p,i,value);
+        ++length;
+        return pair<iterator, bool>(iterator(this,pos.first,pos.second),true);
+    }
+	/**
+	 * erase the element at pos.
+	 *
+	 * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
+	 */
+	void erase(iterator pos) {
+        if (pos.map_ptr!=this||!pos.leaf||pos.index>=pos.leaf->count) throw invalid_iterator();
+        Path path;
+        LeafNode *p=descend(pos->first,&path);
+        size_t i=pos.index;
+        p->slots()[i].~value_type();
+        close_gap(p->slots(),p->count,i);
+        --p->count;
+        --length;
+        fix_leaf(path,p);
+    }
+	/**
+	 * Returns the number of elements with key that compares equivalent to the specified argument,
+	 *   which is either 1 or 0 since this container does not allow duplicates.
+	 */
+	size_t count(const Key &key) const {
+        LeafNode *p;
+        size_t i;
+        return find_slot(key,p,i)?1:0;
+    }
+	/**
+	 * Finds an element with key equivalent to key, past-the-end (see end()) iterator if there is none.
+	 */
+	iterator find(const Key &key) {
+        LeafNode *p;
+        size_t i;
+        if (find_slot(key,p,i)) return iterator(this,p,i);
+        return end();
+    }
+	const_iterator find(const Key &key) const {
+        LeafNode *p;
+        size_t i;
+        if (find_slot(key,p,i)) return const_iterator(this,p,i);
+        return cend();
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,583 @@
+/**
+ * implement a container like std::map as an AVL tree in an arena with 32-bit links
+ */
+#ifndef SJTU_COMPACT_MAP_HPP
+#define SJTU_COMPACT_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * an ordered map with the interface and the exceptions of sjtu::map, built for small entries.
+ * the nodes live in one growing array and link to each other by 32-bit index,
+ *   the height takes one byte and the element is stored in the node,
+ *   so an int -> int entry takes 24 bytes and there is no allocation per element.
+ * erased nodes are kept on a free list for the next insertions, clear() resets the whole arena.
+ *
+ * the iterators hold indices and stay valid like those of sjtu::map,
+ *   but references to elements are invalidated whenever an insertion grows the arena.
+ */
+template<
+	class Key,
+	class T,
+	class Compare = std::less<Key>
+> class compact_map : private functor_holder<Compare, 0> {
+public:
+	typedef pair<const Key, T> value_type;
+
+private:
+    typedef uint32_t index_t;
+    /**
+     * slot 0 is the header: the root hangs on its left, and 0 as a link means no node.
+     * a slot whose height is 0 holds no element, on the free list its left links to the next free slot
+     */
+    struct Node{
+        typename std::aligned_storage<sizeof(value_type),alignof(value_type)>::type storage;
+        index_t left;
+        index_t right;
+        index_t parent;
+        uint8_t height;
+        value_type &value(){return *reinterpret_cast<value_type *>(&storage);}
+    };
+    static const index_t header=0;
+    static const index_t max_nodes=UINT32_MAX;
+
+    Node *pool;
+    // slots [0, used) have been handed out, free_list chains the erased ones
+    index_t capacity;
+    index_t used;
+    index_t free_list;
+    size_t length;
+
+    inline Node &node(index_t i) const {return pool[i];}
+    inline const Key &key(index_t i) const {return pool[i].value().first;}
+    inline size_t height(index_t i) const {return i?pool[i].height:0;}
+    /**
+     * the comparator of this map, it takes no space if it is empty
+     */
+    inline const Compare &compare() const {return functor_holder<Compare, 0>::get();}
+    inline bool key_less(const Key &a,const Key &b) const {return compare()(a,b);}
+    /**
+     * the link in the parent of rt that points to rt, the root hangs on the header
+     */
+    inline index_t &link(index_t rt) const {
+        Node &pa=node(node(rt).parent);
+        return pa.left==rt?pa.left:pa.right;
+    }
+    inline void update(index_t rt) const {
+        size_t hl=height(node(rt).left),hr=height(node(rt).right);
+        node(rt).height=(uint8_t)((hl>hr?hl:hr)+1);
+    }
+
+    void init(index_t cap){
+        capacity=cap;
+        pool=(Node *) malloc(sizeof(Node)*capacity);
+        if (!pool) throw std::bad_alloc();
+        used=1;
+        free_list=0;
+        length=0;
+        node(header).left=node(header).right=node(header).parent=0;
+        node(header).height=0;
+    }
+    void destroy_values(){
+        if (std::is_trivially_destructible<value_type>::value) return;
+        for (index_t i=1;i<used;++i)
+            if (node(i).height) node(i).value().~value_type();
+    }
+    /**
+     * move the slots into an array twice as large, the indices stay the same.
+     * value goes to the first unused slot before the old array is released, it may live in there
+     */
+    void grow(const value_type &value){
+        if (capacity==max_nodes) throw runtime_error();
+        index_t cap=capacity>max_nodes/2?max_nodes:capacity*2;
+        Node *fresh=(Node *) malloc(sizeof(Node)*cap);
+        if (!fresh) throw std::bad_alloc();
+        try{
+            new(&fresh[used].value()) value_type(value);
+        }catch (...){
+            free(fresh);
+            throw;
+        }
+        index_t i=0;
+        try{
+            for (;i<used;++i){
+                fresh[i].left=pool[i].left;
+                fresh[i].right=pool[i].right;
+                fresh[i].parent=pool[i].parent;
+                fresh[i].height=pool[i].height;
+                if (i&&pool[i].height) new(&fresh[i].value()) value_type(std::move_if_noexcept(pool[i].value()));
+            }
+        }catch (...){
+            // only a copying relocation throws, the old slots are still intact
+            fresh[used].value().~value_type();
+            while (i-->1)
+                if (fresh[i].height) fresh[i].value().~value_type();
+            free(fresh);
+            throw;
+        }
+        destroy_values();
+        free(pool);
+        pool=fresh;
+        capacity=cap;
+    }
+    index_t new_node(const value_type &value,index_t pa){
+        index_t i;
+        if (free_list){
+            i=free_list;
+            new(&node(i).value()) value_type(value);
+            free_list=node(i).left;
+        }else{
+            if (used==capacity) grow(value);
+            else new(&node(used).value()) value_type(value);
+            i=used++;
+        }
+        Node &p=node(i);
+        p.left=p.right=0;
+        p.parent=pa;
+        p.height=1;
+        return i;
+    }
+    void free_node(index_t i){
+        node(i).value().~value_type();
+        node(i).height=0;
+        node(i).left=free_list;
+        free_list=i;
+    }
+
+    index_t find_node(const Key &x) const{
+        index_t p=node(header).left;
+        while (p){
+            if (key_less(x,key(p))) p=node(p).left;
+            else if (key_less(key(p),x)) p=node(p).right;
+            else return p;
+        }
+        return 0;
+    }
+    /**
+     * the first node whose key is not less than x (greater than x if strict), header if there is none
+     */
+    index_t bound_node(const Key &x,bool strict) const{
+        index_t p=node(header).left,res=header;
+        while (p){
+            if (strict?key_less(x,key(p)):!key_less(key(p),x)){
+                res=p;
+                p=node(p).left;
+            }else
+                p=node(p).right;
+        }
+        return res;
+    }
+    index_t first_node() const{
+        index_t p=header;
+        while (node(p).left) p=node(p).left;
+        return p;
+    }
+    /**
+     * the neighbours in key order, the header comes after the last node and before the first
+     */
+    index_t next_node(index_t p) const{
+        if (node(p).right){
+            p=node(p).right;
+            while (node(p).left) p=node(p).left;
+            return p;
+        }
+        index_t pa=node(p).parent;
+        while (pa!=header&&node(pa).right==p){
+            p=pa;
+            pa=node(p).parent;
+        }
+        return pa;
+    }
+    index_t prev_node(index_t p) const{
+        if (p==header||node(p).left){
+            p=node(p).left;
+            while (node(p).right) p=node(p).right;
+            return p;
+        }
+        index_t pa=node(p).parent;
+        while (pa!=header&&node(pa).left==p){
+            p=pa;
+            pa=node(p).parent;
+        }
+        return pa;
+    }
+
+    index_t LL(index_t rt){
+        index_t rt1=node(rt).left;
+        link(rt)=rt1;
+        node(rt1).parent=node(rt).parent;
+        node(rt).left=node(rt1).right;
+        if (node(rt1).right) node(node(rt1).right).parent=rt;
+        node(rt1).right=rt;
+        node(rt).parent=rt1;
+        update(rt);
+        update(rt1);
+        return rt1;
+    }
+    index_t RR(index_t rt){
+        index_t rt1=node(rt).right;
+        link(rt)=rt1;
+        node(rt1).parent=node(rt).parent;
+        node(rt).right=node(rt1).left;
+        if (node(rt1).left) node(node(rt1).left).parent=rt;
+        node(rt1).left=rt;
+        node(rt).parent=rt1;
+        update(rt);
+        update(rt1);
+        return rt1;
+    }
+    index_t balance(index_t rt){
+        size_t hl=height(node(rt).left),hr=height(node(rt).right);
+        if (hl==hr+2){
+            index_t l=node(rt).left;
+            if (height(node(l).left)<height(node(l).right)) RR(l);
+            return LL(rt);
+        }
+        if (hr==hl+2){
+            index_t r=node(rt).right;
+            if (height(node(r).right)<height(node(r).left)) LL(r);
+            return RR(rt);
+        }
+        update(rt);
+        return rt;
+    }
+    /**
+     * walk up from rt and rebalance until a subtree keeps its old height
+     */
+    void rebalance(index_t rt){
+        while (rt!=header){
+            size_t old_height=node(rt).height;
+            rt=balance(rt);
+            if (node(rt).height==old_height) break;
+            rt=node(rt).parent;
+        }
+    }
+    pair<index_t,bool> insert_node(const value_type &value){
+        index_t pa=header,p=node(header).left;
+        bool left=true;
+        while (p){
+            pa=p;
+            if (key_less(value.first,key(p))) p=node(p).left,left=true;
+            else if (key_less(key(p),value.first)) p=node(p).right,left=false;
+            else return pair<index_t,bool>(p,false);
+        }
+        // the arena may move here, but the indices found above stay valid
+        index_t cur=new_node(value,pa);
+        (left?node(pa).left:node(pa).right)=cur;
+        ++length;
+        rebalance(pa);
+        return pair<index_t,bool>(cur,true);
+    }
+    /**
+     * exchange the places of rt and its in-order successor nd in the tree, the elements stay in their slots
+     */
+    void swap_successor(index_t rt,index_t nd){
+        index_t nd_parent=node(nd).parent,nd_right=node(nd).right;
+        link(rt)=nd;
+        node(nd).parent=node(rt).parent;
+        node(nd).left=node(rt).left;
+        node(node(nd).left).parent=nd;
+        if (nd_parent==rt){
+            node(nd).right=rt;
+            node(rt).parent=nd;
+        }else{
+            node(nd).right=node(rt).right;
+            node(node(nd).right).parent=nd;
+            node(nd_parent).left=rt;
+            node(rt).parent=nd_parent;
+        }
+        node(rt).left=0;
+        node(rt).right=nd_right;
+        if (nd_right) node(nd_right).parent=rt;
+        uint8_t tmp=node(rt).height;
+        node(rt).height=node(nd).height;
+        node(nd).height=tmp;
+    }
+    void erase_node(index_t rt){
+        if (node(rt).left&&node(rt).right) swap_successor(rt,next_node(rt));
+        index_t pa=node(rt).parent,child=node(rt).left?node(rt).left:node(rt).right;
+        link(rt)=child;
+        if (child) node(child).parent=pa;
+        free_node(rt);
+        --length;
+        rebalance(pa);
+    }
+    void copy(const compact_map &other){
+        init(other.capacity);
+        for (index_t i=0;i<other.used;++i){
+            Node &p=other.node(i);
+            pool[i].left=p.left;
+            pool[i].right=p.right;
+            pool[i].parent=p.parent;
+            pool[i].height=p.height;
+            if (i&&p.height){
+                try{
+                    new(&pool[i].value()) value_type(p.value());
+                }catch (...){
+                    used=i;
+                    destroy_values();
+                    free(pool);
+                    throw;
+                }
+            }
+        }
+        used=other.used;
+        free_list=other.free_list;
+        length=other.length;
+    }
+    /**
+     * exchange the arenas of two maps, the comparators stay where they are
+     */
+    void swap_arena(compact_map &other){
+        std::swap(pool,other.pool);
+        std::swap(capacity,other.capacity);
+        std::swap(used,other.used);
+        std::swap(free_list,other.free_list);
+        std::swap(length,other.length);
+    }
+
+public:
+	class const_iterator;
+	class iterator {
+        friend class compact_map;
+	private:
+        compact_map *map_ptr;
+        index_t cur;
+	public:
+		iterator():map_ptr(nullptr),cur(0) {}
+		iterator(const iterator &other):map_ptr(other.map_ptr),cur(other.cur) {}
+        iterator(compact_map *_map_ptr,index_t _cur):map_ptr(_map_ptr),cur(_cur) {}
+		iterator operator++(int) {
+            iterator tmp=*this;
+            ++*this;
+            return tmp;
+        }
+		iterator & operator++() {
+            if (!map_ptr||cur==header) throw invalid_iterator();
+            cur=map_ptr->next_node(cur);
+            return *this;
+        }
+		iterator operator--(int) {
+            iterator tmp=*this;
+            --*this;
+            return tmp;
+        }
+		iterator & operator--() {
+            if (!map_ptr) throw invalid_iterator();
+            index_t p=map_ptr->prev_node(cur);
+            if (p==header) throw invalid_iterator();
+            cur=p;
+            return *this;
+        }
+		value_type & operator*() const {
+            if (!map_ptr||cur==header) throw invalid_iterator();
+            return map_ptr->node(cur).value();
+        }
+		bool operator==(const iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&cur==rhs.cur;
+        }
+		bool operator==(const const_iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&cur==rhs.cur;
+        }
+		bool operator!=(const iterator &rhs) const {
+            return !(*this==rhs);
+        }
+		bool operator!=(const const_iterator &rhs) const {
+            return !(*this==rhs);
+        }
+		value_type* operator->() const noexcept {
+            return &map_ptr->node(cur).value();
+        }
+	};
+	class const_iterator {
+    friend class compact_map;
+    private:
+        const compact_map *map_ptr;
+        index_t cur;
+    public:
+        const_iterator():map_ptr(nullptr),cur(0) {}
+        const_iterator(const const_iterator &other):map_ptr(other.map_ptr),cur(other.cur) {}
+        const_iterator(const iterator &other):map_ptr(other.map_ptr),cur(other.cur) {}
+        const_iterator(const compact_map *_map_ptr,index_t _cur):map_ptr(_map_ptr),cur(_cur) {}
+        const_iterator operator++(int) {
+            const_iterator tmp=*this;
+            ++*this;
+            return tmp;
+        }
+        const_iterator & operator++() {
+            if (!map_ptr||cur==header) throw invalid_iterator();
+            cur=map_ptr->next_node(cur);
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator tmp=*this;
+            --*this;
+            return tmp;
+        }
+        const_iterator & operator--() {
+            if (!map_ptr) throw invalid_iterator();
+            index_t p=map_ptr->prev_node(cur);
+            if (p==header) throw invalid_iterator();
+            cur=p;
+            return *this;
+        }
+        const value_type & operator*() const {
+            if (!map_ptr||cur==header) throw invalid_iterator();
+            return map_ptr->node(cur).value();
+        }
+        bool operator==(const iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&cur==rhs.cur;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&cur==rhs.cur;
+        }
+        bool operator!=(const iterator &rhs) const {
+            return !(*this==rhs);
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this==rhs);
+        }
+        const value_type* operator->() const noexcept {
+            return &map_ptr->node(cur).value();
+        }
+	};
+
+	compact_map() {
+        init(16);
+    }
+	/**
+	 * an empty map ordered by comp, which is copied into the map and used for every comparison.
+	 */
+	explicit compact_map(const Compare &comp):functor_holder<Compare, 0>(comp) {
+        init(16);
+    }
+	compact_map(const compact_map &other):functor_holder<Compare, 0>(other) {
+        copy(other);
+    }
+	compact_map & operator=(const compact_map &other) {
+        if (this==&other) return *this;
+        // copy into a map of its own first, so a throwing copy leaves this one as it was
+        compact_map tmp(other);
+        swap_arena(tmp);
+        functor_holder<Compare, 0>::operator=(other);
+        return *this;
+    }
+	~compact_map() {
+        destroy_values();
+        free(pool);
+    }
+	/**
+	 * access specified element with bounds checking, throw index_out_of_bound if key is not found.
+	 */
+	T & at(const Key &key) {
+        index_t p=find_node(key);
+        if (!p) throw index_out_of_bound();
+        return node(p).value().second;
+    }
+	const T & at(const Key &key) const {
+        index_t p=find_node(key);
+        if (!p) throw index_out_of_bound();
+        return node(p).value().second;
+    }
+	/**
+	 * access specified element, inserting a default constructed value if key does not exist.
+	 */
+	T & operator[](const Key &key) {
+        index_t p=find_node(key);
+        if (!p) p=insert_node(value_type(key,T())).first;
+        return node(p).value().second;
+    }
+	const T & operator[](const Key &key) const {
+        return at(key);
+    }
+	iterator begin() {
+        return iterator(this,first_node());
+    }
+	const_iterator cbegin() const {
+        return const_iterator(this,first_node());
+    }
+	iterator end() {
+        return iterator(this,header);
+    }
+	const_iterator cend() const {
+        return const_iterator(this,header);
+    }
+	bool empty() const {
+        return !length;
+    }
+	size_t size() const {
+        return length;
+    }
+	/**
+	 * returns a copy of the comparator that orders the keys.
+	 */
+	Compare key_comp() const {
+        return compare();
+    }
+	/**
+	 * the bytes held by the arena, including the header and the free slots
+	 */
+	size_t memory_usage() const {
+        return sizeof(Node)*capacity;
+    }
+	/**
+	 * clear the contents in one reset of the arena, which keeps its memory
+	 */
+	void clear() {
+        destroy_values();
+        used=1;
+        free_list=0;
+        length=0;
+        node(header).left=0;
+    }
+	/**
+	 * insert an element, return the iterator to the element with its key and whether it was inserted.
+	 */
+	pair<iterator, bool> insert(const value_type &value) {
+        pair<index_t,bool> p=insert_node(value);
+        return pair<iterator, bool>(iterator(this,p.first),p.second);
+    }
+	/**
+	 * erase the element at pos, throw invalid_iterator if pos is end() or belongs to another map.
+	 */
+	void erase(iterator pos) {
+        if (pos.map_ptr!=this||pos.cur==header) throw invalid_iterator();
+        erase_node(pos.cur);
+    }
+	size_t count(const Key &key) const {
+        return find_node(key)?1:0;
+    }
+	iterator find(const Key &key) {
+        return iterator(this,find_node(key));
+    }
+	const_iterator find(const Key &key) const {
+        return const_iterator(this,find_node(key));
+    }
+	iterator lower_bound(const Key &key) {
+        return iterator(this,bound_node(key,false));
+    }
+	const_iterator lower_bound(const Key &key) const {
+        return const_iterator(this,bound_node(key,false));
+    }
+	iterator upper_bound(const Key &key) {
+        return iterator(this,bound_node(key,true));
+    }
+	const_iterator upper_bound(const Key &key) const {
+        return const_iterator(this,bound_node(key,true));
+    }
+};
+
+}
+
+#endif
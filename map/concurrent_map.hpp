@@ -0,0 +1,645 @@
+/**
+ * implement a concurrent ordered map as a lazy skip list with epoch based reclamation
+ */
+#ifndef SJTU_CONCURRENT_MAP_HPP
+#define SJTU_CONCURRENT_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * epoch based reclamation shared by all concurrent maps.
+ * a thread pins itself before it reads shared nodes and unpins when it drops every pointer it read.
+ * an unlinked node is retired with the global epoch of the moment, and freed once the epoch has advanced
+ *   twice: the epoch only advances when every pinned thread has seen the current one,
+ *   so no thread that could still hold the node is pinned by then.
+ */
+class epoch_domain{
+private:
+    static const size_t quiescent=SIZE_MAX;
+    // a thread tries to advance the epoch every this many retired nodes
+    static const size_t advance_period=64;
+
+    struct retired{
+        void *ptr;
+        void (*destroy)(void *);
+    };
+    struct record{
+        std::atomic<size_t> epoch;
+        std::atomic<bool> used;
+        record *next;
+        size_t nesting;
+        size_t retire_count;
+        // garbage[i] holds the nodes retired in epoch tag[i], tag[i] % 3 == i
+        std::vector<retired> garbage[3];
+        size_t tag[3];
+        record():epoch(quiescent),used(true),next(nullptr),nesting(0),retire_count(0){
+            tag[0]=tag[1]=tag[2]=0;
+        }
+    };
+    // hands the record back when its thread exits, the garbage left in it is freed by the next owner
+    struct owner{
+        record *rec;
+        owner():rec(nullptr){}
+        ~owner(){
+            if (!rec) return;
+            instance().collect(rec);
+            rec->used.store(false,std::memory_order_release);
+        }
+    };
+
+    std::atomic<size_t> global;
+    std::atomic<record *> records;
+
+    epoch_domain():global(0),records(nullptr){}
+    ~epoch_domain(){
+        record *r=records.load();
+        while (r){
+            record *nxt=r->next;
+            for (size_t i=0;i<3;++i) free_all(r->garbage[i]);
+            delete r;
+            r=nxt;
+        }
+    }
+
+    static void free_all(std::vector<retired> &list){
+        for (size_t i=0;i<list.size();++i) list[i].destroy(list[i].ptr);
+        list.clear();
+    }
+    record *local(){
+        static thread_local owner self;
+        if (self.rec) return self.rec;
+        for (record *r=records.load(std::memory_order_acquire);r;r=r->next){
+            bool expected=false;
+            if (!r->used.load(std::memory_order_relaxed)&&r->used.compare_exchange_strong(expected,true))
+                return self.rec=r;
+        }
+        record *r=new record;
+        r->next=records.load(std::memory_order_relaxed);
+        while (!records.compare_exchange_weak(r->next,r,std::memory_order_release,std::memory_order_relaxed));
+        return self.rec=r;
+    }
+    /**
+     * free the garbage of r retired at least two epochs ago
+     */
+    void collect(record *r){
+        size_t now=global.load(std::memory_order_acquire);
+        for (size_t i=0;i<3;++i)
+            if (r->tag[i]+2<=now) free_all(r->garbage[i]);
+    }
+    void try_advance(){
+        size_t now=global.load(std::memory_order_seq_cst);
+        for (record *r=records.load(std::memory_order_acquire);r;r=r->next){
+            size_t e=r->epoch.load(std::memory_order_seq_cst);
+            if (e!=quiescent&&e!=now) return;
+        }
+        global.compare_exchange_strong(now,now+1);
+    }
+
+public:
+    static epoch_domain &instance(){
+        static epoch_domain domain;
+        return domain;
+    }
+    epoch_domain(const epoch_domain &other) = delete;
+    epoch_domain &operator=(const epoch_domain &other) = delete;
+
+    /**
+     * pins nest, only the outermost pin of a thread announces its epoch
+     */
+    void pin(){
+        record *r=local();
+        if (r->nesting++==0) r->epoch.store(global.load(std::memory_order_relaxed),std::memory_order_seq_cst);
+    }
+    void unpin(){
+        record *r=local();
+        if (--r->nesting==0) r->epoch.store(quiescent,std::memory_order_release);
+    }
+    /**
+     * free ptr with destroy once no pinned thread can reach it, the caller has unlinked it already
+     */
+    void retire(void *ptr,void (*destroy)(void *)){
+        record *r=local();
+        size_t now=global.load(std::memory_order_acquire),i=now%3;
+        if (r->tag[i]!=now){
+            // the bucket holds nodes of epoch now - 3 or earlier
+            free_all(r->garbage[i]);
+            r->tag[i]=now;
+        }
+        r->garbage[i].push_back(retired{ptr,destroy});
+        if (++r->retire_count%advance_period==0){
+            try_advance();
+            collect(r);
+        }
+    }
+
+    /**
+     * pins the calling thread for its lifetime
+     */
+    class guard{
+    public:
+        guard(){
+            instance().pin();
+        }
+        guard(const guard &){
+            instance().pin();
+        }
+        guard &operator=(const guard &){
+            return *this;
+        }
+        ~guard(){
+            instance().unpin();
+        }
+    };
+};
+
+/**
+ * an ordered map that many threads can use at once.
+ * lookups never lock or write shared memory: they walk the skip list and check the flags of the node they find.
+ * insert and erase lock only the predecessors of the node at each of its levels, and validate them before linking,
+ *   an erased node is first marked, then unlinked, then retired to the epoch_domain.
+ *
+ * iteration is weakly consistent: an iterator visits the elements in key order, sees every element present
+ *   during the whole walk, and may or may not see the ones inserted or erased meanwhile.
+ * an iterator pins its thread, so it has to stay on the thread that made it,
+ *   and erased nodes are not freed while any iterator is alive.
+ * mapped values are never changed in place, assign replaces the element.
+ * copying, assignment, clear and destruction must not run concurrently with anything else on the map.
+ */
+template<
+	class Key,
+	class T,
+	class Compare = std::less<Key>
+> class concurrent_map : private functor_holder<Compare, 0> {
+public:
+	typedef pair<const Key, T> value_type;
+
+private:
+    static const size_t max_level=32;
+
+    class spin_lock{
+    private:
+        std::atomic<bool> locked;
+    public:
+        spin_lock():locked(false){}
+        void lock(){
+            while (locked.exchange(true,std::memory_order_acquire))
+                while (locked.load(std::memory_order_relaxed)) std::this_thread::yield();
+        }
+        void unlock(){
+            locked.store(false,std::memory_order_release);
+        }
+    };
+    /**
+     * a node and its levels next[0, levels) live in one allocation, the head has no value
+     */
+    struct Node{
+        typename std::aligned_storage<sizeof(value_type),alignof(value_type)>::type storage;
+        size_t levels;
+        std::atomic<bool> marked;
+        std::atomic<bool> linked;
+        spin_lock lock;
+        std::atomic<Node *> *next;
+        explicit Node(size_t l):levels(l),marked(false),linked(false){
+            next=reinterpret_cast<std::atomic<Node *> *>(this+1);
+            for (size_t i=0;i<levels;++i) new(next+i) std::atomic<Node *>(nullptr);
+        }
+        value_type &value(){return *reinterpret_cast<value_type *>(&storage);}
+        const Key &key(){return value().first;}
+    };
+
+    Node *head;
+    std::atomic<size_t> length;
+
+    static Node *alloc_node(size_t levels){
+        void *mem=::operator new(sizeof(Node)+levels*sizeof(std::atomic<Node *>));
+        return new(mem) Node(levels);
+    }
+    static Node *make_node(const value_type &value,size_t levels){
+        Node *p=alloc_node(levels);
+        try{
+            new(&p->value()) value_type(value);
+        }catch (...){
+            ::operator delete(p);
+            throw;
+        }
+        return p;
+    }
+    static void free_node(void *ptr){
+        Node *p=static_cast<Node *>(ptr);
+        p->value().~value_type();
+        ::operator delete(p);
+    }
+    static size_t random_level(){
+        static thread_local uint64_t state=0x9e3779b97f4a7c15ULL^(uint64_t)(uintptr_t)&state;
+        state^=state<<13;
+        state^=state>>7;
+        state^=state<<17;
+        size_t level=1;
+        for (uint64_t bits=state;(bits&1)&&level<max_level;bits>>=1) ++level;
+        return level;
+    }
+
+    /**
+     * the comparator of this map, it takes no space if it is empty
+     */
+    inline const Compare &compare() const {return functor_holder<Compare, 0>::get();}
+    inline bool key_less(const Key &a,const Key &b) const {return compare()(a,b);}
+    /**
+     * fill preds and succs with the last node before key and the first node not before it on every level,
+     *   and return the highest level where succs holds key, -1 if none does
+     */
+    int search(const Key &key,Node **preds,Node **succs) const{
+        int found=-1;
+        Node *pred=head;
+        for (int level=max_level-1;level>=0;--level){
+            Node *cur=pred->next[level].load(std::memory_order_acquire);
+            while (cur&&key_less(cur->key(),key)){
+                pred=cur;
+                cur=pred->next[level].load(std::memory_order_acquire);
+            }
+            if (found==-1&&cur&&!key_less(key,cur->key())) found=level;
+            preds[level]=pred;
+            succs[level]=cur;
+        }
+        return found;
+    }
+    /**
+     * the first node with key not less than key (greater if strict) that is in the map, nullptr if none
+     */
+    Node *bound_node(const Key &key,bool strict) const{
+        Node *pred=head,*cur=nullptr;
+        for (int level=max_level-1;level>=0;--level){
+            cur=pred->next[level].load(std::memory_order_acquire);
+            while (cur&&(strict?!key_less(key,cur->key()):key_less(cur->key(),key))){
+                pred=cur;
+                cur=pred->next[level].load(std::memory_order_acquire);
+            }
+        }
+        return skip_dead(cur);
+    }
+    static Node *skip_dead(Node *p){
+        while (p&&(p->marked.load(std::memory_order_acquire)||!p->linked.load(std::memory_order_acquire)))
+            p=p->next[0].load(std::memory_order_acquire);
+        return p;
+    }
+    Node *find_node(const Key &key) const{
+        Node *preds[max_level],*succs[max_level];
+        int found=search(key,preds,succs);
+        if (found==-1) return nullptr;
+        Node *p=succs[found];
+        return p->linked.load(std::memory_order_acquire)&&!p->marked.load(std::memory_order_acquire)?p:nullptr;
+    }
+    static void unlock_preds(Node **preds,int highest){
+        Node *prev=nullptr;
+        for (int level=0;level<=highest;++level)
+            if (preds[level]!=prev){
+                preds[level]->lock.unlock();
+                prev=preds[level];
+            }
+    }
+    /**
+     * lock the distinct predecessors of levels [0, levels) bottom up and check that
+     *   they still link to succs (to victim if given) and are not erased.
+     * highest is the highest level locked, to be passed to unlock_preds
+     */
+    static bool lock_preds(Node **preds,Node **succs,Node *victim,size_t levels,int &highest){
+        Node *prev=nullptr;
+        highest=-1;
+        for (size_t level=0;level<levels;++level){
+            Node *pred=preds[level],*succ=victim?victim:succs[level];
+            if (pred!=prev){
+                pred->lock.lock();
+                highest=(int)level;
+                prev=pred;
+            }
+            if (pred->marked.load(std::memory_order_acquire)||pred->next[level].load(std::memory_order_acquire)!=succ)
+                return false;
+            if (!victim&&succ&&succ->marked.load(std::memory_order_acquire)) return false;
+        }
+        return true;
+    }
+    /**
+     * link a new node holding value unless key exists, return the node with the key and whether it is new
+     */
+    pair<Node *,bool> insert_node(const value_type &value){
+        Node *preds[max_level],*succs[max_level];
+        Node *p=nullptr;
+        while (true){
+            int found=search(value.first,preds,succs);
+            if (found!=-1){
+                Node *q=succs[found];
+                if (!q->marked.load(std::memory_order_acquire)){
+                    while (!q->linked.load(std::memory_order_acquire)) std::this_thread::yield();
+                    if (p) free_node(p);
+                    return pair<Node *,bool>(q,false);
+                }
+                // the node is being erased, retry once it is gone
+                continue;
+            }
+            // allocated before any lock is taken, and kept for the retries
+            if (!p) p=make_node(value,random_level());
+            int highest;
+            if (!lock_preds(preds,succs,nullptr,p->levels,highest)){
+                unlock_preds(preds,highest);
+                continue;
+            }
+            for (size_t level=0;level<p->levels;++level) p->next[level].store(succs[level],std::memory_order_relaxed);
+            for (size_t level=0;level<p->levels;++level) preds[level]->next[level].store(p,std::memory_order_release);
+            p->linked.store(true,std::memory_order_release);
+            unlock_preds(preds,highest);
+            length.fetch_add(1,std::memory_order_relaxed);
+            return pair<Node *,bool>(p,true);
+        }
+    }
+    /**
+     * mark, unlink and retire the node with key, return false if there is none.
+     * with target given only that very node is erased, not one inserted with the key after it
+     */
+    bool erase_node(const Key &key,Node *target=nullptr){
+        Node *preds[max_level],*succs[max_level],*victim=nullptr;
+        while (true){
+            int found=search(key,preds,succs);
+            if (!victim){
+                if (found==-1) return false;
+                Node *p=succs[found];
+                if (target&&p!=target) return false;
+                // only a fully linked node found on its top level can be erased
+                if (!p->linked.load(std::memory_order_acquire)||p->levels!=(size_t)found+1||p->marked.load(std::memory_order_acquire))
+                    return false;
+                p->lock.lock();
+                if (p->marked.load(std::memory_order_relaxed)){
+                    p->lock.unlock();
+                    return false;
+                }
+                p->marked.store(true,std::memory_order_release);
+                victim=p;
+            }
+            int highest;
+            if (!lock_preds(preds,succs,victim,victim->levels,highest)){
+                unlock_preds(preds,highest);
+                continue;
+            }
+            for (int level=(int)victim->levels-1;level>=0;--level)
+                preds[level]->next[level].store(victim->next[level].load(std::memory_order_relaxed),std::memory_order_release);
+            victim->lock.unlock();
+            unlock_preds(preds,highest);
+            length.fetch_sub(1,std::memory_order_relaxed);
+            epoch_domain::instance().retire(victim,free_node);
+            return true;
+        }
+    }
+    /**
+     * free every node right away instead of retiring it, nothing else may use the map
+     */
+    void free_nodes(){
+        Node *p=head->next[0].load(std::memory_order_relaxed);
+        while (p){
+            Node *nxt=p->next[0].load(std::memory_order_relaxed);
+            free_node(p);
+            p=nxt;
+        }
+        for (size_t i=0;i<max_level;++i) head->next[i].store(nullptr,std::memory_order_relaxed);
+    }
+    void destroy(){
+        free_nodes();
+        ::operator delete(head);
+    }
+    void init(){
+        head=alloc_node(max_level);
+        length.store(0,std::memory_order_relaxed);
+    }
+    /**
+     * append the elements of other behind tails, other is not changed concurrently
+     */
+    void copy(const concurrent_map &other){
+        Node *tails[max_level];
+        for (size_t i=0;i<max_level;++i) tails[i]=head;
+        size_t n=0;
+        for (Node *p=skip_dead(other.head->next[0].load());p;p=skip_dead(p->next[0].load())){
+            Node *q=make_node(p->value(),p->levels);
+            for (size_t level=0;level<q->levels;++level){
+                tails[level]->next[level].store(q,std::memory_order_relaxed);
+                tails[level]=q;
+            }
+            q->linked.store(true,std::memory_order_relaxed);
+            ++n;
+        }
+        length.store(n,std::memory_order_release);
+    }
+
+public:
+	class const_iterator {
+    friend class concurrent_map;
+    private:
+        const concurrent_map *map_ptr;
+        // nullptr for end()
+        Node *cur;
+        epoch_domain::guard pin;
+    public:
+        const_iterator():map_ptr(nullptr),cur(nullptr) {}
+        const_iterator(const const_iterator &other):map_ptr(other.map_ptr),cur(other.cur) {}
+        const_iterator(const concurrent_map *_map_ptr,Node *_cur):map_ptr(_map_ptr),cur(_cur) {}
+        const_iterator & operator=(const const_iterator &other) {
+            map_ptr=other.map_ptr;
+            cur=other.cur;
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator tmp=*this;
+            ++*this;
+            return tmp;
+        }
+		/**
+		 * ++iter follows the bottom level, an element erased meanwhile still leads on to the following ones
+		 */
+        const_iterator & operator++() {
+            if (!cur) throw invalid_iterator();
+            cur=skip_dead(cur->next[0].load(std::memory_order_acquire));
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator tmp=*this;
+            --*this;
+            return tmp;
+        }
+		/**
+		 * --iter searches the predecessor from the head in O(log n)
+		 */
+        const_iterator & operator--() {
+            if (!map_ptr) throw invalid_iterator();
+            Node *bound=cur;
+            while (true){
+                // the last node before bound, or the last node if bound is end()
+                Node *pred=map_ptr->head;
+                for (int level=max_level-1;level>=0;--level){
+                    Node *p=pred->next[level].load(std::memory_order_acquire);
+                    while (p&&(!bound||map_ptr->key_less(p->key(),bound->key()))){
+                        pred=p;
+                        p=pred->next[level].load(std::memory_order_acquire);
+                    }
+                }
+                if (pred==map_ptr->head) throw invalid_iterator();
+                if (skip_dead(pred)==pred){
+                    cur=pred;
+                    return *this;
+                }
+                bound=pred;
+            }
+        }
+        const value_type & operator*() const {
+            if (!cur) throw invalid_iterator();
+            return cur->value();
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&cur==rhs.cur;
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this==rhs);
+        }
+        const value_type* operator->() const noexcept {
+            return &cur->value();
+        }
+	};
+	typedef const_iterator iterator;
+
+	concurrent_map() {
+        init();
+    }
+	/**
+	 * an empty map ordered by comp, which is copied into the map and used for every comparison.
+	 */
+	explicit concurrent_map(const Compare &comp):functor_holder<Compare, 0>(comp) {
+        init();
+    }
+	concurrent_map(const concurrent_map &other):functor_holder<Compare, 0>(other) {
+        init();
+        epoch_domain::guard pin;
+        copy(other);
+    }
+	concurrent_map & operator=(const concurrent_map &other) {
+        if (this==&other) return *this;
+        destroy();
+        init();
+        functor_holder<Compare, 0>::operator=(other);
+        epoch_domain::guard pin;
+        copy(other);
+        return *this;
+    }
+	~concurrent_map() {
+        destroy();
+    }
+	/**
+	 * a copy of the mapped value of key, throw index_out_of_bound if key is not found.
+	 * the mapped value is returned by value since another thread may erase the element right away.
+	 */
+	T at(const Key &key) const {
+        epoch_domain::guard pin;
+        Node *p=find_node(key);
+        if (!p) throw index_out_of_bound();
+        return p->value().second;
+    }
+	const_iterator begin() const {
+        epoch_domain::guard pin;
+        return const_iterator(this,skip_dead(head->next[0].load(std::memory_order_acquire)));
+    }
+	const_iterator cbegin() const {
+        return begin();
+    }
+	const_iterator end() const {
+        return const_iterator(this,nullptr);
+    }
+	const_iterator cend() const {
+        return end();
+    }
+	bool empty() const {
+        return size()==0;
+    }
+	/**
+	 * the number of elements, exact when no insert or erase is running
+	 */
+	size_t size() const {
+        return length.load(std::memory_order_relaxed);
+    }
+	/**
+	 * erase all elements and free them at once.
+	 * like copying and assignment it must not run concurrently with anything else on the map,
+	 *   and no iterator of the map may be alive.
+	 */
+	void clear() {
+        free_nodes();
+        length.store(0,std::memory_order_relaxed);
+    }
+	/**
+	 * returns a copy of the comparator that orders the keys.
+	 */
+	Compare key_comp() const {
+        return compare();
+    }
+	/**
+	 * insert value if its key does not exist.
+	 * return the iterator to the element with the key and whether value was inserted.
+	 */
+	pair<const_iterator, bool> insert(const value_type &value) {
+        epoch_domain::guard pin;
+        pair<Node *,bool> p=insert_node(value);
+        return pair<const_iterator, bool>(const_iterator(this,p.first),p.second);
+    }
+	/**
+	 * set the mapped value of key to value by erasing and inserting the element,
+	 *   readers see the old element, no element, then the new one.
+	 * return true if the key did not exist before.
+	 */
+	bool assign(const Key &key, const T &value) {
+        epoch_domain::guard pin;
+        bool existed=erase_node(key);
+        while (!insert_node(value_type(key,value)).second) erase_node(key);
+        return !existed;
+    }
+	/**
+	 * erase the element with key, return the number of erased elements (0 or 1).
+	 */
+	size_t erase(const Key &key) {
+        epoch_domain::guard pin;
+        return erase_node(key)?1:0;
+    }
+	/**
+	 * erase the element at pos, throw invalid_iterator if pos is end() or belongs to another map.
+	 * nothing happens if another thread has erased the element already.
+	 */
+	void erase(const_iterator pos) {
+        if (pos.map_ptr!=this||!pos.cur) throw invalid_iterator();
+        erase_node(pos.cur->key(),pos.cur);
+    }
+	size_t count(const Key &key) const {
+        epoch_domain::guard pin;
+        return find_node(key)?1:0;
+    }
+	const_iterator find(const Key &key) const {
+        epoch_domain::guard pin;
+        return const_iterator(this,find_node(key));
+    }
+	const_iterator lower_bound(const Key &key) const {
+        epoch_domain::guard pin;
+        return const_iterator(this,bound_node(key,false));
+    }
+	const_iterator upper_bound(const Key &key) const {
+        epoch_domain::guard pin;
+        return const_iterator(this,bound_node(key,true));
+    }
+};
+
+}
+
+#endif
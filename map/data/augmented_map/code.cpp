@@ -0,0 +1,207 @@
+// correctness of augmented_map against a brute-force scan: aggregates of commutative and
+// non-commutative monoids under random writes, erasures that rebalance the tree, copies and errors
+#include "augmented_map.hpp"
+
+#include <climits>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+
+void report(int id, const char *title, bool ok) {
+	printf("Test %d: %-55s%s\n", id, title, ok ? "PASSED" : "FAILED");
+}
+
+struct sum {
+	typedef long long value_type;
+	long long identity() const {
+		return 0;
+	}
+	long long combine(long long a, long long b) const {
+		return a + b;
+	}
+};
+
+struct minimum {
+	typedef int value_type;
+	int identity() const {
+		return INT_MAX;
+	}
+	int combine(int a, int b) const {
+		return a < b ? a : b;
+	}
+};
+
+// x -> mul * x + add modulo a prime, composed in key order: combining in the wrong order changes the result
+struct affine {
+	static const long long mod = 1000000007;
+	long long mul, add;
+	affine(long long mul = 1, long long add = 0) : mul(mul), add(add) {}
+	affine(int v) : mul((v + 100000) % 1009 + 2), add((v + 100000) % 997 + 1) {}
+	bool operator==(const affine &rhs) const {
+		return mul == rhs.mul && add == rhs.add;
+	}
+};
+
+struct compose {
+	typedef affine value_type;
+	affine identity() const {
+		return affine();
+	}
+	// first a, then b
+	affine combine(const affine &a, const affine &b) const {
+		return affine(a.mul * b.mul % affine::mod, (b.mul * a.add + b.add) % affine::mod);
+	}
+};
+
+struct concat {
+	typedef std::string value_type;
+	std::string identity() const {
+		return "";
+	}
+	std::string combine(const std::string &a, const std::string &b) const {
+		return a + b;
+	}
+};
+
+// ascending or descending, chosen at run time
+struct ordered {
+	bool descending;
+	explicit ordered(bool descending) : descending(descending) {}
+	bool operator()(int a, int b) const {
+		return descending ? b < a : a < b;
+	}
+};
+
+template<class Monoid, class Ref, class Compare>
+typename Monoid::value_type scan(const Ref &ref, int lo, int hi, const Compare &less) {
+	Monoid m;
+	typename Monoid::value_type res = m.identity();
+	for (typename Ref::const_iterator it = ref.lower_bound(lo); it != ref.end() && less(it->first, hi); ++it)
+		res = m.combine(res, typename Monoid::value_type(it->second));
+	return res;
+}
+
+// random assign, insert and erase on a small or a large key range, every few steps a range is checked
+bool test_commutative() {
+	std::mt19937 rng(37);
+	for (int round = 0; round < 20; round++) {
+		sjtu::augmented_map<int, int, sum> sums;
+		sjtu::augmented_map<int, int, minimum> mins;
+		std::map<int, int> ref;
+		int range = round % 2 ? 100000 : 300;
+		for (int op = 0; op < 5000; op++) {
+			int key = (int)(rng() % range), value = (int)(rng() % 2000) - 1000;
+			switch (rng() % 6) {
+			case 0:
+			case 1:
+				if (sums.assign(key, value) != !ref.count(key)) return false;
+				mins.assign(key, value);
+				ref[key] = value;
+				break;
+			case 2:
+				if (sums.insert(sjtu::augmented_map<int, int, sum>::value_type(key, value)).second != ref.insert(std::make_pair(key, value)).second) return false;
+				mins.insert(sjtu::augmented_map<int, int, minimum>::value_type(key, value));
+				break;
+			case 3:
+				if (mins.erase(key) != ref.count(key) || sums.erase(key) != ref.erase(key)) return false;
+				break;
+			default: {
+				int lo = (int)(rng() % (range + 2)) - 1, hi = lo + (int)(rng() % (range / 3 + 2));
+				if (sums.aggregate(lo, hi) != scan<sum>(ref, lo, hi, std::less<int>())) return false;
+				if (mins.aggregate(lo, hi) != scan<minimum>(ref, lo, hi, std::less<int>())) return false;
+			}
+			}
+		}
+		if (sums.size() != ref.size() || sums.aggregate() != scan<sum>(ref, INT_MIN, INT_MAX, std::less<int>())) return false;
+	}
+	return true;
+}
+
+// ascending runs and erasures of every other key and of whole halves rotate at every level
+bool test_rotations() {
+	std::mt19937 rng(38);
+	const int n = 3000;
+	sjtu::augmented_map<int, int, compose> map;
+	std::map<int, int> ref;
+	for (int i = 0; i < n; i++) {
+		map.assign(i, i * 7 % 1013);
+		ref[i] = i * 7 % 1013;
+	}
+	for (int step = 0; step < 4; step++) {
+		for (std::map<int, int>::iterator it = ref.begin(); it != ref.end();) {
+			bool drop = step % 2 ? it->first < n / 2 + step * 100 : it->first % 2 == 0;
+			if (!drop) {
+				++it;
+				continue;
+			}
+			if (it->first % 3) map.erase(map.find(it->first));
+			else map.erase(it->first);
+			ref.erase(it++);
+			if (rng() % 8) continue;
+			int lo = (int)(rng() % (n + 2)) - 1, hi = lo + (int)(rng() % n);
+			if (!(map.aggregate(lo, hi) == scan<compose>(ref, lo, hi, std::less<int>()))) return false;
+		}
+		for (int i = step; i < n; i += 5) {
+			map.assign(n - i, -i);
+			ref[n - i] = -i;
+		}
+		if (!(map.aggregate() == scan<compose>(ref, INT_MIN, INT_MAX, std::less<int>()))) return false;
+	}
+	for (int q = 0; q < 2000; q++) {
+		int lo = (int)(rng() % (n + 2)) - 1, hi = lo + (int)(rng() % n);
+		if (!(map.aggregate(lo, hi) == scan<compose>(ref, lo, hi, std::less<int>()))) return false;
+	}
+	return map.size() == ref.size();
+}
+
+// concatenation follows the order of the comparator, which carries state
+bool test_stateful_order() {
+	typedef sjtu::augmented_map<int, std::string, concat, ordered> smap;
+	std::mt19937 rng(39);
+	ordered less(true);
+	smap map(less);
+	std::map<int, std::string, ordered> ref(less);
+	for (int op = 0; op < 4000; op++) {
+		int key = (int)(rng() % 500);
+		if (rng() % 3) {
+			std::string value = std::to_string(op) + ",";
+			map.assign(key, value);
+			ref[key] = value;
+		} else if (map.erase(key) != ref.erase(key)) return false;
+		int lo = 500 - (int)(rng() % 520), hi = lo - (int)(rng() % 200);
+		if (map.aggregate(lo, hi) != scan<concat>(ref, lo, hi, less)) return false;
+	}
+	smap copy(map), other((ordered(false)));
+	other = copy;
+	std::string all = scan<concat>(ref, INT_MAX, INT_MIN, less);
+	return map.aggregate() == all && copy.aggregate() == all && other.aggregate() == all && other.key_comp().descending;
+}
+
+bool test_errors() {
+	sjtu::augmented_map<int, int, sum> map, other;
+	map.assign(1, 10);
+	other.assign(1, 10);
+	try {
+		map.at(2);
+		return false;
+	} catch (sjtu::index_out_of_bound &) {}
+	try {
+		map.erase(map.end());
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		map.erase(other.begin());
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	map.clear();
+	return map.empty() && map.aggregate() == 0 && map.aggregate(0, 100) == 0 && other.aggregate(1, 2) == 10;
+}
+
+int main() {
+	report(1, "Sums and minimums under random writes...", test_commutative());
+	report(2, "Composition in key order across rotations...", test_rotations());
+	report(3, "Concatenation under a comparator with state...", test_stateful_order());
+	report(4, "Exceptions and clear...", test_errors());
+	return 0;
+}
@@ -0,0 +1,77 @@
+// btree_map benchmark: insert, random lookups, a full scan and erase on int and string keys,
+// against sjtu::map and std::map
+// usage: ./code [entries] [lookups]
+
+#include "btree_map.hpp"
+#include "map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<class Map, class Key>
+long long bench(const char *name, const std::vector<Key> &keys, const std::vector<Key> &probes) {
+    Map map;
+    long long check = 0;
+    double insert = timeit([&] {
+        for (size_t i = 0; i < keys.size(); ++i) map[keys[i]] = (int) i;
+    });
+    double find = timeit([&] {
+        for (size_t i = 0; i < probes.size(); ++i) check += map.count(probes[i]);
+    });
+    double scan = timeit([&] {
+        for (typename Map::iterator it = map.begin(); it != map.end(); ++it) check += it->second;
+    });
+    double erase = timeit([&] {
+        for (size_t i = 0; i < keys.size(); i += 2) {
+            typename Map::iterator it = map.find(keys[i]);
+            if (it != map.end()) map.erase(it);
+        }
+    });
+    check += map.size();
+    std::printf("%-16s insert %8.1f ms  find %8.1f ms  scan %7.1f ms  erase %8.1f ms\n", name, insert, find, scan, erase);
+    return check;
+}
+
+template<class Key>
+bool run(const std::vector<Key> &keys, const std::vector<Key> &probes) {
+    long long a = bench<sjtu::btree_map<Key, int>>("sjtu::btree_map", keys, probes);
+    long long b = bench<sjtu::map<Key, int>>("sjtu::map", keys, probes);
+    long long c = bench<std::map<Key, int>>("std::map", keys, probes);
+    return a == b && b == c;
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    int lookups = argc > 2 ? std::atoi(argv[2]) : 2000000;
+    std::mt19937_64 rng(20231101);
+    std::vector<int> keys, probes;
+    for (int i = 0; i < n; ++i) keys.push_back((int) (rng() >> 33));
+    for (int i = 0; i < lookups; ++i) probes.push_back(i % 2 ? keys[rng() % n] : (int) (rng() >> 33));
+    std::printf("%d int keys, %d lookups\n", n, lookups);
+    bool ok = run(keys, probes);
+
+    // a tenth as many string keys, they cost more to build and to compare
+    int m = n / 10 > 0 ? n / 10 : 1;
+    std::vector<std::string> skeys, sprobes;
+    for (int i = 0; i < m; ++i) skeys.push_back("item:" + std::to_string(rng() % (4ull * m)));
+    for (int i = 0; i < lookups; ++i) sprobes.push_back(i % 2 ? skeys[rng() % m] : "item:" + std::to_string(rng() % (4ull * m)));
+    std::printf("%d string keys, %d lookups\n", m, lookups);
+    ok = run(skeys, sprobes) && ok;
+    if (!ok) {
+        std::printf("mismatch\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,234 @@
+// correctness of btree_map against std::map: leaf and inner splits, borrowing and merging,
+// with key ranges small enough to stay in the root leaf and large enough for merges to reach the root
+#include "btree_map.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+void report(int id, const char *title, bool ok) {
+	printf("Test %d: %-55s%s\n", id, title, ok ? "PASSED" : "FAILED");
+}
+
+// orders ascending or descending, so a map that default-constructs its comparator gets the order wrong
+struct ordered {
+	bool descending;
+	explicit ordered(bool descending) : descending(descending) {}
+	bool operator()(int a, int b) const {
+		return descending ? b < a : a < b;
+	}
+};
+
+template<class Map>
+bool in_order(const Map &map, const std::map<int, int, ordered> &ref) {
+	typename Map::const_iterator it = map.cbegin();
+	for (std::map<int, int, ordered>::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+		if (it == map.cend() || it->first != jt->first || it->second != jt->second || map.count(jt->first) != 1) return false;
+	}
+	return it == map.cend() && map.size() == ref.size();
+}
+
+template<class K, class V>
+bool same(sjtu::btree_map<K, V> &map, const std::map<K, V> &ref) {
+	if (map.size() != ref.size() || map.empty() != ref.empty()) return false;
+	typename sjtu::btree_map<K, V>::const_iterator it = map.cbegin();
+	for (typename std::map<K, V>::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+		if (it == map.cend() || it->first != jt->first || it->second != jt->second) return false;
+	}
+	if (it != map.cend()) return false;
+	typename sjtu::btree_map<K, V>::iterator kt = map.end();
+	for (typename std::map<K, V>::const_reverse_iterator jt = ref.rbegin(); jt != ref.rend(); ++jt) {
+		--kt;
+		if (kt->first != jt->first) return false;
+	}
+	return kt == map.begin();
+}
+
+// sequential keys split the rightmost (or leftmost) leaf and inner node over and over
+bool test_sequential() {
+	const int n = 100000;
+	sjtu::btree_map<int, int> up, down;
+	std::map<int, int> ref;
+	for (int i = 0; i < n; i++) {
+		up[i] = i;
+		down.insert(sjtu::btree_map<int, int>::value_type(n - 1 - i, n - 1 - i));
+		ref[i] = i;
+	}
+	if (!same(up, ref) || !same(down, ref)) return false;
+	// erasing from the front drains the leftmost leaves, which borrow from their right siblings and merge
+	for (int i = 0; i < n; i++) {
+		up.erase(up.begin());
+		sjtu::btree_map<int, int>::iterator last = down.end();
+		down.erase(--last);
+		if (i % 9973 == 0) {
+			for (int k = 0; k <= i; k++) ref.erase(k);
+			if (up.size() != ref.size() || up.begin()->first != i + 1) return false;
+		}
+	}
+	return up.empty() && down.empty() && up.begin() == up.end() && down.begin() == down.end();
+}
+
+// erasing every other key leaves half full nodes, then the rest go in random order
+bool test_merge_to_root() {
+	const int n = 60000;
+	std::mt19937 rng(38);
+	sjtu::btree_map<int, int> map;
+	std::map<int, int> ref;
+	for (int i = 0; i < n; i++) {
+		int key = (int)(rng() % (n * 4));
+		map[key] = i;
+		ref[key] = i;
+	}
+	int step = 0;
+	for (std::map<int, int>::iterator it = ref.begin(); it != ref.end(); step++) {
+		if (step % 2 == 0) {
+			map.erase(map.find(it->first));
+			ref.erase(it++);
+		} else {
+			++it;
+		}
+	}
+	if (!same(map, ref)) return false;
+	std::vector<int> keys;
+	for (std::map<int, int>::iterator it = ref.begin(); it != ref.end(); ++it) keys.push_back(it->first);
+	std::shuffle(keys.begin(), keys.end(), rng);
+	for (size_t i = 0; i < keys.size(); i++) {
+		map.erase(map.find(keys[i]));
+		ref.erase(keys[i]);
+		if (i % 1000 == 0 && !same(map, ref)) return false;
+		if (map.count(keys[i])) return false;
+	}
+	if (!map.empty()) return false;
+	// the tree shrank back to a root leaf and can grow again
+	for (int i = 0; i < 1000; i++) map[i] = -i;
+	return map.size() == 1000 && map.at(999) == -999;
+}
+
+// a key range of a few dozen splits the root leaf and merges the two leaves back again and again
+template<class K, class G>
+bool churn(G key_of, int range, int ops, unsigned seed) {
+	std::mt19937 rng(seed);
+	sjtu::btree_map<K, int> map;
+	std::map<K, int> ref;
+	for (int op = 0; op < ops; op++) {
+		K key = key_of((int)(rng() % range));
+		switch (rng() % 6) {
+		case 0:
+		case 1: {
+			typename sjtu::btree_map<K, int>::value_type value(key, op);
+			sjtu::pair<typename sjtu::btree_map<K, int>::iterator, bool> r = map.insert(value);
+			bool inserted = ref.insert(std::make_pair(key, op)).second;
+			if (r.second != inserted || r.first->first != key || r.first->second != ref[key]) return false;
+			break;
+		}
+		case 2:
+			map[key] = op;
+			ref[key] = op;
+			break;
+		case 3:
+		case 4: {
+			typename sjtu::btree_map<K, int>::iterator it = map.find(key);
+			if ((it == map.end()) != !ref.count(key)) return false;
+			if (it != map.end()) {
+				map.erase(it);
+				ref.erase(key);
+			}
+			break;
+		}
+		default:
+			if (map.count(key) != ref.count(key)) return false;
+			if (ref.count(key) && map.at(key) != ref[key]) return false;
+		}
+		if (op % 4099 == 0 && !same(map, ref)) return false;
+	}
+	return same(map, ref);
+}
+
+bool test_small_range() {
+	return churn<int>([](int x) { return x; }, 40, 200000, 1) &&
+		churn<int>([](int x) { return x; }, 100, 200000, 2);
+}
+
+std::string string_key(int x) {
+	return "btree-key-" + std::to_string(x);
+}
+
+bool test_large_range() {
+	return churn<int>([](int x) { return x; }, 20000, 300000, 3) &&
+		churn<std::string>(string_key, 5000, 100000, 4);
+}
+
+bool test_copy_and_errors() {
+	sjtu::btree_map<std::string, int> map;
+	std::map<std::string, int> ref;
+	for (int i = 0; i < 5000; i++) {
+		map[string_key(i)] = i;
+		ref[string_key(i)] = i;
+	}
+	sjtu::btree_map<std::string, int> copy(map), other;
+	for (int i = 0; i < 5000; i += 3) copy.erase(copy.find(string_key(i)));
+	if (!same(map, ref)) return false;
+	other = copy;
+	copy = map;
+	copy = copy;
+	map.clear();
+	if (!map.empty() || !same(copy, ref) || other.size() != 5000 - 1667) return false;
+	try {
+		copy.at("missing");
+		return false;
+	} catch (sjtu::index_out_of_bound &) {}
+	try {
+		copy.erase(copy.end());
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		copy.erase(other.begin());
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		sjtu::btree_map<std::string, int>::iterator it = copy.end();
+		++it;
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		sjtu::btree_map<std::string, int>::const_iterator it = copy.cbegin();
+		--it;
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	return true;
+}
+
+// the comparator has state, so the map, its copies and its assignments have to keep it
+bool test_stateful_order() {
+	typedef sjtu::btree_map<int, int, ordered> omap;
+	std::mt19937 rng(49);
+	omap map(ordered(true));
+	std::map<int, int, ordered> ref(ordered(true));
+	for (int i = 0; i < 30000; i++) {
+		int key = (int)(rng() % 3000);
+		if (rng() % 3) {
+			map[key] = i;
+			ref[key] = i;
+		} else if (ref.count(key)) {
+			map.erase(map.find(key));
+			ref.erase(key);
+		} else if (map.find(key) != map.end()) return false;
+	}
+	omap copy(map), other(ordered(false));
+	other[1] = 1;
+	other = map;
+	return in_order(map, ref) && in_order(copy, ref) && in_order(other, ref) && other.key_comp().descending;
+}
+
+int main() {
+	report(1, "Sequential insertion and erasure at both ends...", test_sequential());
+	report(2, "Merges cascading up to the root...", test_merge_to_root());
+	report(3, "Random operations on a small key range...", test_small_range());
+	report(4, "Random operations on a large key range...", test_large_range());
+	report(5, "Copy, assignment and exceptions...", test_copy_and_errors());
+	report(6, "Ordering by a comparator with state...", test_stateful_order());
+	return 0;
+}
@@ -0,0 +1,67 @@
+// bulk load benchmark: loading 10M sorted keys into sjtu::map with insert, hinted insert at end()
+// and the range constructor, against the same on std::map
+// usage: ./code [entries]
+
+#include "map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <utility>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    typedef sjtu::map<long long, long long> Map;
+    std::vector<Map::value_type> data;
+    std::vector<std::pair<long long, long long>> std_data;
+    for (int i = 0; i < n; ++i) {
+        data.push_back(Map::value_type(3LL * i, i));
+        std_data.push_back(std::make_pair(3LL * i, (long long) i));
+    }
+
+    size_t sizes[6];
+    std::printf("%d sorted keys\n", n);
+    std::printf("sjtu::map insert      : %8.1f ms\n", timeit([&] {
+        Map map;
+        for (int i = 0; i < n; ++i) map.insert(data[i]);
+        sizes[0] = map.size();
+    }));
+    std::printf("sjtu::map hinted      : %8.1f ms\n", timeit([&] {
+        Map map;
+        for (int i = 0; i < n; ++i) map.insert(map.cend(), data[i]);
+        sizes[1] = map.size();
+    }));
+    std::printf("sjtu::map constructor : %8.1f ms\n", timeit([&] {
+        Map map(data.begin(), data.end());
+        sizes[2] = map.size();
+    }));
+    std::printf("std::map insert       : %8.1f ms\n", timeit([&] {
+        std::map<long long, long long> map;
+        for (int i = 0; i < n; ++i) map.insert(std_data[i]);
+        sizes[3] = map.size();
+    }));
+    std::printf("std::map hinted       : %8.1f ms\n", timeit([&] {
+        std::map<long long, long long> map;
+        for (int i = 0; i < n; ++i) map.insert(map.cend(), std_data[i]);
+        sizes[4] = map.size();
+    }));
+    std::printf("std::map constructor  : %8.1f ms\n", timeit([&] {
+        std::map<long long, long long> map(std_data.begin(), std_data.end());
+        sizes[5] = map.size();
+    }));
+    for (int i = 0; i < 6; ++i)
+        if (sizes[i] != (size_t) n) {
+            std::printf("mismatch\n");
+            return 1;
+        }
+    return 0;
+}
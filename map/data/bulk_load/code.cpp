@@ -0,0 +1,136 @@
+// correctness of the bulk load and the hinted insertion of map against std::map: sorted,
+// nearly sorted and shuffled input with repeated keys, and hints that are right, wrong or foreign
+#include "map.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+typedef sjtu::map<int, int> imap;
+typedef std::map<int, int> smap;
+typedef sjtu::pair<int, int> item;
+
+void report(int id, const char *title, bool ok) {
+	printf("Test %d: %-55s%s\n", id, title, ok ? "PASSED" : "FAILED");
+}
+
+// both directions of the threaded list, the subtree sizes through select, and later writes to the tree
+bool same(imap &map, const smap &ref) {
+	if (map.size() != ref.size() || map.empty() != ref.empty()) return false;
+	imap::const_iterator it = map.cbegin();
+	size_t k = 0;
+	for (smap::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it, ++k) {
+		if (it == map.cend() || it->first != jt->first || it->second != jt->second) return false;
+		if (k % 37 == 0 && (map.select(k)->first != jt->first || map.rank(jt->first) != k)) return false;
+	}
+	if (it != map.cend()) return false;
+	imap::iterator kt = map.end();
+	for (smap::const_reverse_iterator jt = ref.rbegin(); jt != ref.rend(); ++jt) {
+		--kt;
+		if (kt->first != jt->first) return false;
+	}
+	return kt == map.begin();
+}
+
+// a loaded tree has to stay a valid AVL tree under the insertions and erasures that follow
+bool churn(imap &map, smap &ref, std::mt19937 &rng, int range) {
+	for (int op = 0; op < 2000; op++) {
+		int key = (int)(rng() % (range + 1));
+		if (rng() % 2) {
+			map[key] = op;
+			ref[key] = op;
+		} else if (ref.count(key)) {
+			map.erase(map.find(key));
+			ref.erase(key);
+		}
+	}
+	return same(map, ref);
+}
+
+bool test_load() {
+	std::mt19937 rng(39);
+	for (int round = 0; round < 300; round++) {
+		int n = round < 100 ? round : (int)(rng() % 5000), range = n * 2 + 1;
+		std::vector<int> keys;
+		for (int i = 0; i < n; i++) keys.push_back((int)(rng() % range));
+		int mode = round % 3;
+		if (mode < 2) std::sort(keys.begin(), keys.end());
+		// one key out of place breaks the sorted run
+		if (mode == 1 && n > 2) std::swap(keys[n / 2], keys[n / 3 + 1]);
+		std::vector<item> elems;
+		smap ref;
+		for (int i = 0; i < n; i++) {
+			elems.push_back(item(keys[i], i));
+			// a repeated key keeps its first element
+			ref.insert(std::make_pair(keys[i], i));
+		}
+		imap map(elems.begin(), elems.end()), other;
+		other[-1] = -1;
+		other.assign(elems.begin(), elems.end());
+		if (!same(map, ref) || !same(other, ref)) return false;
+		smap copy(ref);
+		if (!churn(map, ref, rng, range) || !churn(other, copy, rng, range)) return false;
+	}
+	return true;
+}
+
+bool test_hinted_insert() {
+	std::mt19937 rng(40);
+	for (int round = 0; round < 100; round++) {
+		imap map;
+		smap ref;
+		int n = (int)(rng() % 3000), range = n + 1;
+		std::vector<int> keys;
+		for (int i = 0; i < n; i++) keys.push_back((int)(rng() % range));
+		if (round % 2) std::sort(keys.begin(), keys.end());
+		if (round % 4 == 1) std::reverse(keys.begin(), keys.end());
+		for (int i = 0; i < n; i++) {
+			int key = keys[i];
+			imap::iterator it;
+			switch (rng() % 4) {
+			case 0:
+				it = map.insert(map.end(), imap::value_type(key, i));
+				break;
+			case 1:
+				it = map.insert(map.begin(), imap::value_type(key, i));
+				break;
+			case 2:
+				// the right hint: the first element after key
+				it = map.insert(map.upper_bound(key), imap::value_type(key, i));
+				break;
+			default:
+				it = map.insert(map.lower_bound((int)(rng() % range)), imap::value_type(key, i));
+			}
+			ref.insert(std::make_pair(key, i));
+			// the new element, or the one that was there before
+			if (it->first != key || it->second != ref[key]) return false;
+		}
+		if (!same(map, ref) || !churn(map, ref, rng, range)) return false;
+	}
+	return true;
+}
+
+bool test_errors() {
+	imap map, other;
+	other[1] = 1;
+	try {
+		map.insert(other.end(), imap::value_type(1, 1));
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		map.insert(imap::const_iterator(), imap::value_type(1, 1));
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	std::vector<item> none;
+	other.assign(none.begin(), none.end());
+	return map.empty() && other.empty() && other.begin() == other.end();
+}
+
+int main() {
+	report(1, "Loading sorted, nearly sorted and shuffled input...", test_load());
+	report(2, "Insertion with right and wrong hints...", test_hinted_insert());
+	report(3, "Exceptions...", test_errors());
+	return 0;
+}
@@ -0,0 +1,56 @@
+// compact map benchmark: heap bytes per entry and random lookups of an int -> int map with 1M entries,
+// compact_map against sjtu::map
+// usage: ./code [entries] [lookups]
+
+#include "map.hpp"
+#include "compact_map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <random>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+size_t heap_in_use() {
+    return mallinfo2().uordblks;
+}
+
+template<class Map>
+void bench(const char *name, int n, const std::vector<int> &keys, const std::vector<int> &queries) {
+    size_t before = heap_in_use();
+    Map *map = new Map;
+    double build = timeit([&] {
+        for (int i = 0; i < n; ++i) (*map)[keys[i]] = i;
+    });
+    size_t bytes = heap_in_use() - before;
+    long long found = 0;
+    double lookup = timeit([&] {
+        for (size_t i = 0; i < queries.size(); ++i) found += map->count(queries[i]);
+    });
+    double clear = timeit([&] { map->clear(); });
+    std::printf("%-12s %6.1f bytes/entry  build %8.1f ms  lookup %8.1f ms  clear %6.1f ms  (found %lld)\n",
+                name, (double) bytes / n, build, lookup, clear, found);
+    delete map;
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int q = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    std::mt19937 gen(2024);
+    std::vector<int> keys(n), queries(q);
+    for (int i = 0; i < n; ++i) keys[i] = 2 * i;
+    for (int i = n - 1; i > 0; --i) std::swap(keys[i], keys[gen() % (i + 1)]);
+    for (int i = 0; i < q; ++i) queries[i] = gen() % (2 * n);
+    std::printf("%d entries, %d lookups\n", n, q);
+    bench<sjtu::map<int, int>>("sjtu::map", n, keys, queries);
+    bench<sjtu::compact_map<int, int>>("compact_map", n, keys, queries);
+    return 0;
+}
@@ -0,0 +1,267 @@
+// correctness of compact_map: the free list hands erased slots to the next insertions,
+// and growing the arena relocates every element, by move or by copy, under live iterators
+#include "compact_map.hpp"
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+void report(int id, const char *title, bool ok) {
+	printf("Test %d: %-55s%s\n", id, title, ok ? "PASSED" : "FAILED");
+}
+
+// orders ascending or descending, so a map that default-constructs its comparator gets the order wrong
+struct ordered {
+	bool descending;
+	explicit ordered(bool descending) : descending(descending) {}
+	bool operator()(int a, int b) const {
+		return descending ? b < a : a < b;
+	}
+};
+
+template<class Map>
+bool in_order(const Map &map, const std::map<int, int, ordered> &ref) {
+	typename Map::const_iterator it = map.cbegin();
+	for (std::map<int, int, ordered>::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+		if (it == map.cend() || it->first != jt->first || it->second != jt->second || map.count(jt->first) != 1) return false;
+	}
+	return it == map.cend() && map.size() == ref.size();
+}
+
+// counts its live objects, and its move may throw so the arena relocates it by copy
+class Counted {
+public:
+	static int counter;
+	std::string val;
+	Counted(const std::string &val = "") : val(val) {
+		counter++;
+	}
+	Counted(const Counted &rhs) : val(rhs.val) {
+		counter++;
+	}
+	Counted(Counted &&rhs) : val(std::move(rhs.val)) {
+		counter++;
+	}
+	Counted &operator=(const Counted &rhs) {
+		val = rhs.val;
+		return *this;
+	}
+	~Counted() {
+		counter--;
+	}
+};
+
+int Counted::counter = 0;
+
+template<class Map, class Ref>
+bool same(Map &map, const Ref &ref) {
+	if (map.size() != ref.size()) return false;
+	typename Map::const_iterator it = map.cbegin();
+	for (typename Ref::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+		if (it == map.cend() || it->first != jt->first || !(it->second == jt->second)) return false;
+	}
+	return it == map.cend();
+}
+
+bool test_free_list() {
+	sjtu::compact_map<int, int> map;
+	std::map<int, int> ref;
+	for (int i = 0; i < 10000; i++) {
+		map[i] = i;
+		ref[i] = i;
+	}
+	size_t bytes = map.memory_usage();
+	std::mt19937 rng(43);
+	// as many insertions as erasures never grow the arena again
+	for (int round = 0; round < 50; round++) {
+		std::vector<int> erased;
+		for (int j = 0; j < 500; j++) {
+			std::map<int, int>::iterator jt = ref.lower_bound((int)(rng() % 1000000));
+			if (jt == ref.end()) continue;
+			erased.push_back(jt->first);
+			map.erase(map.find(jt->first));
+			ref.erase(jt);
+		}
+		for (size_t j = 0; j < erased.size(); j++) {
+			int key = (int)(rng() % 1000000);
+			while (ref.count(key)) key = (int)(rng() % 1000000);
+			map.insert(sjtu::compact_map<int, int>::value_type(key, round));
+			ref[key] = round;
+		}
+		if (map.memory_usage() != bytes) return false;
+	}
+	if (!same(map, ref)) return false;
+	// clear() keeps the arena and starts handing out slots from the front again
+	map.clear();
+	for (int i = 0; i < 10000; i++) map[i] = -i;
+	return map.memory_usage() == bytes && map.size() == 10000 && map.at(9999) == -9999;
+}
+
+template<class V>
+bool grow_under_iterators() {
+	typedef sjtu::compact_map<int, V> cmap;
+	cmap map;
+	std::map<int, V> ref;
+	std::vector<typename cmap::iterator> its;
+	size_t bytes = map.memory_usage();
+	int grows = 0;
+	for (int i = 0; i < 20000; i++) {
+		int key = (i * 7919) % 20000;
+		std::string val = "value-" + std::to_string(i);
+		typename cmap::value_type value(key, V(val));
+		sjtu::pair<typename cmap::iterator, bool> p = map.insert(value);
+		ref.insert(std::make_pair(key, V(val)));
+		if (!p.second || p.first->second.val != val) return false;
+		if (map.memory_usage() != bytes) {
+			bytes = map.memory_usage();
+			grows++;
+		}
+		if (i % 97 == 0) its.push_back(p.first);
+	}
+	if (grows < 10 || !same(map, ref)) return false;
+	// iterators hold indices and outlive every growth
+	for (size_t i = 0; i < its.size(); i++) {
+		int key = its[i]->first;
+		if (its[i]->second.val != ref[key].val) return false;
+	}
+	return true;
+}
+
+bool operator==(const Counted &a, const Counted &b) {
+	return a.val == b.val;
+}
+
+struct Moved {
+	std::string val;
+	Moved(const std::string &val = "") : val(val) {}
+	bool operator==(const Moved &rhs) const {
+		return val == rhs.val;
+	}
+};
+
+bool test_grow() {
+	if (!grow_under_iterators<Moved>()) return false;
+	if (!grow_under_iterators<Counted>()) return false;
+	return Counted::counter == 0;
+}
+
+// inserting a copy of an element of the map while the arena is full
+bool test_grow_from_element() {
+	{
+		sjtu::compact_map<std::string, Counted> map;
+		std::map<std::string, std::string> ref;
+		for (int i = 0; i < 5000; i++) {
+			std::string key = "key-" + std::to_string(i);
+			sjtu::compact_map<std::string, Counted>::iterator it = map.find("key-" + std::to_string(i / 2));
+			Counted val(it == map.end() ? key : it->second.val + "'");
+			map.insert(sjtu::compact_map<std::string, Counted>::value_type(key, val));
+			ref[key] = val.val;
+		}
+		if (map.size() != ref.size()) return false;
+		sjtu::compact_map<std::string, Counted>::const_iterator it = map.cbegin();
+		for (std::map<std::string, std::string>::iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+			if (it->first != jt->first || it->second.val != jt->second) return false;
+		}
+		sjtu::compact_map<std::string, Counted> copy(map);
+		map.clear();
+		if (copy.size() != 5000 || copy.at("key-4999").val != ref["key-4999"]) return false;
+	}
+	return Counted::counter == 0;
+}
+
+// the comparator has state, so the map, its copies and its assignments have to keep it
+bool test_stateful_order() {
+	typedef sjtu::compact_map<int, int, ordered> omap;
+	std::mt19937 rng(49);
+	omap map(ordered(true));
+	std::map<int, int, ordered> ref(ordered(true));
+	for (int i = 0; i < 30000; i++) {
+		int key = (int)(rng() % 3000);
+		if (rng() % 3) {
+			map[key] = i;
+			ref[key] = i;
+		} else if (ref.count(key)) {
+			map.erase(map.find(key));
+			ref.erase(key);
+		}
+		omap::const_iterator lo = map.lower_bound(key);
+		std::map<int, int, ordered>::const_iterator lr = ref.lower_bound(key);
+		if ((lo == map.cend()) != (lr == ref.end()) || (lo != map.cend() && lo->first != lr->first)) return false;
+	}
+	omap copy(map), other(ordered(false));
+	other[1] = 1;
+	other = map;
+	return in_order(map, ref) && in_order(copy, ref) && in_order(other, ref) && other.key_comp().descending;
+}
+
+// its copy throws once the budget runs out, and it counts its live objects to catch leaks
+struct Fragile {
+	static int budget, counter;
+	int val;
+	Fragile(int val = 0) : val(val) {
+		counter++;
+	}
+	Fragile(const Fragile &rhs) : val(rhs.val) {
+		if (budget-- == 0) throw std::runtime_error("copy");
+		counter++;
+	}
+	Fragile &operator=(const Fragile &rhs) {
+		val = rhs.val;
+		return *this;
+	}
+	~Fragile() {
+		counter--;
+	}
+	bool operator==(const Fragile &rhs) const {
+		return val == rhs.val;
+	}
+};
+
+int Fragile::budget = -1, Fragile::counter = 0;
+
+// a copy that throws halfway leaves the target of the assignment as it was
+bool test_throwing_copy() {
+	{
+		typedef sjtu::compact_map<int, Fragile> fmap;
+		fmap source, target;
+		std::map<int, Fragile> src_ref, dst_ref;
+		for (int i = 0; i < 1000; i++) {
+			source.insert(fmap::value_type(i, Fragile(i)));
+			src_ref.insert(std::make_pair(i, Fragile(i)));
+		}
+		for (int i = 0; i < 300; i++) {
+			target.insert(fmap::value_type(i * 5, Fragile(-i)));
+			dst_ref.insert(std::make_pair(i * 5, Fragile(-i)));
+		}
+		for (int budget = 0; budget < 1000; budget += 97) {
+			Fragile::budget = budget;
+			try {
+				target = source;
+				return false;
+			} catch (std::runtime_error &) {}
+			Fragile::budget = budget;
+			try {
+				fmap copy(source);
+				return false;
+			} catch (std::runtime_error &) {}
+			Fragile::budget = -1;
+			if (!same(target, dst_ref)) return false;
+		}
+		target.insert(fmap::value_type(-1, Fragile(1)));
+		target = source;
+		if (!same(target, src_ref)) return false;
+	}
+	return Fragile::counter == 0;
+}
+
+int main() {
+	report(1, "Free list reuse and clear...", test_free_list());
+	report(2, "Growing the arena under live iterators...", test_grow());
+	report(3, "Growing with values copied from elements...", test_grow_from_element());
+	report(4, "Ordering by a comparator with state...", test_stateful_order());
+	report(5, "Assignment from a copy that throws...", test_throwing_copy());
+	return 0;
+}
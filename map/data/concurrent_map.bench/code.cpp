@@ -0,0 +1,85 @@
+// concurrency benchmark: a read-heavy (95% lookups) and a write-heavy (50% lookups, 25% inserts, 25% erases) mix
+// over 1M keys on 1, 2, 4 and 8 threads, concurrent_map against sjtu::map behind one mutex
+// usage: ./code [keys] [operations per thread]
+
+#include "map.hpp"
+#include "concurrent_map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct locked_map {
+    std::mutex lock;
+    sjtu::map<long long, long long> map;
+    bool find(long long key) {
+        std::lock_guard<std::mutex> guard(lock);
+        return map.count(key);
+    }
+    void insert(long long key) {
+        std::lock_guard<std::mutex> guard(lock);
+        map.insert(sjtu::map<long long, long long>::value_type(key, key));
+    }
+    void erase(long long key) {
+        std::lock_guard<std::mutex> guard(lock);
+        sjtu::map<long long, long long>::iterator it = map.find(key);
+        if (it != map.end()) map.erase(it);
+    }
+};
+
+struct lock_free_map {
+    sjtu::concurrent_map<long long, long long> map;
+    bool find(long long key) {
+        return map.count(key);
+    }
+    void insert(long long key) {
+        map.insert(sjtu::concurrent_map<long long, long long>::value_type(key, key));
+    }
+    void erase(long long key) {
+        map.erase(key);
+    }
+};
+
+// million operations per second
+template<class Map>
+double run(Map &map, long long keys, int threads, int ops, int read_percent) {
+    std::vector<std::thread> workers;
+    std::vector<long long> found(threads, 0);
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            std::mt19937_64 gen(t + 1);
+            for (int i = 0; i < ops; ++i) {
+                long long key = gen() % keys;
+                int kind = gen() % 100;
+                if (kind < read_percent) found[t] += map.find(key);
+                else if ((kind - read_percent) % 2 == 0) map.insert(key);
+                else map.erase(key);
+            }
+        });
+    for (int t = 0; t < threads; ++t) workers[t].join();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return (double) threads * ops / ms / 1000;
+}
+
+int main(int argc, char *argv[]) {
+    long long keys = argc > 1 ? std::atoll(argv[1]) : 1000000;
+    int ops = argc > 2 ? std::atoi(argv[2]) : 200000;
+    locked_map locked;
+    lock_free_map lock_free;
+    for (long long i = 0; i < keys; i += 2) {
+        locked.insert(i);
+        lock_free.insert(i);
+    }
+    std::printf("%lld keys, %d operations per thread, %u hardware threads, Mops/s\n", keys, ops, std::thread::hardware_concurrency());
+    const int mixes[2] = {95, 50};
+    for (int m = 0; m < 2; ++m)
+        for (int threads = 1; threads <= 8; threads *= 2)
+            std::printf("%d%% reads, %d threads: sjtu::map + mutex %7.2f  concurrent_map %7.2f\n", mixes[m], threads,
+                        run(locked, keys, threads, ops, mixes[m]), run(lock_free, keys, threads, ops, mixes[m]));
+    return 0;
+}
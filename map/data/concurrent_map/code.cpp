@@ -0,0 +1,259 @@
+// correctness of concurrent_map: single-threaded semantics against std::map, erasing through
+// a stale iterator, a multithreaded insert / erase / assign run, a stateful comparator and clear
+#include "concurrent_map.hpp"
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+typedef sjtu::concurrent_map<int, int> cmap;
+
+void report(int id, const char *title, bool ok) {
+	printf("Test %d: %-55s%s\n", id, title, ok ? "PASSED" : "FAILED");
+}
+
+// orders ascending or descending, so a map that default-constructs its comparator gets the order wrong
+struct ordered {
+	bool descending;
+	explicit ordered(bool descending) : descending(descending) {}
+	bool operator()(int a, int b) const {
+		return descending ? b < a : a < b;
+	}
+};
+
+template<class Map>
+bool in_order(const Map &map, const std::map<int, int, ordered> &ref) {
+	typename Map::const_iterator it = map.cbegin();
+	for (std::map<int, int, ordered>::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+		if (it == map.cend() || it->first != jt->first || it->second != jt->second || map.count(jt->first) != 1) return false;
+	}
+	return it == map.cend() && map.size() == ref.size();
+}
+
+bool same(const cmap &map, const std::map<int, int> &ref) {
+	if (map.size() != ref.size()) return false;
+	cmap::const_iterator it = map.cbegin();
+	for (std::map<int, int>::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+		if (it == map.cend() || it->first != jt->first || it->second != jt->second) return false;
+	}
+	return it == map.cend();
+}
+
+bool test_single() {
+	std::mt19937 rng(2024);
+	cmap map;
+	std::map<int, int> ref;
+	for (int i = 0; i < 20000; i++) {
+		int key = rng() % 2000, value = rng() % 1000;
+		switch (rng() % 5) {
+		case 0:
+		case 1: {
+			bool inserted = map.insert(cmap::value_type(key, value)).second;
+			if (inserted != ref.insert(std::make_pair(key, value)).second) return false;
+			break;
+		}
+		case 2:
+			if (map.assign(key, value) != !ref.count(key)) return false;
+			ref[key] = value;
+			break;
+		case 3:
+			if (map.erase(key) != ref.erase(key)) return false;
+			break;
+		default: {
+			cmap::const_iterator it = map.find(key);
+			if (it == map.cend()) {
+				if (ref.count(key)) return false;
+				break;
+			}
+			map.erase(it);
+			ref.erase(key);
+		}
+		}
+		if (map.count(key) != ref.count(key)) return false;
+	}
+	if (!same(map, ref)) return false;
+	for (int key = -1; key <= 2000; key += 7) {
+		std::map<int, int>::iterator lo = ref.lower_bound(key), up = ref.upper_bound(key);
+		cmap::const_iterator a = map.lower_bound(key), b = map.upper_bound(key);
+		if ((lo == ref.end()) != (a == map.cend()) || (lo != ref.end() && a->first != lo->first)) return false;
+		if ((up == ref.end()) != (b == map.cend()) || (up != ref.end() && b->first != up->first)) return false;
+		if (ref.count(key) && map.at(key) != ref[key]) return false;
+	}
+	// walk backwards from end()
+	cmap::const_iterator it = map.cend();
+	for (std::map<int, int>::reverse_iterator jt = ref.rbegin(); jt != ref.rend(); ++jt) {
+		--it;
+		if (it->first != jt->first) return false;
+	}
+	try {
+		--it;
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		map.at(-1);
+		return false;
+	} catch (sjtu::index_out_of_bound &) {}
+	try {
+		map.erase(map.cend());
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	return true;
+}
+
+bool test_stale_iterator() {
+	cmap map;
+	for (int i = 0; i < 100; i++) map.insert(cmap::value_type(i, i));
+	cmap::const_iterator it = map.find(42);
+	// the element it points to is replaced, erasing through it must leave the new one alone
+	map.erase(42);
+	map.insert(cmap::value_type(42, 4200));
+	map.erase(it);
+	if (map.size() != 100 || map.at(42) != 4200) return false;
+	it = map.find(7);
+	map.assign(7, 700);
+	map.erase(it);
+	if (map.size() != 100 || map.at(7) != 700) return false;
+	map.erase(map.find(7));
+	return map.size() == 99 && !map.count(7);
+}
+
+bool test_copy() {
+	cmap map;
+	std::map<int, int> ref;
+	for (int i = 0; i < 1000; i++) {
+		map.insert(cmap::value_type(i * 3, i));
+		ref[i * 3] = i;
+	}
+	cmap copy(map);
+	for (int i = 0; i < 1000; i += 2) copy.erase(i * 3);
+	if (!same(map, ref)) return false;
+	copy = map;
+	map.assign(0, -1);
+	if (!same(copy, ref)) return false;
+	copy = copy;
+	return same(copy, ref);
+}
+
+// every thread owns the keys congruent to its index, and all threads fight over a shared range
+const int threads = 4, owned_keys = 4000, shared_keys = 1000, rounds = 20000;
+
+bool test_threads() {
+	cmap map;
+	std::vector<std::map<int, int>> refs(threads);
+	std::vector<std::thread> pool;
+	for (int t = 0; t < threads; t++) {
+		pool.emplace_back([&map, &refs, t] {
+			std::mt19937 rng(t + 1);
+			std::map<int, int> &ref = refs[t];
+			for (int i = 0; i < rounds; i++) {
+				int key = shared_keys + (int)(rng() % (owned_keys / threads)) * threads + t, value = rng() % 1000;
+				switch (rng() % 3) {
+				case 0:
+					map.insert(cmap::value_type(key, value));
+					ref.insert(std::make_pair(key, value));
+					break;
+				case 1:
+					map.assign(key, value);
+					ref[key] = value;
+					break;
+				default:
+					map.erase(key);
+					ref.erase(key);
+				}
+				// every thread writes the same value to a shared key, then they all erase the odd ones
+				map.assign(i % shared_keys, i % shared_keys);
+			}
+			for (int key = 1; key < shared_keys; key += 2) map.erase(key);
+		});
+	}
+	for (int t = 0; t < threads; t++) pool[t].join();
+	std::map<int, int> ref;
+	for (int key = 0; key < shared_keys; key += 2) ref[key] = key;
+	for (int t = 0; t < threads; t++) ref.insert(refs[t].begin(), refs[t].end());
+	return same(map, ref);
+}
+
+// the comparator has state, so the map, its copies and its assignments have to keep it
+bool test_stateful_order() {
+	typedef sjtu::concurrent_map<int, int, ordered> omap;
+	std::mt19937 rng(49);
+	omap map(ordered(true));
+	std::map<int, int, ordered> ref(ordered(true));
+	for (int i = 0; i < 30000; i++) {
+		int key = (int)(rng() % 3000);
+		if (rng() % 3) {
+			map.assign(key, i);
+			ref[key] = i;
+		} else if (map.erase(key) != ref.erase(key)) return false;
+		omap::const_iterator lo = map.lower_bound(key);
+		std::map<int, int, ordered>::const_iterator lr = ref.lower_bound(key);
+		if ((lo == map.cend()) != (lr == ref.end()) || (lo != map.cend() && lo->first != lr->first)) return false;
+	}
+	omap copy(map), other(ordered(false));
+	other.assign(1, 1);
+	other = map;
+	return in_order(map, ref) && in_order(copy, ref) && in_order(other, ref) && other.key_comp().descending;
+}
+
+// counts the live mapped values, so the test sees when the nodes are freed
+struct counted {
+	static int live;
+	int val;
+	counted(int val = 0) : val(val) {
+		live++;
+	}
+	counted(const counted &rhs) : val(rhs.val) {
+		live++;
+	}
+	~counted() {
+		live--;
+	}
+};
+
+int counted::live = 0;
+
+// clear frees the nodes at once, and the map works as a new one afterwards
+bool test_clear() {
+	typedef sjtu::concurrent_map<int, counted> vmap;
+	vmap map;
+	map.clear();
+	if (!map.empty() || map.cbegin() != map.cend()) return false;
+	for (int i = 0; i < 5000; i++) map.insert(vmap::value_type(i, counted(i)));
+	if (counted::live != 5000) return false;
+	map.clear();
+	if (counted::live != 0 || !map.empty() || map.size() != 0 || map.cbegin() != map.cend()) return false;
+	if (map.count(10) || map.find(10) != map.cend() || map.lower_bound(-1) != map.cend()) return false;
+	cmap other;
+	std::map<int, int> ref;
+	std::mt19937 rng(42);
+	for (int round = 0; round < 3; round++) {
+		for (int i = 0; i < 3000; i++) {
+			int key = (int)(rng() % 1000);
+			if (rng() % 3) {
+				other.assign(key, i);
+				ref[key] = i;
+			} else if (other.erase(key) != ref.erase(key)) return false;
+		}
+		if (!same(other, ref)) return false;
+		other.clear();
+		ref.clear();
+		if (!same(other, ref)) return false;
+		cmap copy(other);
+		if (!same(copy, ref)) return false;
+	}
+	for (int i = 0; i < 100; i++) map.insert(vmap::value_type(i * 2, counted(i)));
+	if (counted::live != 100) return false;
+	return map.size() == 100 && map.at(198).val == 99 && map.lower_bound(3)->first == 4;
+}
+
+int main() {
+	report(1, "Single-threaded operations against std::map...", test_single());
+	report(2, "Erase through an iterator to a replaced element...", test_stale_iterator());
+	report(3, "Copy constructor and operator = testing...", test_copy());
+	report(4, "Multithreaded insert, erase and assign...", test_threads());
+	report(5, "Ordering by a comparator with state...", test_stateful_order());
+	report(6, "Clear and reuse...", test_clear());
+	return 0;
+}
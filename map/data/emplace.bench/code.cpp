@@ -0,0 +1,81 @@
+// emplace benchmark: constructions, copies and moves of an instrumented IntA-style value per insertion,
+// and the time for 1M insertions of string keys, through operator[], insert, emplace, try_emplace and insert_or_assign
+// usage: ./code [insertions]
+
+#include "map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// counts what happens to it, and carries a heap buffer so that a copy costs like a real payload
+class IntA {
+public:
+    static long long made, copies, moves;
+    int val;
+    std::vector<int> payload;
+    IntA() : val(0), payload(16) { ++made; }
+    IntA(int val) : val(val), payload(16, val) { ++made; }
+    IntA(const IntA &rhs) : val(rhs.val), payload(rhs.payload) { ++copies; }
+    IntA(IntA &&rhs) : val(rhs.val), payload(std::move(rhs.payload)) { ++moves; }
+    IntA &operator=(const IntA &rhs) { val = rhs.val; payload = rhs.payload; ++copies; return *this; }
+    IntA &operator=(IntA &&rhs) { val = rhs.val; payload = std::move(rhs.payload); ++moves; return *this; }
+    static void reset() { made = copies = moves = 0; }
+};
+long long IntA::made, IntA::copies, IntA::moves;
+
+typedef sjtu::map<std::string, IntA> Map;
+
+template<class F>
+long long bench(const char *name, const std::vector<std::string> &keys, F f) {
+    Map map;
+    IntA::reset();
+    double t = timeit([&] {
+        for (size_t i = 0; i < keys.size(); ++i) f(map, keys[i], (int) i);
+    });
+    double n = (double) keys.size();
+    std::printf("%-32s made %4.2f  copies %4.2f  moves %4.2f  per insertion  %8.1f ms\n",
+                name, IntA::made / n, IntA::copies / n, IntA::moves / n, t);
+    long long sum = 0;
+    for (auto it = map.cbegin(); it != map.cend(); ++it) sum += it->second.val;
+    return sum;
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    std::vector<std::string> keys(n);
+    for (int i = 0; i < n; ++i) keys[i] = "key" + std::to_string((i * 2654435761u) % 1000000007u);
+    std::printf("%d insertions of distinct keys\n", n);
+    // an untimed round first, so that every variant runs on the same warm and fragmented heap
+    {
+        Map warm;
+        for (int i = 0; i < n; ++i) warm[keys[i]] = IntA(i);
+    }
+    long long ref = bench("operator[] then assign", keys, [](Map &m, const std::string &k, int i) { m[k] = IntA(i); });
+    long long res[] = {
+        bench("insert(value_type(k, IntA(i)))", keys, [](Map &m, const std::string &k, int i) {
+            m.insert(Map::value_type(k, IntA(i)));
+        }),
+        bench("emplace(k, i)", keys, [](Map &m, const std::string &k, int i) { m.emplace(k, i); }),
+        bench("try_emplace(k, i)", keys, [](Map &m, const std::string &k, int i) { m.try_emplace(k, i); }),
+        bench("insert_or_assign(k, IntA(i))", keys, [](Map &m, const std::string &k, int i) {
+            m.insert_or_assign(k, IntA(i));
+        }),
+    };
+    for (long long r : res)
+        if (r != ref) {
+            std::printf("mismatch\n");
+            return 1;
+        }
+    return 0;
+}
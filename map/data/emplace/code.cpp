@@ -0,0 +1,188 @@
+// correctness of emplace, try_emplace and insert_or_assign of map: how many times a mapped value
+// is constructed, copied and moved, the results against std::map, and a constructor that throws
+#include "map.hpp"
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+void report(int id, const char *title, bool ok) {
+	printf("Test %d: %-55s%s\n", id, title, ok ? "PASSED" : "FAILED");
+}
+
+// counts what happens to it, and its constructor throws on a poisoned value
+struct Tracked {
+	static int made, copies, moves, assigns, live;
+	int val;
+	std::string tag;
+	Tracked() : val(0) {
+		made++;
+		live++;
+	}
+	Tracked(int val, const char *tag = "") : val(val), tag(tag) {
+		if (val < 0) throw std::runtime_error("poisoned");
+		made++;
+		live++;
+	}
+	Tracked(const Tracked &rhs) : val(rhs.val), tag(rhs.tag) {
+		copies++;
+		live++;
+	}
+	Tracked(Tracked &&rhs) : val(rhs.val), tag(std::move(rhs.tag)) {
+		moves++;
+		live++;
+	}
+	Tracked &operator=(const Tracked &rhs) {
+		val = rhs.val;
+		tag = rhs.tag;
+		assigns++;
+		return *this;
+	}
+	Tracked &operator=(Tracked &&rhs) {
+		val = rhs.val;
+		tag = std::move(rhs.tag);
+		assigns++;
+		return *this;
+	}
+	~Tracked() {
+		live--;
+	}
+};
+
+int Tracked::made = 0, Tracked::copies = 0, Tracked::moves = 0, Tracked::assigns = 0, Tracked::live = 0;
+
+typedef sjtu::map<std::string, Tracked> tmap;
+
+bool counted(int made, int copies, int moves, int assigns) {
+	bool ok = Tracked::made == made && Tracked::copies == copies && Tracked::moves == moves && Tracked::assigns == assigns;
+	Tracked::made = Tracked::copies = Tracked::moves = Tracked::assigns = 0;
+	return ok;
+}
+
+// every way in builds the mapped value once, or not at all if the key is there
+bool test_constructions() {
+	{
+		tmap map;
+		counted(0, 0, 0, 0);
+		map["a"];
+		if (!counted(1, 0, 0, 0)) return false;
+		map["a"].val = 5;
+		if (!counted(0, 0, 0, 0)) return false;
+		sjtu::pair<tmap::iterator, bool> r = map.try_emplace("b", 7, "seven");
+		if (!r.second || r.first->second.tag != "seven" || !counted(1, 0, 0, 0)) return false;
+		sjtu::pair<tmap::iterator, bool> s = map.try_emplace("b", 8);
+		if (s.second || s.first->second.val != 7 || !counted(0, 0, 0, 0)) return false;
+		Tracked value(3);
+		counted(0, 0, 0, 0);
+		map.insert_or_assign("c", value);
+		if (!counted(0, 1, 0, 0)) return false;
+		map.insert_or_assign("c", std::move(value));
+		if (map.at("c").val != 3 || !counted(0, 0, 0, 1)) return false;
+		map.emplace(std::piecewise_construct, std::forward_as_tuple("d"), std::forward_as_tuple(9, "nine"));
+		if (map.at("d").tag != "nine" || !counted(1, 0, 0, 0)) return false;
+		map.emplace("e", Tracked(4));
+		if (!counted(1, 0, 1, 0)) return false;
+		std::string key = "f";
+		map[std::move(key)];
+		if (!counted(1, 0, 0, 0)) return false;
+		// a key that exists: nothing is moved from
+		std::string again = "a";
+		Tracked kept(1, "kept");
+		counted(0, 0, 0, 0);
+		map.try_emplace(std::move(again), std::move(kept));
+		if (again != "a" || kept.tag != "kept" || map.at("a").val != 5 || !counted(0, 0, 0, 0)) return false;
+		if (map.size() != 6) return false;
+	}
+	return Tracked::live == 0;
+}
+
+// the forwarding constructors of pair move what they are given
+bool test_pair() {
+	counted(0, 0, 0, 0);
+	sjtu::pair<std::string, Tracked> p(std::string("k"), Tracked(1));
+	if (!counted(1, 0, 1, 0)) return false;
+	sjtu::pair<std::string, Tracked> q(std::move(p));
+	if (!counted(0, 0, 1, 0)) return false;
+	sjtu::pair<const std::string, Tracked> r(std::move(q));
+	if (!counted(0, 0, 1, 0)) return false;
+	sjtu::pair<const std::string, Tracked> s(r);
+	return counted(0, 1, 0, 0) && s.first == "k" && s.second.val == 1;
+}
+
+// the return values and the contents against std::map under a random mix of the calls
+bool test_random() {
+	std::mt19937 rng(48);
+	sjtu::map<int, std::string> map;
+	std::map<int, std::string> ref;
+	for (int op = 0; op < 30000; op++) {
+		int key = (int)(rng() % 3000);
+		std::string val = std::to_string(op);
+		switch (rng() % 4) {
+		case 0: {
+			sjtu::pair<sjtu::map<int, std::string>::iterator, bool> r = map.emplace(key, val);
+			std::pair<std::map<int, std::string>::iterator, bool> s = ref.emplace(key, val);
+			if (r.second != s.second || r.first->second != s.first->second) return false;
+			break;
+		}
+		case 1: {
+			sjtu::pair<sjtu::map<int, std::string>::iterator, bool> r = map.try_emplace(key, 3, 'x');
+			std::pair<std::map<int, std::string>::iterator, bool> s = ref.try_emplace(key, 3, 'x');
+			if (r.second != s.second || r.first->second != s.first->second) return false;
+			break;
+		}
+		case 2: {
+			sjtu::pair<sjtu::map<int, std::string>::iterator, bool> r = map.insert_or_assign(key, val);
+			std::pair<std::map<int, std::string>::iterator, bool> s = ref.insert_or_assign(key, val);
+			if (r.second != s.second || r.first->second != val) return false;
+			break;
+		}
+		default:
+			if (ref.count(key)) {
+				map.erase(map.find(key));
+				ref.erase(key);
+			}
+		}
+	}
+	if (map.size() != ref.size()) return false;
+	sjtu::map<int, std::string>::const_iterator it = map.cbegin();
+	for (std::map<int, std::string>::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+		if (it->first != jt->first || it->second != jt->second) return false;
+	}
+	return true;
+}
+
+// a throwing constructor leaves the map as it was and leaks nothing
+bool test_throwing_constructor() {
+	{
+		tmap map;
+		for (int i = 0; i < 100; i++) map.try_emplace(std::to_string(i), i);
+		try {
+			map.try_emplace("new", -1);
+			return false;
+		} catch (std::runtime_error &) {}
+		try {
+			map.emplace(std::piecewise_construct, std::forward_as_tuple("new"), std::forward_as_tuple(-1));
+			return false;
+		} catch (std::runtime_error &) {}
+		try {
+			map.insert_or_assign("new", Tracked(-1));
+			return false;
+		} catch (std::runtime_error &) {}
+		if (map.size() != 100 || map.count("new") || map.end() - map.begin() != 100) return false;
+		map.try_emplace("new", 1);
+		if (map.size() != 101 || map.at("new").val != 1) return false;
+	}
+	return Tracked::live == 0;
+}
+
+int main() {
+	report(1, "Mapped values built once in place...", test_constructions());
+	report(2, "Forwarding constructors of pair...", test_pair());
+	report(3, "Random emplace, try_emplace and insert_or_assign...", test_random());
+	report(4, "Constructors that throw...", test_throwing_constructor());
+	return 0;
+}
@@ -0,0 +1,56 @@
+// frozen map benchmark: random lookups on int keys from cache-resident to DRAM-resident sizes,
+// sjtu::map against frozen_map with single and batched lookups
+// usage: ./code [lookups] [largest size]
+
+#include "map.hpp"
+#include "frozen_map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int q = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int largest = argc > 2 ? std::atoi(argv[2]) : 4000000;
+    std::mt19937 gen(2024);
+    std::printf("%d random lookups, half of them hits, ns per lookup\n", q);
+    for (int n = 1000; n <= largest; n *= 4) {
+        sjtu::map<int, int> map;
+        std::vector<sjtu::pair<int, int>> sorted;
+        for (int i = 0; i < n; ++i) sorted.push_back(sjtu::pair<int, int>(2 * i, i));
+        map.assign(sorted.begin(), sorted.end());
+        sjtu::frozen_map<int, int> frozen(map);
+        std::vector<int> queries(q);
+        for (int i = 0; i < q; ++i) queries[i] = gen() % (2 * n);
+
+        long long found[3] = {0, 0, 0};
+        double t[3];
+        t[0] = timeit([&] {
+            for (int i = 0; i < q; ++i) found[0] += map.count(queries[i]);
+        });
+        t[1] = timeit([&] {
+            for (int i = 0; i < q; ++i) found[1] += frozen.count(queries[i]);
+        });
+        std::vector<sjtu::frozen_map<int, int>::const_iterator> res(q);
+        t[2] = timeit([&] {
+            frozen.find_batch(queries.begin(), queries.end(), res.begin());
+            for (int i = 0; i < q; ++i) found[2] += res[i] != frozen.end();
+        });
+        std::printf("%9d keys: sjtu::map %7.1f  frozen_map %7.1f  find_batch %7.1f\n",
+                    n, t[0] * 1e6 / q, t[1] * 1e6 / q, t[2] * 1e6 / q);
+        if (found[0] != found[1] || found[0] != found[2]) {
+            std::printf("mismatch\n");
+            return 1;
+        }
+    }
+    return 0;
+}
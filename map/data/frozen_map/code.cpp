@@ -0,0 +1,155 @@
+// correctness of frozen_map against std::map: lookups, bounds and batched lookups
+// on sizes around the levels of the Eytzinger layout
+#include "frozen_map.hpp"
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef sjtu::frozen_map<int, std::string> fmap;
+
+void report(int id, const char *title, bool ok) {
+	printf("Test %d: %-55s%s\n", id, title, ok ? "PASSED" : "FAILED");
+}
+
+// orders ascending or descending, so a map that default-constructs its comparator gets the order wrong
+struct ordered {
+	bool descending;
+	explicit ordered(bool descending) : descending(descending) {}
+	bool operator()(int a, int b) const {
+		return descending ? b < a : a < b;
+	}
+};
+
+template<class Map>
+bool in_order(const Map &map, const std::map<int, int, ordered> &ref) {
+	typename Map::const_iterator it = map.cbegin();
+	for (std::map<int, int, ordered>::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+		if (it == map.cend() || it->first != jt->first || it->second != jt->second || map.count(jt->first) != 1) return false;
+	}
+	return it == map.cend() && map.size() == ref.size();
+}
+
+const int sizes[] = {0, 1, 2, 3, 7, 8, 15, 16, 17, 31, 100, 255, 256, 1000, 4097};
+
+bool check(const fmap &map, const std::map<int, std::string> &ref, int range) {
+	if (map.size() != ref.size() || map.empty() != ref.empty()) return false;
+	fmap::const_iterator it = map.cbegin();
+	for (std::map<int, std::string>::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+		if (it == map.cend() || it->first != jt->first || it->second != jt->second) return false;
+	}
+	if (it != map.cend()) return false;
+	for (std::map<int, std::string>::const_reverse_iterator jt = ref.rbegin(); jt != ref.rend(); ++jt) {
+		--it;
+		if (it->first != jt->first) return false;
+	}
+	std::vector<int> queries;
+	for (int q = -3; q <= range + 3; q++) queries.push_back(q);
+	std::vector<fmap::const_iterator> found(queries.size());
+	map.find_batch(queries.begin(), queries.end(), found.begin());
+	for (size_t i = 0; i < queries.size(); i++) {
+		int q = queries[i];
+		std::map<int, std::string>::const_iterator lo = ref.lower_bound(q), up = ref.upper_bound(q);
+		fmap::const_iterator a = map.lower_bound(q), b = map.upper_bound(q), f = map.find(q);
+		if ((lo == ref.end()) != (a == map.cend()) || (lo != ref.end() && a->first != lo->first)) return false;
+		if ((up == ref.end()) != (b == map.cend()) || (up != ref.end() && b->first != up->first)) return false;
+		if (map.count(q) != ref.count(q) || f != found[i]) return false;
+		if (ref.count(q) && (f->second != ref.at(q) || map.at(q) != ref.at(q) || map[q] != ref.at(q))) return false;
+	}
+	return true;
+}
+
+bool test_lookups() {
+	std::mt19937 rng(44);
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		int n = sizes[s];
+		sjtu::map<int, std::string> src;
+		std::map<int, std::string> ref;
+		for (int i = 0; i < n; i++) {
+			int key = (int)(rng() % (3 * n + 1)) * 2;
+			src[key] = std::to_string(key);
+			ref[key] = std::to_string(key);
+		}
+		fmap map(src);
+		if (!check(map, ref, 6 * n)) return false;
+	}
+	return true;
+}
+
+bool test_copy_and_range() {
+	std::mt19937 rng(45);
+	std::vector<sjtu::pair<int, std::string>> elems;
+	std::map<int, std::string> ref;
+	for (int i = 0; i < 3000; i++) {
+		int key = (int)(rng() % 2000);
+		elems.push_back(sjtu::pair<int, std::string>(key, std::to_string(i)));
+		// a repeated key keeps its first element
+		ref.insert(std::make_pair(key, std::to_string(i)));
+	}
+	fmap map(elems.begin(), elems.end()), copy(map), other;
+	other = copy;
+	other = other;
+	if (!check(map, ref, 2000) || !check(copy, ref, 2000) || !check(other, ref, 2000)) return false;
+	fmap::const_iterator it = other.find(ref.begin()->first), jt;
+	jt = it;
+	return jt == other.cbegin() && jt != map.cbegin();
+}
+
+bool test_errors() {
+	std::vector<sjtu::pair<int, std::string>> elems(1, sjtu::pair<int, std::string>(1, "one"));
+	fmap empty, map(elems.begin(), elems.end());
+	try {
+		map.at(0);
+		return false;
+	} catch (sjtu::index_out_of_bound &) {}
+	try {
+		fmap::const_iterator it = map.cend();
+		++it;
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		fmap::const_iterator it = map.cbegin();
+		--it;
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		*empty.cbegin();
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	return true;
+}
+
+// the comparator has state, so freezing a map, a range, a copy or an assignment has to keep it
+bool test_stateful_order() {
+	typedef sjtu::frozen_map<int, int, ordered> omap;
+	std::mt19937 rng(49);
+	sjtu::map<int, int, ordered> src(ordered(true));
+	std::vector<sjtu::pair<int, int>> elems;
+	std::map<int, int, ordered> ref(ordered(true));
+	for (int i = 0; i < 3000; i++) {
+		int key = (int)(rng() % 2000);
+		src.insert(sjtu::map<int, int, ordered>::value_type(key, i));
+		elems.push_back(sjtu::pair<int, int>(key, i));
+		ref.insert(std::make_pair(key, i));
+	}
+	omap map(src), range(elems.begin(), elems.end(), ordered(true)), copy(map), other(ordered(false));
+	other = range;
+	for (int key = -3; key <= 2003; key++) {
+		omap::const_iterator lo = map.lower_bound(key), hi = other.upper_bound(key);
+		std::map<int, int, ordered>::const_iterator lr = ref.lower_bound(key), hr = ref.upper_bound(key);
+		if ((lo == map.cend()) != (lr == ref.end()) || (lo != map.cend() && lo->first != lr->first)) return false;
+		if ((hi == other.cend()) != (hr == ref.end()) || (hi != other.cend() && hi->first != hr->first)) return false;
+	}
+	return in_order(map, ref) && in_order(range, ref) && in_order(copy, ref) && in_order(other, ref) &&
+		other.key_comp().descending;
+}
+
+int main() {
+	report(1, "Lookups and bounds on every tree shape...", test_lookups());
+	report(2, "Range constructor, copy and assignment...", test_copy_and_range());
+	report(3, "Exceptions...", test_errors());
+	report(4, "Ordering by a comparator with state...", test_stateful_order());
+	return 0;
+}
@@ -0,0 +1,56 @@
+// full-scan benchmark: forward and backward iteration over 10M entries of sjtu::map and std::map,
+// plus repeated begin() calls
+// usage: ./code [entries]
+
+#include "map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    std::mt19937_64 rng(20230701);
+    sjtu::map<long long, long long> map;
+    std::map<long long, long long> std_map;
+    for (int i = 0; i < n; ++i) {
+        long long key = (long long) (rng() >> 1);
+        map[key] = i;
+        std_map[key] = i;
+    }
+
+    long long sum[4] = {0, 0, 0, 0};
+    std::printf("%zu entries\n", map.size());
+    std::printf("sjtu::map forward  : %8.1f ms\n", timeit([&] {
+        for (sjtu::map<long long, long long>::const_iterator it = map.cbegin(); it != map.cend(); ++it) sum[0] += it->second;
+    }));
+    std::printf("std::map forward   : %8.1f ms\n", timeit([&] {
+        for (std::map<long long, long long>::const_iterator it = std_map.cbegin(); it != std_map.cend(); ++it) sum[1] += it->second;
+    }));
+    std::printf("sjtu::map backward : %8.1f ms\n", timeit([&] {
+        sjtu::map<long long, long long>::iterator it = map.end();
+        while (it != map.begin()) sum[2] += (--it)->second;
+    }));
+    std::printf("std::map backward  : %8.1f ms\n", timeit([&] {
+        std::map<long long, long long>::iterator it = std_map.end();
+        while (it != std_map.begin()) sum[3] += (--it)->second;
+    }));
+    long long first = 0;
+    std::printf("1M x begin()       : %8.1f ms\n", timeit([&] {
+        for (int i = 0; i < 1000000; ++i) first += map.begin()->first;
+    }));
+    if (sum[0] != sum[1] || sum[2] != sum[3] || sum[0] != sum[2] || first != std_map.begin()->first * 1000000) {
+        std::printf("mismatch\n");
+        return 1;
+    }
+    return 0;
+}
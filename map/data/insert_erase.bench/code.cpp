@@ -0,0 +1,85 @@
+// insert / erase benchmark with Bint keys: 1M insert and erase cycles on sjtu::map and std::map
+// usage: ./code [cycles] [live_keys]
+
+#include "class-bint.hpp"
+#include "map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <random>
+#include <vector>
+
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+    ++allocations;
+    if (void *p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int cycles = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int live = argc > 2 ? std::atoi(argv[2]) : 100000;
+    std::mt19937_64 rng(20230501);
+    std::vector<Util::Bint> keys;
+    for (int i = 0; i < live + cycles; ++i) keys.push_back(Util::Bint((long long) (rng() >> 2)) * Util::Bint((long long) (rng() >> 2)));
+
+    sjtu::map<Util::Bint, int> map;
+    std::map<Util::Bint, int> std_map;
+    for (int i = 0; i < live; ++i) {
+        map.insert(sjtu::pair<const Util::Bint, int>(keys[i], i));
+        std_map.insert(std::make_pair(keys[i], i));
+    }
+
+    // every cycle inserts a new key and erases the oldest live one
+    size_t erase_allocations = 0;
+    double t_map = timeit([&] {
+        for (int i = 0; i < cycles; ++i) {
+            map.insert(sjtu::pair<const Util::Bint, int>(keys[live + i], live + i));
+            auto it = map.find(keys[i]);
+            size_t before = allocations;
+            map.erase(it);
+            erase_allocations += allocations - before;
+        }
+    });
+    double t_std = timeit([&] {
+        for (int i = 0; i < cycles; ++i) {
+            std_map.insert(std::make_pair(keys[live + i], live + i));
+            std_map.erase(std_map.find(keys[i]));
+        }
+    });
+
+    if (map.size() != std_map.size()) {
+        std::printf("WRONG ANSWER: size\n");
+        return 1;
+    }
+    auto jt = std_map.begin();
+    for (auto it = map.cbegin(); it != map.cend(); ++it, ++jt)
+        if (it->second != jt->second) {
+            std::printf("WRONG ANSWER: content\n");
+            return 1;
+        }
+
+    std::printf("%d insert/erase cycles, %d live Bint keys\n", cycles, live);
+    std::printf("sjtu::map %10.2f ms   std::map %10.2f ms\n", t_map, t_std);
+    std::printf("allocations during sjtu::map::erase: %zu\n", erase_allocations);
+    return 0;
+}
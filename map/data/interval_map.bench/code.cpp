@@ -0,0 +1,86 @@
+// interval map benchmark: 1M time ranges, then stabbing and range overlap queries,
+// interval_map against a full scan of a sjtu::map keyed by start
+// usage: ./code [intervals] [queries] [scanned queries]
+
+#include "map.hpp"
+#include "interval_map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+typedef sjtu::interval_map<long long, int> imap;
+typedef sjtu::map<sjtu::pair<long long, long long>, int, sjtu::interval_less<long long, std::less<long long>>> plain_map;
+typedef sjtu::pair<long long, long long> interval;
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int q = argc > 2 ? std::atoi(argv[2]) : 100000;
+    int scanned = argc > 3 ? std::atoi(argv[3]) : 50;
+    const long long horizon = 1000000000;
+    std::mt19937_64 gen(2024);
+    // mostly short ranges and a few long ones, like sessions and jobs on a time line
+    std::vector<interval> ranges;
+    for (int i = 0; i < n; ++i) {
+        long long start = gen() % horizon;
+        long long len = gen() % 100 ? 1 + gen() % 10000 : 1 + gen() % 10000000;
+        ranges.push_back(interval(start, start + len));
+    }
+    std::vector<long long> points(q);
+    for (int i = 0; i < q; ++i) points[i] = gen() % horizon;
+
+    imap tree;
+    plain_map plain;
+    double build = timeit([&] {
+        for (int i = 0; i < n; ++i) tree.insert(imap::value_type(ranges[i], i));
+    });
+    double build_plain = timeit([&] {
+        for (int i = 0; i < n; ++i) plain.insert(plain_map::value_type(ranges[i], i));
+    });
+    std::printf("%d intervals: insert %.1f ms into interval_map, %.1f ms into sjtu::map\n", n, build, build_plain);
+
+    int res = 0;
+    const long long widths[] = {0, 1000, 100000, 10000000};
+    for (long long width : widths) {
+        long long hits = 0, scan_hits = 0;
+        double query = timeit([&] {
+            for (int i = 0; i < q; ++i) {
+                auto f = [&](const imap::value_type &) { ++hits; };
+                if (width) tree.overlap(points[i], points[i] + width, f);
+                else tree.stab(points[i], f);
+            }
+        });
+        long long tree_check = 0, hits_scanned = 0;
+        for (int i = 0; i < scanned; ++i) {
+            auto f = [&](const imap::value_type &v) { ++hits_scanned; tree_check += v.second; };
+            if (width) tree.overlap(points[i], points[i] + width, f);
+            else tree.stab(points[i], f);
+        }
+        double scan = timeit([&] {
+            for (int i = 0; i < scanned; ++i) {
+                long long lo = points[i], hi = width ? points[i] + width : points[i] + 1;
+                for (auto it = plain.cbegin(); it != plain.cend(); ++it)
+                    if (it->first.first < hi && lo < it->first.second) {
+                        ++scan_hits;
+                        tree_check -= it->second;
+                    }
+            }
+        });
+        std::printf("width %9lld: interval_map %8.3f us/query (%.1f hits)   full scan %10.1f us/query\n",
+                    width, query * 1000 / q, (double) hits / q, scan * 1000 / scanned);
+        if (scan_hits != hits_scanned || tree_check != 0) {
+            std::printf("mismatch\n");
+            res = 1;
+        }
+    }
+    return res;
+}
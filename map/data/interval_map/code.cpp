@@ -0,0 +1,127 @@
+// correctness of interval_map against a full scan: overlap, stab and overlaps under random
+// insertions and erasures, with the default order and with a comparator that carries state
+#include "interval_map.hpp"
+#include "parallel.hpp"
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+void report(int id, const char *title, bool ok) {
+	printf("Test %d: %-55s%s\n", id, title, ok ? "PASSED" : "FAILED");
+}
+
+// ascending or descending, chosen at run time, no default constructor
+struct ordered {
+	bool descending;
+	explicit ordered(bool descending) : descending(descending) {}
+	bool operator()(int a, int b) const {
+		return descending ? b < a : a < b;
+	}
+};
+
+template<class Compare>
+struct pair_less {
+	Compare less;
+	explicit pair_less(const Compare &less) : less(less) {}
+	bool operator()(const std::pair<int, int> &a, const std::pair<int, int> &b) const {
+		if (less(a.first, b.first)) return true;
+		if (less(b.first, a.first)) return false;
+		return less(a.second, b.second);
+	}
+};
+
+template<class Compare>
+bool run(sjtu::interval_map<int, int, Compare> &map, const Compare &less, int sign, int range, int max_len, unsigned seed) {
+	typedef sjtu::interval_map<int, int, Compare> imap;
+	typedef std::map<std::pair<int, int>, int, pair_less<Compare>> smap;
+	typedef std::vector<std::pair<int, int>> list;
+	std::mt19937 rng(seed);
+	smap ref((pair_less<Compare>(less)));
+	for (int op = 0; op < 20000; op++) {
+		int lo = (int)(rng() % range), hi = lo + 1 + (int)(rng() % max_len);
+		typename imap::interval_type x(sign * lo, sign * hi);
+		switch (rng() % 6) {
+		case 0:
+		case 1: {
+			bool inserted = map.insert(typename imap::value_type(x, op)).second;
+			if (inserted != ref.insert(std::make_pair(std::make_pair(x.first, x.second), op)).second) return false;
+			break;
+		}
+		case 2: {
+			typename smap::iterator it = ref.lower_bound(std::make_pair(x.first, x.first));
+			if (it == ref.end()) break;
+			map.erase(map.find(typename imap::interval_type(it->first.first, it->first.second)));
+			ref.erase(it);
+			break;
+		}
+		default: {
+			int qlo = sign * (int)(rng() % range), qhi = qlo + sign * (int)(rng() % (range / 20 + 1));
+			list got, expected, stabbed, stab_expected;
+			map.overlap(qlo, qhi, [&](const typename imap::value_type &v) { got.push_back(std::make_pair(v.first.first, v.first.second)); });
+			map.stab(qlo, [&](const typename imap::value_type &v) { stabbed.push_back(std::make_pair(v.first.first, v.first.second)); });
+			for (typename smap::iterator it = ref.begin(); it != ref.end(); ++it) {
+				const std::pair<int, int> &y = it->first;
+				if (less(y.first, qhi) && less(qlo, y.second)) expected.push_back(y);
+				if (!less(qlo, y.first) && less(qlo, y.second)) stab_expected.push_back(y);
+			}
+			if (got != expected || stabbed != stab_expected || map.overlaps(qlo, qhi) != !expected.empty()) return false;
+		}
+		}
+		if (op % 10007 == 0) {
+			// copies keep the comparator and the augmentation
+			imap copy(map);
+			map.clear();
+			map = copy;
+		}
+	}
+	if (map.size() != ref.size()) return false;
+	typename smap::iterator it = ref.begin();
+	for (typename imap::const_iterator jt = map.cbegin(); jt != map.cend(); ++jt, ++it) {
+		if (jt->first.first != it->first.first || jt->first.second != it->first.second || jt->second != it->second) return false;
+	}
+	return true;
+}
+
+bool test_default_order() {
+	sjtu::interval_map<int, int> dense, sparse;
+	return run(dense, std::less<int>(), 1, 300, 40, 1) && run(sparse, std::less<int>(), 1, 100000, 5000, 2);
+}
+
+bool test_stateful_order() {
+	sjtu::interval_map<int, int, ordered> up(ordered(false)), down(ordered(true));
+	return run(up, ordered(false), 1, 2000, 100, 3) && run(down, ordered(true), -1, 2000, 100, 4) &&
+		!down.key_comp().end_less()(1, 2);
+}
+
+bool test_set_operations() {
+	std::mt19937 rng(5);
+	sjtu::interval_map<int, int, ordered> map(ordered(true)), other(ordered(true));
+	for (int i = 0; i < 3000; i++) {
+		int lo = (int)(rng() % 10000);
+		map.insert(sjtu::interval_map<int, int, ordered>::value_type(sjtu::pair<int, int>(-lo, -lo - 1 - (int)(rng() % 50)), i));
+		lo = (int)(rng() % 10000);
+		other.insert(sjtu::interval_map<int, int, ordered>::value_type(sjtu::pair<int, int>(-lo, -lo - 1 - (int)(rng() % 500)), i));
+	}
+	// the augmentation is rebuilt by the joins of the set operations
+	map.union_with(other, 2);
+	ordered less(true);
+	for (int q = 0; q < 2000; q++) {
+		int p = -(int)(rng() % 10600);
+		std::vector<std::pair<int, int>> got, expected;
+		map.stab(p, [&](const sjtu::interval_map<int, int, ordered>::value_type &v) { got.push_back(std::make_pair(v.first.first, v.first.second)); });
+		for (sjtu::interval_map<int, int, ordered>::const_iterator it = map.cbegin(); it != map.cend(); ++it) {
+			if (!less(p, it->first.first) && less(p, it->first.second)) expected.push_back(std::make_pair(it->first.first, it->first.second));
+		}
+		if (got != expected) return false;
+	}
+	return true;
+}
+
+int main() {
+	report(1, "Queries under the default order...", test_default_order());
+	report(2, "Queries under a comparator with state...", test_stateful_order());
+	report(3, "Queries after set operations...", test_set_operations());
+	return 0;
+}
@@ -0,0 +1,74 @@
+// lsm map benchmark: ingest of random int keys (blind put and checked insert), then random lookups,
+// lower_bound and a full scan, lsm_map against sjtu::map
+// usage: ./code [entries] [lookups]
+
+#include "map.hpp"
+#include "lsm_map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+typedef sjtu::pair<const int, int> value_type;
+
+template<class Map, class Ingest>
+long long reads(const char *name, int n, const std::vector<int> &queries, Ingest ingest) {
+    Map *map = new Map;
+    double build = timeit([&] { ingest(*map); });
+    long long found = 0, bounded = 0, sum = 0;
+    double find = timeit([&] {
+        for (size_t i = 0; i < queries.size(); ++i) found += map->count(queries[i]);
+    });
+    double bound = timeit([&] {
+        for (size_t i = 0; i < queries.size(); ++i) bounded += map->lower_bound(queries[i]) != map->end();
+    });
+    double scan = timeit([&] {
+        for (auto it = map->begin(); it != map->end(); ++it) sum += it->second;
+    });
+    std::printf("%-20s ingest %8.1f ms (%5.2f M/s)  find %7.1f ms  lower_bound %7.1f ms  scan %6.1f ms\n",
+                name, build, n / build / 1000, find, bound, scan);
+    delete map;
+    return found * 1000003 + bounded * 1009 + sum;
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int q = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    std::mt19937 gen(2024);
+    std::vector<int> keys(n), queries(q);
+    for (int i = 0; i < n; ++i) keys[i] = gen() % (4 * n);
+    for (int i = 0; i < q; ++i) queries[i] = gen() % (4 * n);
+    std::printf("%d inserts, %d lookups\n", n, q);
+
+    // a repeated key keeps its first value with insert and its last with put
+    long long a = reads<sjtu::map<int, int>>("sjtu::map insert", n, queries, [&](sjtu::map<int, int> &m) {
+        for (int i = 0; i < n; ++i) m.insert(value_type(keys[i], i));
+    });
+    long long b = reads<sjtu::lsm_map<int, int>>("lsm_map insert", n, queries, [&](sjtu::lsm_map<int, int> &m) {
+        for (int i = 0; i < n; ++i) m.insert(value_type(keys[i], i));
+    });
+    long long c = reads<sjtu::map<int, int>>("sjtu::map operator[]", n, queries, [&](sjtu::map<int, int> &m) {
+        for (int i = 0; i < n; ++i) m[keys[i]] = i;
+    });
+    long long d = reads<sjtu::lsm_map<int, int>>("lsm_map put", n, queries, [&](sjtu::lsm_map<int, int> &m) {
+        for (int i = 0; i < n; ++i) m.put(value_type(keys[i], i));
+    });
+    long long e = reads<sjtu::lsm_map<int, int>>("lsm_map put+compact", n, queries, [&](sjtu::lsm_map<int, int> &m) {
+        for (int i = 0; i < n; ++i) m.put(value_type(keys[i], i));
+        m.compact();
+    });
+    if (a != b || c != d || c != e) {
+        std::printf("mismatch\n");
+        return 1;
+    }
+    return 0;
+}
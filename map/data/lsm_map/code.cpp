@@ -0,0 +1,261 @@
+// correctness of lsm_map against std::map: tombstones shadowing entries in older runs,
+// iteration in both directions right after blind puts and removes, and compaction
+#include "lsm_map.hpp"
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef sjtu::lsm_map<int, std::string> lmap;
+typedef std::map<int, std::string> smap;
+
+void report(int id, const char *title, bool ok) {
+	printf("Test %d: %-55s%s\n", id, title, ok ? "PASSED" : "FAILED");
+}
+
+// orders ascending or descending, so a map that default-constructs its comparator gets the order wrong
+struct ordered {
+	bool descending;
+	explicit ordered(bool descending) : descending(descending) {}
+	bool operator()(int a, int b) const {
+		return descending ? b < a : a < b;
+	}
+};
+
+template<class Map>
+bool in_order(const Map &map, const std::map<int, int, ordered> &ref) {
+	typename Map::const_iterator it = map.cbegin();
+	for (std::map<int, int, ordered>::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+		if (it == map.cend() || it->first != jt->first || it->second != jt->second || map.count(jt->first) != 1) return false;
+	}
+	return it == map.cend() && map.size() == ref.size();
+}
+
+// walks the map before size() is asked, which counts with a scan of its own after a blind write
+bool same(lmap &map, const smap &ref) {
+	lmap::const_iterator it = map.cbegin();
+	for (smap::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+		if (it == map.cend() || it->first != jt->first || it->second != jt->second) return false;
+	}
+	if (it != map.cend()) return false;
+	lmap::iterator kt = map.end();
+	for (smap::const_reverse_iterator jt = ref.rbegin(); jt != ref.rend(); ++jt) {
+		--kt;
+		if (kt->first != jt->first || kt->second != jt->second) return false;
+	}
+	if (kt != map.begin()) return false;
+	return map.size() == ref.size() && map.empty() == ref.empty();
+}
+
+bool lookups(const lmap &map, const smap &ref, int key) {
+	smap::const_iterator lo = ref.lower_bound(key), up = ref.upper_bound(key);
+	lmap::const_iterator a = map.lower_bound(key), b = map.upper_bound(key), f = map.find(key);
+	if ((lo == ref.end()) != (a == map.cend()) || (lo != ref.end() && a->first != lo->first)) return false;
+	if ((up == ref.end()) != (b == map.cend()) || (up != ref.end() && b->first != up->first)) return false;
+	if ((f == map.cend()) != !ref.count(key) || map.count(key) != ref.count(key)) return false;
+	return !ref.count(key) || (f->second == ref.at(key) && map.at(key) == ref.at(key));
+}
+
+std::string value_of(int x) {
+	return "v" + std::to_string(x);
+}
+
+bool test_tombstones() {
+	const int n = 20000;
+	lmap map;
+	smap ref;
+	for (int i = 0; i < n; i++) {
+		map.insert(lmap::value_type(i, value_of(i)));
+		ref[i] = value_of(i);
+	}
+	// the erased keys sit in old runs, their tombstones in the buffer and in young runs
+	for (int i = 0; i < n; i += 2) {
+		if (map.erase(i) != 1 || map.erase(i) != 0) return false;
+		ref.erase(i);
+		if (i % 1000 == 0 && !lookups(map, ref, i)) return false;
+	}
+	for (int i = 0; i < n; i += 3) {
+		if (!lookups(map, ref, i) || !lookups(map, ref, i + 1)) return false;
+	}
+	if (!same(map, ref)) return false;
+	// bring back some of them, the new entries shadow their own tombstones
+	for (int i = 0; i < n; i += 6) {
+		if (!map.insert(lmap::value_type(i, value_of(-i))).second) return false;
+		ref[i] = value_of(-i);
+	}
+	for (int i = 0; i < n; i += 7) {
+		if (ref.count(i)) {
+			map.erase(map.find(i));
+			ref.erase(i);
+		}
+		map[i + 1] += "!";
+		ref[i + 1] += "!";
+	}
+	for (int i = -1; i <= n; i += 5) {
+		if (!lookups(map, ref, i)) return false;
+	}
+	return same(map, ref);
+}
+
+bool test_blind_writes() {
+	std::mt19937 rng(46);
+	lmap map;
+	smap ref;
+	for (int round = 0; round < 40; round++) {
+		for (int op = 0; op < 3000; op++) {
+			int key = (int)(rng() % 8000);
+			if (rng() % 3) {
+				map.put(lmap::value_type(key, value_of(op)));
+				ref[key] = value_of(op);
+			} else {
+				map.remove(key);
+				ref.erase(key);
+			}
+		}
+		// straight after blind writes: walk down from end(), and back from a bound
+		lmap::iterator it = map.end();
+		for (smap::reverse_iterator jt = ref.rbegin(); jt != ref.rend(); ++jt) {
+			--it;
+			if (it->first != jt->first || it->second != jt->second) return false;
+		}
+		int key = (int)(rng() % 8000);
+		lmap::const_iterator lo = map.lower_bound(key);
+		smap::iterator jt = ref.lower_bound(key);
+		for (int step = 0; step < 50 && jt != ref.begin(); step++) {
+			--lo;
+			--jt;
+			if (lo->first != jt->first) return false;
+		}
+		if (round % 4 == 0 && !same(map, ref)) return false;
+	}
+	return same(map, ref);
+}
+
+bool test_compact() {
+	std::mt19937 rng(47);
+	lmap map;
+	smap ref;
+	map.compact();
+	if (!same(map, ref)) return false;
+	for (int round = 0; round < 20; round++) {
+		for (int op = 0; op < 2000; op++) {
+			int key = (int)(rng() % 5000);
+			switch (rng() % 4) {
+			case 0:
+				map.put(lmap::value_type(key, value_of(op)));
+				ref[key] = value_of(op);
+				break;
+			case 1:
+				map.remove(key);
+				ref.erase(key);
+				break;
+			case 2:
+				if (map.insert(lmap::value_type(key, value_of(op))).second != !ref.count(key)) return false;
+				ref.insert(std::make_pair(key, value_of(op)));
+				break;
+			default:
+				if (map.erase(key) != ref.erase(key)) return false;
+			}
+		}
+		map.compact();
+		for (int i = 0; i < 100; i++) {
+			if (!lookups(map, ref, (int)(rng() % 5001) - 1)) return false;
+		}
+		if (!same(map, ref)) return false;
+	}
+	lmap copy(map), other;
+	other = copy;
+	other = other;
+	map.clear();
+	map.compact();
+	return map.empty() && map.begin() == map.end() && same(copy, ref) && same(other, ref);
+}
+
+bool test_errors() {
+	lmap map, other;
+	map.put(lmap::value_type(1, "one"));
+	map.remove(1);
+	try {
+		map.at(1);
+		return false;
+	} catch (sjtu::index_out_of_bound &) {}
+	try {
+		map.erase(map.end());
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	map[2] = "two";
+	try {
+		map.erase(other.begin());
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		lmap::iterator it = map.begin();
+		--it;
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	return map.size() == 1;
+}
+
+// the comparator has state, so the map, its runs, its copies and its assignments have to keep it
+bool test_stateful_order() {
+	typedef sjtu::lsm_map<int, int, ordered> omap;
+	std::mt19937 rng(49);
+	omap map(ordered(true));
+	std::map<int, int, ordered> ref(ordered(true));
+	for (int i = 0; i < 30000; i++) {
+		int key = (int)(rng() % 3000);
+		if (rng() % 3) {
+			map.put(omap::value_type(key, i));
+			ref[key] = i;
+		} else {
+			map.remove(key);
+			ref.erase(key);
+		}
+		if (i % 7 == 0) {
+			omap::const_iterator lo = map.lower_bound(key);
+			std::map<int, int, ordered>::const_iterator lr = ref.lower_bound(key);
+			if ((lo == map.cend()) != (lr == ref.end()) || (lo != map.cend() && lo->first != lr->first)) return false;
+		}
+	}
+	omap copy(map), other(ordered(false));
+	other[1] = 1;
+	other = map;
+	if (!in_order(map, ref) || !in_order(copy, ref) || !in_order(other, ref)) return false;
+	other.compact();
+	return in_order(other, ref) && other.key_comp().descending;
+}
+
+// size() on a const map must not move anything under the iterators walking it
+bool test_size_during_walk() {
+	lmap map;
+	smap ref;
+	for (int i = 0; i < 5000; i++) {
+		map.put(lmap::value_type(i * 7 % 5000, value_of(i)));
+		ref[i * 7 % 5000] = value_of(i);
+	}
+	for (int i = 0; i < 5000; i += 11) {
+		map.remove(i);
+		ref.erase(i);
+	}
+	const lmap &view = map;
+	size_t visited = 0;
+	long long sum = 0, expected = 0;
+	for (lmap::const_iterator it = view.cbegin(); it != view.cend(); ++it) {
+		if (++visited == ref.size() / 2 && view.size() != ref.size()) return false;
+		sum += it->first;
+	}
+	for (smap::const_iterator jt = ref.begin(); jt != ref.end(); ++jt) expected += jt->first;
+	return visited == ref.size() && sum == expected && !view.empty();
+}
+
+int main() {
+	report(1, "Tombstones shadowing older runs...", test_tombstones());
+	report(2, "Iteration after blind put and remove...", test_blind_writes());
+	report(3, "Compaction, copy and assignment...", test_compact());
+	report(4, "Exceptions...", test_errors());
+	report(5, "Ordering by a comparator with state...", test_stateful_order());
+	report(6, "Counting the elements in the middle of a walk...", test_size_during_walk());
+	return 0;
+}
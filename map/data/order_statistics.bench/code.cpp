@@ -0,0 +1,67 @@
+// order statistics benchmark: percentiles with select, rank of keys and iterator distance,
+// against std::next / std::distance on std::map, plus the upkeep cost on insert and erase.
+// the linear std::map baselines run on a thousandth of the queries.
+// build once more with -DSJTU_MAP_ORDER_STATISTICS=0 to measure the map without subtree sizes.
+// usage: ./code [entries] [queries]
+
+#include "map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int queries = argc > 2 ? std::atoi(argv[2]) : 100000;
+    int linear = queries / 1000 > 0 ? queries / 1000 : 1;
+    std::mt19937_64 rng(20230901);
+    std::vector<long long> keys;
+    for (int i = 0; i < n; ++i) keys.push_back((long long) (rng() >> 1));
+
+    sjtu::map<long long, int> map;
+    std::map<long long, int> std_map;
+    std::printf("%d entries, subtree sizes %s\n", n, SJTU_MAP_ORDER_STATISTICS ? "on" : "off");
+    std::printf("sjtu::map insert   : %8.1f ms\n", timeit([&] {
+        for (int i = 0; i < n; ++i) map[keys[i]] = i;
+    }));
+    for (int i = 0; i < n; ++i) std_map[keys[i]] = i;
+
+    // percentiles, ranks of present keys and distances between them
+    long long sum = 0, std_sum = 0, check = 0;
+    std::printf("sjtu::map select   : %8.1f ms (%d queries)\n", timeit([&] {
+        for (int i = 0; i < queries; ++i) sum += map.select(map.size() * (i % 100) / 100)->first;
+    }), queries);
+    std::printf("std::map std::next : %8.1f ms (%d queries)\n", timeit([&] {
+        for (int i = 0; i < linear; ++i) std_sum += std::next(std_map.begin(), std_map.size() * (i % 100) / 100)->first;
+    }), linear);
+    std::printf("sjtu::map rank     : %8.1f ms (%d queries)\n", timeit([&] {
+        for (int i = 0; i < queries; ++i) sum += map.rank(keys[i % n]);
+    }), queries);
+    std::printf("std::map distance  : %8.1f ms (%d queries)\n", timeit([&] {
+        for (int i = 0; i < linear; ++i) std_sum += std::distance(std_map.begin(), std_map.lower_bound(keys[i % n]));
+    }), linear);
+    std::printf("sjtu::map it - it  : %8.1f ms (%d queries)\n", timeit([&] {
+        for (int i = 0; i < queries; ++i) sum += map.find(keys[i % n]) - map.find(keys[(i + 1) % n]);
+    }), queries);
+    for (int i = 0; i < linear; ++i)
+        check += map.select(map.size() * (i % 100) / 100)->first + map.rank(keys[i % n]);
+    std::printf("sjtu::map erase    : %8.1f ms\n", timeit([&] {
+        for (int i = 0; i < n; i += 2) map.erase(map.find(keys[i]));
+    }));
+    if (std_sum != check || sum == 0) {
+        std::printf("mismatch\n");
+        return 1;
+    }
+    return 0;
+}
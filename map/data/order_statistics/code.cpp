@@ -0,0 +1,122 @@
+// correctness of select, rank and iterator distance of map against a sorted copy of the keys,
+// after every kind of update that rebuilds the subtree sizes: rotations, range erase, bulk load and set operations
+#include "map.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+typedef sjtu::map<int, int> imap;
+typedef std::map<int, int> smap;
+
+void report(int id, const char *title, bool ok) {
+	printf("Test %d: %-55s%s\n", id, title, ok ? "PASSED" : "FAILED");
+}
+
+// every index, and the ranks of keys in the map, between its elements and outside it
+bool check(imap &map, const smap &ref) {
+	if (map.size() != ref.size()) return false;
+	const imap &view = map;
+	std::vector<int> keys;
+	for (smap::const_iterator it = ref.begin(); it != ref.end(); ++it) keys.push_back(it->first);
+	for (size_t k = 0; k < keys.size(); k++) {
+		imap::iterator it = map.select(k);
+		if (it->first != keys[k] || view.select(k) != it) return false;
+		if (it - map.begin() != (std::ptrdiff_t) k || map.begin() - it != -(std::ptrdiff_t) k) return false;
+		if (map.end() - it != (std::ptrdiff_t) (keys.size() - k)) return false;
+		if (view.rank(keys[k]) != k || view.rank(keys[k] + 1) != k + 1) return false;
+	}
+	if (map.end() - map.begin() != (std::ptrdiff_t) keys.size() || view.cend() - view.cbegin() != (std::ptrdiff_t) keys.size()) return false;
+	int below = keys.empty() ? 0 : keys.front() - 1, above = keys.empty() ? 0 : keys.back() + 1;
+	return view.rank(below) == 0 && view.rank(above) == keys.size();
+}
+
+bool test_random_updates() {
+	std::mt19937 rng(36);
+	imap map;
+	smap ref;
+	for (int op = 0; op < 30000; op++) {
+		int key = (int)(rng() % 4000) * 3;
+		if (rng() % 3) {
+			map[key] = op;
+			ref[key] = op;
+		} else if (ref.count(key)) {
+			map.erase(map.find(key));
+			ref.erase(key);
+		}
+		if (op % 1999 == 0 && !check(map, ref)) return false;
+		if (!map.empty()) {
+			// distance between two random elements, in both directions
+			size_t a = rng() % map.size(), b = rng() % map.size();
+			if (map.select(a) - map.select(b) != (std::ptrdiff_t) a - (std::ptrdiff_t) b) return false;
+		}
+	}
+	return check(map, ref);
+}
+
+bool test_bulk_updates() {
+	std::mt19937 rng(37);
+	std::vector<sjtu::pair<int, int>> sorted;
+	smap ref;
+	for (int i = 0; i < 5000; i++) {
+		sorted.push_back(sjtu::pair<int, int>(i * 2, i));
+		ref[i * 2] = i;
+	}
+	imap map(sorted.begin(), sorted.end());
+	if (!check(map, ref)) return false;
+	map.erase(map.lower_bound(1000), map.lower_bound(7000));
+	ref.erase(ref.lower_bound(1000), ref.lower_bound(7000));
+	if (!check(map, ref)) return false;
+	imap other;
+	smap other_ref;
+	for (int i = 0; i < 3000; i++) {
+		int key = (int)(rng() % 12000);
+		other[key] = -key;
+		other_ref[key] = -key;
+	}
+	map.union_with(other);
+	ref.insert(other_ref.begin(), other_ref.end());
+	if (!check(map, ref)) return false;
+	imap half;
+	for (smap::iterator it = ref.begin(); it != ref.end(); ++it) {
+		if (rng() % 2) half[it->first] = 0;
+	}
+	map.difference_with(half);
+	for (imap::const_iterator it = half.cbegin(); it != half.cend(); ++it) ref.erase(it->first);
+	if (!check(map, ref)) return false;
+	for (int i = 0; i < 2000; i++) {
+		map.insert(map.end(), imap::value_type(20000 + i, i));
+		ref[20000 + i] = i;
+	}
+	return check(map, ref);
+}
+
+bool test_errors() {
+	imap map, other;
+	map[1] = 1;
+	other[1] = 1;
+	try {
+		map.select(1);
+		return false;
+	} catch (sjtu::index_out_of_bound &) {}
+	try {
+		const imap &view = map;
+		view.select(100);
+		return false;
+	} catch (sjtu::index_out_of_bound &) {}
+	try {
+		std::ptrdiff_t d = map.begin() - other.begin();
+		return d < 0;
+	} catch (sjtu::invalid_iterator &) {}
+	map.clear();
+	return map.rank(1) == 0 && map.end() - map.begin() == 0;
+}
+
+int main() {
+	report(1, "select, rank and distance under random updates...", test_random_updates());
+	report(2, "After bulk load, range erase and set operations...", test_bulk_updates());
+	report(3, "Exceptions...", test_errors());
+	return 0;
+}
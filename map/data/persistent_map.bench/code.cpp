@@ -0,0 +1,69 @@
+// snapshot benchmark: cycles of taking a snapshot of a 1M-entry index and applying a batch of writes to it,
+// sjtu::map copying the whole tree against persistent_map sharing it
+// usage: ./code [entries] [cycles] [writes per cycle]
+
+#include "map.hpp"
+#include "persistent_map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int cycles = argc > 2 ? std::atoi(argv[2]) : 20;
+    int writes = argc > 3 ? std::atoi(argv[3]) : 1000;
+    std::mt19937_64 gen(2024);
+    std::vector<long long> keys;
+    for (int i = 0; i < cycles * writes; ++i) keys.push_back(gen() % (2LL * n));
+
+    sjtu::map<long long, long long> map;
+    sjtu::persistent_map<long long, long long> pmap;
+    for (int i = 0; i < n; ++i) {
+        map[2LL * i] = i;
+        pmap[2LL * i] = i;
+    }
+
+    long long check[2] = {0, 0};
+    std::printf("%d entries, %d cycles of %d writes\n", n, cycles, writes);
+    // the persistent cycles go first, so that they do not run on a heap churned by the full copies
+    std::printf("persistent_map snap + writes : %8.1f ms\n", timeit([&] {
+        sjtu::persistent_map<long long, long long> current(pmap);
+        for (int c = 0; c < cycles; ++c) {
+            sjtu::persistent_map<long long, long long> snapshot(current);
+            for (int i = c * writes; i < (c + 1) * writes; ++i) current[keys[i]] += 1;
+            check[1] += snapshot.size() + current.size();
+        }
+    }));
+    std::printf("sjtu::map copy + writes      : %8.1f ms\n", timeit([&] {
+        sjtu::map<long long, long long> current(map);
+        for (int c = 0; c < cycles; ++c) {
+            sjtu::map<long long, long long> snapshot(current);
+            for (int i = c * writes; i < (c + 1) * writes; ++i) current[keys[i]] += 1;
+            check[0] += snapshot.size() + current.size();
+        }
+    }));
+    double lookups[2];
+    long long sums[2] = {0, 0};
+    lookups[0] = timeit([&] {
+        for (int i = 0; i < cycles * writes; ++i) sums[0] += map.count(keys[i]);
+    });
+    lookups[1] = timeit([&] {
+        for (int i = 0; i < cycles * writes; ++i) sums[1] += pmap.count(keys[i]);
+    });
+    std::printf("lookups sjtu::map %8.1f ms, persistent_map %8.1f ms\n", lookups[0], lookups[1]);
+    if (check[0] != check[1] || sums[0] != sums[1]) {
+        std::printf("mismatch\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,202 @@
+// correctness of persistent_map: many snapshots of one map, each written independently,
+// have to keep their own contents, including erases that take the successor out of shared subtrees
+#include "persistent_map.hpp"
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef sjtu::persistent_map<int, std::string> pmap;
+typedef std::map<int, std::string> smap;
+
+void report(int id, const char *title, bool ok) {
+	printf("Test %d: %-55s%s\n", id, title, ok ? "PASSED" : "FAILED");
+}
+
+// orders ascending or descending, so a map that default-constructs its comparator gets the order wrong
+struct ordered {
+	bool descending;
+	explicit ordered(bool descending) : descending(descending) {}
+	bool operator()(int a, int b) const {
+		return descending ? b < a : a < b;
+	}
+};
+
+template<class Map>
+bool in_order(const Map &map, const std::map<int, int, ordered> &ref) {
+	typename Map::const_iterator it = map.cbegin();
+	for (std::map<int, int, ordered>::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+		if (it == map.cend() || it->first != jt->first || it->second != jt->second || map.count(jt->first) != 1) return false;
+	}
+	return it == map.cend() && map.size() == ref.size();
+}
+
+bool same(const pmap &map, const smap &ref) {
+	if (map.size() != ref.size() || map.empty() != ref.empty()) return false;
+	pmap::const_iterator it = map.cbegin();
+	for (smap::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+		if (it == map.cend() || it->first != jt->first || it->second != jt->second) return false;
+	}
+	if (it != map.cend()) return false;
+	for (smap::const_reverse_iterator jt = ref.rbegin(); jt != ref.rend(); ++jt) {
+		--it;
+		if (it->first != jt->first) return false;
+	}
+	return it == map.cbegin();
+}
+
+std::string value_of(int x) {
+	return "value-" + std::to_string(x);
+}
+
+// every snapshot erases keys with two children, whose successors sit in subtrees shared with the others
+bool test_erase_shared() {
+	pmap base;
+	smap ref;
+	for (int i = 0; i < 4096; i++) {
+		base.assign(i, value_of(i));
+		ref[i] = value_of(i);
+	}
+	std::vector<pmap> snapshots;
+	std::vector<smap> refs;
+	for (int s = 0; s < 8; s++) {
+		snapshots.push_back(base);
+		refs.push_back(ref);
+	}
+	for (int s = 0; s < 8; s++) {
+		// the middle keys of a complete-ish tree are inner nodes
+		for (int k = 2048 + s; k < 4096; k += 64 + s) {
+			snapshots[s].erase(snapshots[s].find(k));
+			refs[s].erase(k);
+		}
+		for (int k = s; k < 2048; k += 37) {
+			if (snapshots[s].erase(k) != refs[s].erase(k)) return false;
+		}
+	}
+	if (!same(base, ref)) return false;
+	for (int s = 0; s < 8; s++) {
+		if (!same(snapshots[s], refs[s])) return false;
+	}
+	return true;
+}
+
+// snapshots of snapshots, all written at random
+bool test_random_snapshots() {
+	std::mt19937 rng(41);
+	std::vector<pmap> snapshots(1);
+	std::vector<smap> refs(1);
+	for (int op = 0; op < 200000; op++) {
+		size_t s = rng() % snapshots.size();
+		pmap &map = snapshots[s];
+		smap &ref = refs[s];
+		int key = (int)(rng() % 3000);
+		switch (rng() % 8) {
+		case 0:
+			if (snapshots.size() < 24) {
+				snapshots.push_back(map);
+				refs.push_back(ref);
+			} else {
+				size_t from = rng() % snapshots.size();
+				snapshots[s] = snapshots[from];
+				refs[s] = refs[from];
+			}
+			break;
+		case 1:
+		case 2: {
+			bool inserted = map.insert(pmap::value_type(key, value_of(op))).second;
+			if (inserted != ref.insert(std::make_pair(key, value_of(op))).second) return false;
+			break;
+		}
+		case 3:
+			if (map.assign(key, value_of(op)) != !ref.count(key)) return false;
+			ref[key] = value_of(op);
+			break;
+		case 4:
+			map[key] += "+";
+			ref[key] += "+";
+			break;
+		case 5:
+			if (ref.count(key)) {
+				map.at(key) = value_of(-op);
+				ref[key] = value_of(-op);
+			}
+			break;
+		default: {
+			pmap::const_iterator it = map.find(key);
+			if ((it == map.cend()) != !ref.count(key)) return false;
+			if (it != map.cend()) {
+				map.erase(it);
+				ref.erase(key);
+			}
+		}
+		}
+		if (op % 10007 == 0) {
+			for (size_t i = 0; i < snapshots.size(); i++) {
+				if (!same(snapshots[i], refs[i])) return false;
+			}
+		}
+	}
+	for (size_t i = 0; i < snapshots.size(); i++) {
+		if (!same(snapshots[i], refs[i])) return false;
+	}
+	return true;
+}
+
+bool test_bounds_and_errors() {
+	pmap map;
+	for (int i = 0; i < 100; i++) map.assign(i * 2, value_of(i));
+	pmap copy = map;
+	copy.clear();
+	if (map.size() != 100 || !copy.empty()) return false;
+	if (map.lower_bound(7)->first != 8 || map.upper_bound(8)->first != 10 || map.lower_bound(199) != map.cend()) return false;
+	if (map.count(7) || !map.count(8)) return false;
+	try {
+		map.at(7);
+		return false;
+	} catch (sjtu::index_out_of_bound &) {}
+	try {
+		map.erase(copy.cbegin());
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		pmap::const_iterator it = map.cbegin();
+		--it;
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	return true;
+}
+
+// the comparator has state, so the map, its snapshots and its assignments have to keep it
+bool test_stateful_order() {
+	typedef sjtu::persistent_map<int, int, ordered> omap;
+	std::mt19937 rng(49);
+	omap map(ordered(true));
+	std::map<int, int, ordered> ref(ordered(true));
+	for (int i = 0; i < 30000; i++) {
+		int key = (int)(rng() % 3000);
+		if (rng() % 3) {
+			map.assign(key, i);
+			ref[key] = i;
+		} else if (map.erase(key) != ref.erase(key)) return false;
+		omap::const_iterator lo = map.lower_bound(key);
+		std::map<int, int, ordered>::const_iterator lr = ref.lower_bound(key);
+		if ((lo == map.cend()) != (lr == ref.end()) || (lo != map.cend() && lo->first != lr->first)) return false;
+	}
+	omap snapshot(map), other(ordered(false));
+	other.assign(1, 1);
+	other = map;
+	std::map<int, int, ordered> changed(ref);
+	other.assign(-1, -1);
+	changed[-1] = -1;
+	return in_order(map, ref) && in_order(snapshot, ref) && in_order(other, changed) && other.key_comp().descending;
+}
+
+int main() {
+	report(1, "Erasing inner nodes of shared snapshots...", test_erase_shared());
+	report(2, "Random writes to many snapshots...", test_random_snapshots());
+	report(3, "Bounds and exceptions...", test_bounds_and_errors());
+	report(4, "Ordering by a comparator with state...", test_stateful_order());
+	return 0;
+}
@@ -0,0 +1,90 @@
+// radix map benchmark: insert, random find, lower_bound and a full scan on dense ints, sparse ints
+// and URL-like strings, radix_map against sjtu::map
+// usage: ./code [entries] [lookups]
+
+#include "map.hpp"
+#include "radix_map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<class Map, class Key>
+long long bench(const char *name, const std::vector<Key> &keys, const std::vector<Key> &queries) {
+    Map *map = new Map;
+    double build = timeit([&] {
+        for (size_t i = 0; i < keys.size(); ++i) (*map)[keys[i]] = (int) i;
+    });
+    long long found = 0, bounded = 0, sum = 0;
+    double find = timeit([&] {
+        for (size_t i = 0; i < queries.size(); ++i) found += map->count(queries[i]);
+    });
+    double bound = timeit([&] {
+        for (size_t i = 0; i < queries.size(); ++i) bounded += map->lower_bound(queries[i]) != map->end();
+    });
+    double scan = timeit([&] {
+        for (auto it = map->begin(); it != map->end(); ++it) sum += it->second;
+    });
+    double clear = timeit([&] { map->clear(); });
+    std::printf("  %-12s insert %8.1f ms  find %8.1f ms  lower_bound %8.1f ms  scan %6.1f ms  clear %6.1f ms\n",
+                name, build, find, bound, scan, clear);
+    delete map;
+    return found * 1000003 + bounded * 1009 + sum;
+}
+
+template<class Key>
+int run(const char *title, const std::vector<Key> &keys, const std::vector<Key> &queries) {
+    std::printf("%s: %zu entries, %zu lookups\n", title, keys.size(), queries.size());
+    long long a = bench<sjtu::map<Key, int>>("sjtu::map", keys, queries);
+    long long b = bench<sjtu::radix_map<Key, int>>("radix_map", keys, queries);
+    if (a != b) {
+        std::printf("mismatch\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int q = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    std::mt19937_64 gen(2024);
+
+    // dense: a shuffled permutation of [0, n), queries half of them present
+    std::vector<long long> dense(n), dense_q(q);
+    for (int i = 0; i < n; ++i) dense[i] = i;
+    for (int i = n - 1; i > 0; --i) std::swap(dense[i], dense[gen() % (i + 1)]);
+    for (int i = 0; i < q; ++i) dense_q[i] = gen() % (2 * n);
+    int res = run("dense long long", dense, dense_q);
+
+    // sparse: random 64-bit keys, queries half of them present
+    std::vector<long long> sparse(n), sparse_q(q);
+    for (int i = 0; i < n; ++i) sparse[i] = (long long) gen();
+    for (int i = 0; i < q; ++i) sparse_q[i] = gen() % 2 ? sparse[gen() % n] : (long long) gen();
+    res |= run("sparse long long", sparse, sparse_q);
+
+    // URL-like strings sharing long prefixes, queries half of them present
+    const char *hosts[] = {"https://www.example.com/", "https://docs.example.com/", "https://shop.example.org/", "http://cdn.example.net/"};
+    const char *dirs[] = {"assets/", "blog/posts/", "api/v2/users/", "products/item/", "images/thumbs/"};
+    auto url = [&] {
+        std::string s = hosts[gen() % 4];
+        s += dirs[gen() % 5];
+        s += std::to_string(gen() % (4 * n));
+        s += gen() % 2 ? ".html" : "/index";
+        return s;
+    };
+    std::vector<std::string> urls(n), urls_q(q);
+    for (int i = 0; i < n; ++i) urls[i] = url();
+    for (int i = 0; i < q; ++i) urls_q[i] = gen() % 2 ? urls[gen() % n] : url();
+    res |= run("URL strings", urls, urls_q);
+    return res;
+}
@@ -0,0 +1,236 @@
+// correctness of radix_map against std::map: inner nodes growing through 4, 16, 48 and 256 children
+// and shrinking back, string keys that are prefixes of others, and prefixes longer than a node keeps
+#include "radix_map.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+void report(int id, const char *title, bool ok) {
+	printf("Test %d: %-55s%s\n", id, title, ok ? "PASSED" : "FAILED");
+}
+
+template<class K>
+bool same(sjtu::radix_map<K, int> &map, const std::map<K, int> &ref) {
+	if (map.size() != ref.size() || map.empty() != ref.empty()) return false;
+	typename sjtu::radix_map<K, int>::const_iterator it = map.cbegin();
+	for (typename std::map<K, int>::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+		if (it == map.cend() || it->first != jt->first || it->second != jt->second) return false;
+	}
+	if (it != map.cend()) return false;
+	typename sjtu::radix_map<K, int>::iterator kt = map.end();
+	for (typename std::map<K, int>::const_reverse_iterator jt = ref.rbegin(); jt != ref.rend(); ++jt) {
+		--kt;
+		if (kt->first != jt->first) return false;
+	}
+	return kt == map.begin();
+}
+
+template<class K>
+bool bounds(sjtu::radix_map<K, int> &map, const std::map<K, int> &ref, const K &key) {
+	typename std::map<K, int>::const_iterator lo = ref.lower_bound(key), up = ref.upper_bound(key);
+	typename sjtu::radix_map<K, int>::const_iterator a = ((const sjtu::radix_map<K, int> &) map).lower_bound(key);
+	typename sjtu::radix_map<K, int>::iterator b = map.upper_bound(key);
+	if ((lo == ref.end()) != (a == map.cend()) || (lo != ref.end() && a->first != lo->first)) return false;
+	if ((up == ref.end()) != (b == map.end()) || (up != ref.end() && b->first != up->first)) return false;
+	return map.count(key) == ref.count(key) && (!ref.count(key) || map.at(key) == ref.at(key));
+}
+
+// one inner node at byte `shift` fills up to 256 children and empties again, checked at every size
+bool fan_out(int shift, unsigned seed) {
+	std::mt19937 rng(seed);
+	std::vector<int> bytes;
+	for (int b = 0; b < 256; b++) bytes.push_back(b);
+	std::shuffle(bytes.begin(), bytes.end(), rng);
+	sjtu::radix_map<int, int> map;
+	std::map<int, int> ref;
+	const int base = 0x12345678 & ~(0xff << shift);
+	for (int i = 0; i < 256; i++) {
+		int key = base | bytes[i] << shift;
+		map[key] = i;
+		ref[key] = i;
+		if (!same(map, ref) || !bounds(map, ref, key + 1) || !bounds(map, ref, key - 1)) return false;
+	}
+	std::shuffle(bytes.begin(), bytes.end(), rng);
+	for (int i = 0; i < 256; i++) {
+		int key = base | bytes[i] << shift;
+		if (map.erase(key) != 1) return false;
+		ref.erase(key);
+		if (!same(map, ref) || !bounds(map, ref, key)) return false;
+	}
+	return map.empty() && map.begin() == map.end();
+}
+
+bool test_fan_out() {
+	return fan_out(0, 1) && fan_out(8, 2) && fan_out(16, 3) && fan_out(24, 4);
+}
+
+bool test_prefix_keys() {
+	sjtu::radix_map<std::string, int> map;
+	std::map<std::string, int> ref;
+	std::string chain;
+	// "", "a", "ab", ... each hangs on the node of the next one, next to siblings branching off
+	for (int i = 0; i < 40; i++) {
+		map[chain] = i;
+		ref[chain] = i;
+		map.insert(sjtu::radix_map<std::string, int>::value_type(chain + "~", -i));
+		ref.insert(std::make_pair(chain + "~", -i));
+		if (i % 3 == 0) {
+			map[chain + "\x01"] = i;
+			ref[chain + "\x01"] = i;
+		}
+		chain += (char)('a' + i % 26);
+	}
+	if (!same(map, ref)) return false;
+	for (std::map<std::string, int>::iterator it = ref.begin(); it != ref.end(); ++it) {
+		if (!bounds(map, ref, it->first) || !bounds(map, ref, it->first + "b") || !bounds(map, ref, it->first + "\xff"))
+			return false;
+	}
+	// erase the inner keys of the chain first, then the leaves under them
+	for (int pass = 0; pass < 2; pass++) {
+		std::string key;
+		for (int i = 0; i < 40; i++) {
+			if ((i + pass) % 2 == 0) {
+				if (map.erase(key) != 1) return false;
+				ref.erase(key);
+			}
+			key += (char)('a' + i % 26);
+		}
+		if (!same(map, ref)) return false;
+	}
+	std::vector<std::string> rest;
+	for (std::map<std::string, int>::iterator it = ref.begin(); it != ref.end(); ++it) rest.push_back(it->first);
+	std::mt19937 rng(45);
+	std::shuffle(rest.begin(), rest.end(), rng);
+	for (size_t i = 0; i < rest.size(); i++) {
+		map.erase(map.find(rest[i]));
+		ref.erase(rest[i]);
+		if (!same(map, ref) || !bounds(map, ref, rest[i])) return false;
+	}
+	return map.empty();
+}
+
+// prefixes of 7 to 40 shared bytes, so compressed paths both fit in a node and spill past max_prefix
+bool test_long_prefixes() {
+	std::mt19937 rng(46);
+	sjtu::radix_map<std::string, int> map;
+	std::map<std::string, int> ref;
+	std::vector<std::string> keys;
+	const int lengths[] = {7, 8, 9, 16, 17, 40};
+	for (int l = 0; l < 6; l++) {
+		std::string common(lengths[l], (char)('A' + l));
+		for (int i = 0; i < 30; i++) {
+			std::string key = common;
+			// the keys branch off at the end of the common part or a few bytes into it
+			if (i % 5 == 0) key = key.substr(0, rng() % key.size());
+			key += std::to_string(rng() % 50);
+			if (i % 7 == 0) key += std::string(lengths[l], 'z');
+			keys.push_back(key);
+		}
+	}
+	for (size_t i = 0; i < keys.size(); i++) {
+		map[keys[i]] = (int)i;
+		ref[keys[i]] = (int)i;
+		if (!same(map, ref)) return false;
+	}
+	for (size_t i = 0; i < keys.size(); i++) {
+		if (!bounds(map, ref, keys[i]) || !bounds(map, ref, keys[i] + "0") || !bounds(map, ref, keys[i].substr(0, i % 12)))
+			return false;
+	}
+	// erasing merges single children back into their parents, with the prefix bytes read from below
+	std::shuffle(keys.begin(), keys.end(), rng);
+	for (size_t i = 0; i < keys.size(); i++) {
+		if (map.erase(keys[i]) != ref.erase(keys[i])) return false;
+		if (i % 4 == 0 && !same(map, ref)) return false;
+		for (size_t j = i + 1; j < keys.size() && j < i + 4; j++) {
+			if (!bounds(map, ref, keys[j])) return false;
+		}
+	}
+	return map.empty();
+}
+
+template<class K, class G>
+bool churn(G key_of, int ops, unsigned seed) {
+	std::mt19937 rng(seed);
+	sjtu::radix_map<K, int> map;
+	std::map<K, int> ref;
+	for (int op = 0; op < ops; op++) {
+		K key = key_of(rng);
+		switch (rng() % 5) {
+		case 0:
+		case 1: {
+			sjtu::pair<typename sjtu::radix_map<K, int>::iterator, bool> r =
+				map.insert(typename sjtu::radix_map<K, int>::value_type(key, op));
+			bool inserted = ref.insert(std::make_pair(key, op)).second;
+			if (r.second != inserted || r.first->first != key || r.first->second != ref[key]) return false;
+			break;
+		}
+		case 2:
+			map[key] = op;
+			ref[key] = op;
+			break;
+		case 3:
+			if (map.erase(key) != ref.erase(key)) return false;
+			break;
+		default:
+			if (!bounds(map, ref, key)) return false;
+		}
+		if (op % 5003 == 0 && !same(map, ref)) return false;
+	}
+	sjtu::radix_map<K, int> copy(map), other;
+	other = copy;
+	other = other;
+	map.clear();
+	return map.empty() && same(copy, ref) && same(other, ref);
+}
+
+int int_key(std::mt19937 &rng) {
+	// negative and positive keys, dense around a few clusters
+	return (int)(rng() % 4) * 0x1000000 - 0x2000000 + (int)(rng() % 3000);
+}
+
+std::string string_key(std::mt19937 &rng) {
+	std::string key;
+	for (size_t n = rng() % 12; n > 0; n--) key += "abc\xff"[rng() % 4];
+	return key;
+}
+
+bool test_churn() {
+	return churn<int>(int_key, 200000, 47) && churn<std::string>(string_key, 200000, 48) &&
+		churn<unsigned long long>([](std::mt19937 &rng) { return (unsigned long long)rng() << (rng() % 33); }, 100000, 49);
+}
+
+bool test_errors() {
+	sjtu::radix_map<std::string, int> map, other;
+	map["key"] = 1;
+	try {
+		map.at("ke");
+		return false;
+	} catch (sjtu::index_out_of_bound &) {}
+	try {
+		map.erase(map.end());
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		map.erase(other.begin());
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		sjtu::radix_map<std::string, int>::iterator it = map.begin();
+		--it;
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	return true;
+}
+
+int main() {
+	report(1, "Inner nodes growing to 256 children and back...", test_fan_out());
+	report(2, "String keys that are prefixes of others...", test_prefix_keys());
+	report(3, "Shared prefixes longer than a node keeps...", test_long_prefixes());
+	report(4, "Random operations and copies...", test_churn());
+	report(5, "Exceptions...", test_errors());
+	return 0;
+}
@@ -0,0 +1,102 @@
+// range aggregate benchmark on timestamped values: mixed updates and range sums / minimums,
+// with augmented_map against scanning the range of a plain sjtu::map
+// usage: ./code [entries] [operations] [window]
+
+#include "augmented_map.hpp"
+#include "map.hpp"
+
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+struct sum_monoid {
+    typedef long long value_type;
+    long long identity() const { return 0; }
+    long long combine(long long a, long long b) const { return a + b; }
+};
+
+struct min_monoid {
+    typedef int value_type;
+    int identity() const { return INT_MAX; }
+    int combine(int a, int b) const { return a < b ? a : b; }
+};
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct operation {
+    int type;
+    long long a, b;
+    int value;
+};
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int ops = argc > 2 ? std::atoi(argv[2]) : 100000;
+    long long window = argc > 3 ? std::atoll(argv[3]) : 10000;
+    std::mt19937_64 rng(20231001);
+    long long span = 10LL * n;
+    std::vector<operation> work;
+    for (int i = 0; i < ops; ++i) {
+        operation op;
+        op.type = (int) (rng() % 3);  // 0: update, 1: range sum, 2: range minimum
+        op.a = (long long) (rng() % span);
+        op.b = op.a + (long long) (rng() % window);
+        op.value = (int) (rng() % 1000000);
+        work.push_back(op);
+    }
+
+    sjtu::augmented_map<long long, int, sum_monoid> sums;
+    sjtu::augmented_map<long long, int, min_monoid> mins;
+    sjtu::map<long long, int> plain;
+    for (int i = 0; i < n; ++i) {
+        long long t = (long long) (rng() % span);
+        int v = (int) (rng() % 1000000);
+        sums.assign(t, v);
+        mins.assign(t, v);
+        plain[t] = v;
+    }
+
+    long long result[2] = {0, 0};
+    std::printf("%zu entries, %d operations, window %lld\n", plain.size(), ops, window);
+    std::printf("augmented_map : %8.1f ms\n", timeit([&] {
+        for (int i = 0; i < ops; ++i) {
+            const operation &op = work[i];
+            if (op.type == 0) {
+                sums.assign(op.a, op.value);
+                mins.assign(op.a, op.value);
+            } else if (op.type == 1)
+                result[0] += sums.aggregate(op.a, op.b);
+            else
+                result[0] += mins.aggregate(op.a, op.b);
+        }
+    }));
+    std::printf("linear scans  : %8.1f ms\n", timeit([&] {
+        for (int i = 0; i < ops; ++i) {
+            const operation &op = work[i];
+            if (op.type == 0) {
+                plain[op.a] = op.value;
+                continue;
+            }
+            long long sum = 0;
+            int min = INT_MAX;
+            for (sjtu::map<long long, int>::const_iterator it = plain.lower_bound(op.a); it != plain.cend() && it->first < op.b; ++it) {
+                sum += it->second;
+                if (it->second < min) min = it->second;
+            }
+            result[1] += op.type == 1 ? sum : min;
+        }
+    }));
+    if (result[0] != result[1]) {
+        std::printf("mismatch\n");
+        return 1;
+    }
+    return 0;
+}
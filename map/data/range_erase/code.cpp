@@ -0,0 +1,164 @@
+// correctness of the ordered range operations of map against std::map: lower_bound, upper_bound
+// and equal_range, and erase(first, last) over short runs, whole prefixes and suffixes and the whole map
+#include "map.hpp"
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+typedef sjtu::map<int, int> imap;
+typedef std::map<int, int> smap;
+
+void report(int id, const char *title, bool ok) {
+	printf("Test %d: %-55s%s\n", id, title, ok ? "PASSED" : "FAILED");
+}
+
+bool same(imap &map, const smap &ref) {
+	if (map.size() != ref.size() || map.empty() != ref.empty()) return false;
+	imap::const_iterator it = map.cbegin();
+	for (smap::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it) {
+		if (it == map.cend() || it->first != jt->first || it->second != jt->second) return false;
+	}
+	if (it != map.cend()) return false;
+	imap::iterator kt = map.end();
+	for (smap::const_reverse_iterator jt = ref.rbegin(); jt != ref.rend(); ++jt) {
+		--kt;
+		if (kt->first != jt->first) return false;
+	}
+	return kt == map.begin();
+}
+
+bool bounds(imap &map, const smap &ref, int key) {
+	const imap &view = map;
+	smap::const_iterator lo = ref.lower_bound(key), up = ref.upper_bound(key);
+	imap::iterator a = map.lower_bound(key), b = map.upper_bound(key);
+	imap::const_iterator c = view.lower_bound(key), d = view.upper_bound(key);
+	if ((lo == ref.end()) != (a == map.end()) || (lo != ref.end() && (a->first != lo->first || a->second != lo->second))) return false;
+	if ((up == ref.end()) != (b == map.end()) || (up != ref.end() && b->first != up->first)) return false;
+	if (c != a || d != b) return false;
+	sjtu::pair<imap::iterator, imap::iterator> r = map.equal_range(key);
+	sjtu::pair<imap::const_iterator, imap::const_iterator> s = view.equal_range(key);
+	return r.first == a && r.second == b && s.first == c && s.second == d;
+}
+
+bool test_bounds() {
+	std::mt19937 rng(35);
+	imap map;
+	smap ref;
+	for (int q = -2; q <= 2; q++) {
+		if (!bounds(map, ref, q)) return false;
+	}
+	for (int i = 0; i < 20000; i++) {
+		int key = (int)(rng() % 30000) * 2;
+		map[key] = i;
+		ref[key] = i;
+	}
+	// even keys only: odd queries fall between two elements
+	for (int q = -3; q <= 60003; q += 1 + (int)(rng() % 7)) {
+		if (!bounds(map, ref, q)) return false;
+	}
+	return bounds(map, ref, map.begin()->first) && bounds(map, ref, ref.rbegin()->first);
+}
+
+// random ranges of every length, the elements outside them keep their iterators
+bool test_random_ranges() {
+	std::mt19937 rng(36);
+	for (int round = 0; round < 30; round++) {
+		imap map;
+		smap ref;
+		int range = 100 + (int)(rng() % 5000);
+		for (int i = 0; i < range; i++) {
+			int key = (int)(rng() % range);
+			map[key] = i;
+			ref[key] = i;
+		}
+		while (!ref.empty()) {
+			int lo = (int)(rng() % (range + 2)) - 1, hi = lo + (int)(rng() % (range / (1 + rng() % 20) + 1));
+			imap::iterator before = map.lower_bound(lo), after = map.lower_bound(hi);
+			imap::iterator left = before, right = after;
+			bool has_left = left != map.begin(), has_right = right != map.end();
+			if (has_left) --left;
+			map.erase(before, after);
+			ref.erase(ref.lower_bound(lo), ref.lower_bound(hi));
+			if (has_left && (left->first != (--ref.lower_bound(lo))->first || left->second != ref[left->first])) return false;
+			if (has_right && (right->first != ref.lower_bound(hi)->first || right->second != ref[right->first])) return false;
+			if (rng() % 4 == 0) {
+				int key = (int)(rng() % range);
+				map[key] = -key;
+				ref[key] = -key;
+			}
+			if (!same(map, ref)) return false;
+		}
+	}
+	return true;
+}
+
+// ranges reaching an end of the map, and the whole map
+bool test_ends() {
+	const int n = 50000;
+	imap map;
+	smap ref;
+	for (int i = 0; i < n; i++) {
+		map[i] = i;
+		ref[i] = i;
+	}
+	map.erase(map.begin(), map.lower_bound(n / 10));
+	ref.erase(ref.begin(), ref.lower_bound(n / 10));
+	if (!same(map, ref)) return false;
+	map.erase(map.lower_bound(n - n / 10), map.end());
+	ref.erase(ref.lower_bound(n - n / 10), ref.end());
+	if (!same(map, ref)) return false;
+	map.erase(map.begin(), map.begin());
+	map.erase(map.end(), map.end());
+	if (!same(map, ref)) return false;
+	// the map keeps working after its halves were erased
+	map.erase(map.lower_bound(n / 2), map.end());
+	ref.erase(ref.lower_bound(n / 2), ref.end());
+	for (int i = n; i < n + 1000; i++) {
+		map[i] = i;
+		ref[i] = i;
+	}
+	if (!same(map, ref)) return false;
+	map.erase(map.begin(), map.end());
+	ref.clear();
+	if (!same(map, ref)) return false;
+	map[1] = 1;
+	ref[1] = 1;
+	return same(map, ref);
+}
+
+bool test_errors() {
+	imap map, other;
+	for (int i = 0; i < 10; i++) {
+		map[i] = i;
+		other[i] = i;
+	}
+	try {
+		map.erase(map.begin(), other.end());
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		map.erase(other.begin(), other.end());
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		map.erase(map.end(), map.begin());
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	try {
+		// last before first
+		map.erase(map.find(5), map.find(2));
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	// nothing was erased by the calls that threw
+	return map.size() == 10 && other.size() == 10;
+}
+
+int main() {
+	report(1, "lower_bound, upper_bound and equal_range...", test_bounds());
+	report(2, "Erasing random ranges...", test_random_ranges());
+	report(3, "Erasing ranges at both ends and everything...", test_ends());
+	report(4, "Exceptions...", test_errors());
+	return 0;
+}
@@ -0,0 +1,87 @@
+// range benchmark on a time-series style index: sum of the values with keys in [a, b) for random windows,
+// found with lower_bound against a scan from begin(), and erase(first, last) of large ranges,
+// all compared with std::map
+// usage: ./code [entries] [queries] [window]
+
+#include "map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <vector>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<class Map>
+long long sum_range(const Map &map, long long a, long long b) {
+    long long sum = 0;
+    for (typename Map::const_iterator it = map.lower_bound(a); it != map.cend() && it->first < b; ++it) sum += it->second;
+    return sum;
+}
+
+template<class Map>
+long long sum_range_scan(const Map &map, long long a, long long b) {
+    long long sum = 0;
+    for (typename Map::const_iterator it = map.cbegin(); it != map.cend() && it->first < b; ++it)
+        if (it->first >= a) sum += it->second;
+    return sum;
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int queries = argc > 2 ? std::atoi(argv[2]) : 100000;
+    long long window = argc > 3 ? std::atoll(argv[3]) : 1000;
+    std::mt19937_64 rng(20230801);
+    // timestamps with gaps, about one entry every 10 time units
+    sjtu::map<long long, long long> map;
+    std::map<long long, long long> std_map;
+    long long t = 0;
+    for (int i = 0; i < n; ++i) {
+        t += 1 + rng() % 19;
+        map[t] = i;
+        std_map[t] = i;
+    }
+    std::vector<long long> starts;
+    for (int i = 0; i < queries; ++i) starts.push_back((long long) (rng() % t));
+
+    long long sum[3] = {0, 0, 0};
+    std::printf("%d entries, %d queries of window %lld\n", n, queries, window);
+    std::printf("sjtu::map lower_bound : %8.1f ms\n", timeit([&] {
+        for (int i = 0; i < queries; ++i) sum[0] += sum_range(map, starts[i], starts[i] + window);
+    }));
+    std::printf("std::map lower_bound  : %8.1f ms\n", timeit([&] {
+        for (int i = 0; i < queries; ++i) sum[1] += sum_range(std_map, starts[i], starts[i] + window);
+    }));
+    int scans = queries / 1000 > 0 ? queries / 1000 : 1;
+    std::printf("sjtu::map begin() scan: %8.1f ms (%d queries)\n", timeit([&] {
+        for (int i = 0; i < scans; ++i) sum[2] += sum_range_scan(map, starts[i], starts[i] + window);
+    }), scans);
+    long long check = 0;
+    for (int i = 0; i < scans; ++i) check += sum_range(std_map, starts[i], starts[i] + window);
+
+    // drop the oldest tenth, then ten windows of a hundredth in the middle
+    std::vector<std::pair<long long, long long>> drops;
+    drops.push_back(std::make_pair(0LL, t / 10));
+    for (int i = 0; i < 10; ++i) {
+        long long a = t / 10 + (long long) (rng() % (t / 2));
+        drops.push_back(std::make_pair(a, a + t / 100));
+    }
+    std::printf("sjtu::map range erase : %8.1f ms\n", timeit([&] {
+        for (size_t i = 0; i < drops.size(); ++i) map.erase(map.lower_bound(drops[i].first), map.lower_bound(drops[i].second));
+    }));
+    std::printf("std::map range erase  : %8.1f ms\n", timeit([&] {
+        for (size_t i = 0; i < drops.size(); ++i) std_map.erase(std_map.lower_bound(drops[i].first), std_map.lower_bound(drops[i].second));
+    }));
+    if (sum[0] != sum[1] || sum[2] != check || map.size() != std_map.size() || sum_range(map, 0, t + 1) != sum_range(std_map, 0, t + 1)) {
+        std::printf("mismatch\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+// set operations benchmark: union, intersection and difference of two maps of 1M random keys
+// and a batch of 100k updates applied to one of them, join-based on 1 and on all hardware threads
+// against inserting or erasing element by element
+// usage: ./code [entries] [batch]
+
+#include "parallel.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+typedef sjtu::map<long long, long long> Map;
+
+Map random_map(std::mt19937_64 &gen, int n, long long range) {
+    Map map;
+    for (int i = 0; i < n; ++i) {
+        long long key = gen() % range;
+        map[key] = key;
+    }
+    return map;
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int batch = argc > 2 ? std::atoi(argv[2]) : 100000;
+    std::mt19937_64 gen(2024);
+    Map a = random_map(gen, n, 4LL * n), b = random_map(gen, n, 4LL * n), updates = random_map(gen, batch, 4LL * n);
+    std::printf("%zu and %zu keys, batch of %zu\n", a.size(), b.size(), updates.size());
+
+    // the operands are copied before the clock starts, the join-based operations take over the nodes of b
+    size_t sizes[3][3];
+    const char *names[3] = {"union", "intersection", "difference"};
+    for (int op = 0; op < 3; ++op) {
+        double t[3];
+        {
+            Map res(a);
+            t[0] = timeit([&] {
+                if (op == 0) for (Map::const_iterator it = b.cbegin(); it != b.cend(); ++it) res.insert(*it);
+                if (op == 1) {
+                    Map::iterator it = res.begin();
+                    while (it != res.end()) {
+                        Map::iterator nxt = it;
+                        ++nxt;
+                        if (!b.count(it->first)) res.erase(it);
+                        it = nxt;
+                    }
+                }
+                if (op == 2)
+                    for (Map::const_iterator it = b.cbegin(); it != b.cend(); ++it) {
+                        Map::iterator p = res.find(it->first);
+                        if (p != res.end()) res.erase(p);
+                    }
+            });
+            sizes[op][0] = res.size();
+        }
+        for (int k = 1; k < 3; ++k) {
+            Map res(a), other(b);
+            size_t threads = k == 1 ? 1 : 0;
+            t[k] = timeit([&] {
+                if (op == 0) res.union_with(std::move(other), threads);
+                if (op == 1) res.intersect_with(std::move(other), threads);
+                if (op == 2) res.difference_with(std::move(other), threads);
+            });
+            sizes[op][k] = res.size();
+        }
+        std::printf("%-12s element-wise %8.1f ms  join %8.1f ms  join parallel %8.1f ms\n", names[op], t[0], t[1], t[2]);
+    }
+
+    double t[3];
+    Map c(b), d(b);
+    {
+        Map batch(updates);
+        t[0] = timeit([&] {
+            for (Map::const_iterator it = batch.cbegin(); it != batch.cend(); ++it) b[it->first] = it->second;
+        });
+    }
+    {
+        Map batch(updates);
+        t[1] = timeit([&] { c.apply_batch(std::move(batch)); });
+    }
+    {
+        Map batch(updates);
+        t[2] = timeit([&] { d.apply_batch(std::move(batch), 0); });
+    }
+    std::printf("%-12s element-wise %8.1f ms  join %8.1f ms  join parallel %8.1f ms\n", "apply_batch", t[0], t[1], t[2]);
+
+    for (int op = 0; op < 3; ++op)
+        if (sizes[op][1] != sizes[op][0] || sizes[op][2] != sizes[op][0]) {
+            std::printf("mismatch\n");
+            return 1;
+        }
+    if (c.size() != b.size() || d.size() != b.size()) {
+        std::printf("mismatch\n");
+        return 1;
+    }
+    return 0;
+}
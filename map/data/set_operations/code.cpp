@@ -0,0 +1,213 @@
+// correctness of the set operations of map against std::map: union, intersection, difference and
+// batch assignment from copies and from rvalues, the iterators they keep valid, and the threaded versions
+#include "map.hpp"
+#include "parallel.hpp"
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+typedef sjtu::map<int, int> imap;
+typedef std::map<int, int> smap;
+
+void report(int id, const char *title, bool ok) {
+	printf("Test %d: %-55s%s\n", id, title, ok ? "PASSED" : "FAILED");
+}
+
+// both directions of the threaded list and the subtree sizes through select and rank
+bool same(imap &map, const smap &ref) {
+	if (map.size() != ref.size() || map.empty() != ref.empty()) return false;
+	imap::const_iterator it = map.cbegin();
+	size_t k = 0;
+	for (smap::const_iterator jt = ref.begin(); jt != ref.end(); ++jt, ++it, ++k) {
+		if (it == map.cend() || it->first != jt->first || it->second != jt->second) return false;
+		if (k % 29 == 0 && (map.select(k)->first != jt->first || map.rank(jt->first) != k)) return false;
+	}
+	if (it != map.cend()) return false;
+	imap::iterator kt = map.end();
+	for (smap::const_reverse_iterator jt = ref.rbegin(); jt != ref.rend(); ++jt) {
+		--kt;
+		if (kt->first != jt->first) return false;
+	}
+	return kt == map.begin();
+}
+
+// the result has to stay a valid AVL tree under the updates that follow
+bool churn(imap &map, smap &ref, std::mt19937 &rng, int range) {
+	for (int op = 0; op < 500; op++) {
+		int key = (int)(rng() % (range + 1));
+		if (rng() % 2) {
+			map[key] = op;
+			ref[key] = op;
+		} else if (ref.count(key)) {
+			map.erase(map.find(key));
+			ref.erase(key);
+		}
+	}
+	return same(map, ref);
+}
+
+void fill(imap &map, smap &ref, std::mt19937 &rng, int n, int range, int sign) {
+	for (int i = 0; i < n; i++) {
+		int key = (int)(rng() % range);
+		map[key] = sign * key;
+		ref[key] = sign * key;
+	}
+}
+
+// what op makes of a and b
+smap expected(const smap &a, const smap &b, int op) {
+	smap res;
+	if (op == 0) {
+		res = a;
+		res.insert(b.begin(), b.end());
+	} else if (op == 1) {
+		for (smap::const_iterator it = a.begin(); it != a.end(); ++it) {
+			if (b.count(it->first)) res.insert(*it);
+		}
+	} else if (op == 2) {
+		res = a;
+		for (smap::const_iterator it = b.begin(); it != b.end(); ++it) res.erase(it->first);
+	} else {
+		res = a;
+		for (smap::const_iterator it = b.begin(); it != b.end(); ++it) res[it->first] = it->second;
+	}
+	return res;
+}
+
+void apply(imap &map, const imap &other, int op) {
+	if (op == 0) map.union_with(other);
+	else if (op == 1) map.intersect_with(other);
+	else if (op == 2) map.difference_with(other);
+	else map.apply_batch(other);
+}
+
+void apply(imap &map, imap &&other, int op, size_t threads) {
+	if (op == 0) map.union_with(std::move(other), threads);
+	else if (op == 1) map.intersect_with(std::move(other), threads);
+	else if (op == 2) map.difference_with(std::move(other), threads);
+	else map.apply_batch(std::move(other), threads);
+}
+
+// small and large maps of every relative size, disjoint, overlapping and equal key ranges
+bool test_random() {
+	std::mt19937 rng(40);
+	for (int round = 0; round < 400; round++) {
+		int small = round < 200, range = 1 + (int)(rng() % (small ? 60 : 20000));
+		int n = (int)(rng() % (small ? 40 : 6000)), m = (int)(rng() % (small ? 40 : 6000));
+		imap a, b;
+		smap ra, rb;
+		fill(a, ra, rng, n, range, 1);
+		// a shifted range makes the keys disjoint or only partly shared
+		int shift = rng() % 3 == 0 ? (int)(rng() % (range + 1)) : 0;
+		for (int i = 0; i < m; i++) {
+			int key = (int)(rng() % range) + shift;
+			b[key] = -key;
+			rb[key] = -key;
+		}
+		int op = round % 4;
+		smap res = expected(ra, rb, op);
+		if (rng() % 2) {
+			apply(a, b, op);
+			// a copy is taken from, the source is left as it was
+			if (!same(b, rb)) return false;
+		} else {
+			apply(a, std::move(b), op, 1);
+			if (!b.empty() || b.begin() != b.end() || b.size() != 0) return false;
+			b[1] = 1;
+			if (b.size() != 1 || b.begin()->first != 1) return false;
+		}
+		if (!same(a, res) || !churn(a, res, rng, range)) return false;
+	}
+	return true;
+}
+
+// the elements kept from this map stay in their nodes, apply_batch replaces the ones it overwrites
+bool test_iterators() {
+	std::mt19937 rng(41);
+	for (int op = 0; op < 4; op++) {
+		imap a, b;
+		smap ra, rb;
+		fill(a, ra, rng, 3000, 5000, 1);
+		fill(b, rb, rng, 3000, 5000, -1);
+		std::vector<imap::iterator> kept;
+		for (imap::iterator it = a.begin(); it != a.end(); ++it) {
+			bool stays = op == 0 || (op == 1 && rb.count(it->first)) || (op == 2 && !rb.count(it->first)) || (op == 3 && !rb.count(it->first));
+			if (stays) kept.push_back(it);
+		}
+		apply(a, b, op);
+		smap res = expected(ra, rb, op);
+		for (size_t i = 0; i < kept.size(); i++) {
+			imap::iterator it = kept[i];
+			if (it->second != ra[it->first] || a.find(it->first) != it) return false;
+			// the neighbours in the result are reached from the kept element
+			imap::iterator next = it;
+			++next;
+			smap::iterator jt = res.upper_bound(it->first);
+			if ((next == a.end()) != (jt == res.end()) || (jt != res.end() && next->first != jt->first)) return false;
+		}
+		if (!same(a, res)) return false;
+	}
+	return true;
+}
+
+// the threaded versions fork on the upper levels of large trees and give the same maps
+bool test_threads() {
+	std::mt19937 rng(42);
+	const size_t counts[] = {0, 2, 3, 4, 8};
+	for (int round = 0; round < 20; round++) {
+		int op = round % 4;
+		imap a, b;
+		smap ra, rb;
+		fill(a, ra, rng, 60000 + (int)(rng() % 20000), 200000, 1);
+		fill(b, rb, rng, round < 10 ? 50000 : 500, 200000, -1);
+		smap res = expected(ra, rb, op);
+		size_t threads = counts[round % 5];
+		if (round % 3) {
+			apply(a, std::move(b), op, threads);
+			if (!b.empty()) return false;
+		} else {
+			if (op == 0) a.union_with(b, threads);
+			else if (op == 1) a.intersect_with(b, threads);
+			else if (op == 2) a.difference_with(b, threads);
+			else a.apply_batch(b, threads);
+			if (!same(b, rb)) return false;
+		}
+		if (!same(a, res) || !churn(a, res, rng, 200000)) return false;
+	}
+	return true;
+}
+
+// empty operands and a map combined with itself
+bool test_edges() {
+	imap map, empty;
+	for (int i = 0; i < 100; i++) map[i] = i;
+	map.union_with(empty);
+	map.difference_with(empty);
+	map.apply_batch(empty);
+	if (map.size() != 100) return false;
+	empty.union_with(map);
+	if (empty.size() != 100 || empty.begin()->first != 0) return false;
+	empty.clear();
+	empty.intersect_with(map);
+	if (!empty.empty()) return false;
+	map.union_with(map);
+	map.intersect_with(map);
+	map.apply_batch(map);
+	if (map.size() != 100 || map.at(50) != 50) return false;
+	map.difference_with(map);
+	if (!map.empty() || map.begin() != map.end()) return false;
+	map[7] = 7;
+	map.intersect_with(imap(), 2);
+	return map.empty() && map.begin() == map.end();
+}
+
+int main() {
+	report(1, "Random set operations against std::map...", test_random());
+	report(2, "Iterators to the kept elements...", test_iterators());
+	report(3, "Set operations on several threads...", test_threads());
+	report(4, "Empty operands and self operations...", test_edges());
+	return 0;
+}
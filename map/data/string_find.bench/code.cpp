@@ -0,0 +1,89 @@
+// lookup benchmark with std::string keys: sjtu::map with a plain, a three-way and a transparent comparator
+// against std::map, plus the number of key copies made per lookup
+// usage: ./code [keys] [lookups]
+
+#include "map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static size_t key_copies = 0;
+
+// a string key that counts its copies
+struct counted_string : std::string {
+    counted_string(const std::string &s) : std::string(s) {}
+    counted_string(const counted_string &other) : std::string(other) { ++key_copies; }
+};
+
+struct three_way_less {
+    typedef void is_three_way;
+    int operator()(const std::string &a, const std::string &b) const { return a.compare(b); }
+};
+
+struct transparent_less {
+    typedef void is_transparent;
+    bool operator()(std::string_view a, std::string_view b) const { return a < b; }
+};
+
+template<typename F>
+double timeit(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<class Map, class Probe>
+double bench_find(Map &map, const std::vector<Probe> &probes, long long &hits) {
+    return timeit([&] {
+        for (size_t i = 0; i < probes.size(); ++i) hits += map.count(probes[i]);
+    });
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int lookups = argc > 2 ? std::atoi(argv[2]) : 2000000;
+    std::mt19937_64 rng(20230601);
+    // long common prefixes make every comparison walk most of the string
+    std::vector<std::string> keys;
+    for (int i = 0; i < n; ++i) keys.push_back("user/session/" + std::to_string(rng() % (4ull * n)));
+    std::vector<std::string> probes;
+    std::vector<std::string_view> views;
+    for (int i = 0; i < lookups; ++i) probes.push_back(keys[rng() % n] + (i % 2 ? "" : "x"));
+    for (int i = 0; i < lookups; ++i) views.push_back(probes[i]);
+
+    sjtu::map<std::string, int> plain;
+    sjtu::map<std::string, int, three_way_less> three_way;
+    sjtu::map<std::string, int, transparent_less> transparent;
+    sjtu::map<counted_string, int> counted;
+    std::map<std::string, int> std_map;
+    for (int i = 0; i < n; ++i) {
+        plain[keys[i]] = i;
+        three_way[keys[i]] = i;
+        transparent[keys[i]] = i;
+        counted[counted_string(keys[i])] = i;
+        std_map[keys[i]] = i;
+    }
+
+    long long hits[5] = {0, 0, 0, 0, 0};
+    std::printf("%d string keys, %d lookups\n", n, lookups);
+    std::printf("sjtu::map less        : %8.1f ms\n", bench_find(plain, probes, hits[0]));
+    std::printf("sjtu::map three-way   : %8.1f ms\n", bench_find(three_way, probes, hits[1]));
+    std::printf("sjtu::map string_view : %8.1f ms\n", bench_find(transparent, views, hits[2]));
+    std::printf("std::map less         : %8.1f ms\n", bench_find(std_map, probes, hits[3]));
+    std::vector<counted_string> counted_probes(probes.begin(), probes.end());
+    key_copies = 0;
+    bench_find(counted, counted_probes, hits[4]);
+    std::printf("key copies per lookup : %.2f\n", (double) key_copies / lookups);
+    for (int i = 1; i < 5; ++i)
+        if (hits[i] != hits[0]) {
+            std::printf("mismatch\n");
+            return 1;
+        }
+    return 0;
+}
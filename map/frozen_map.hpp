@@ -0,0 +1,302 @@
+/**
+ * implement a read-only ordered map searched in Eytzinger layout
+ */
+#ifndef SJTU_FROZEN_MAP_HPP
+#define SJTU_FROZEN_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "map.hpp"
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * an immutable ordered map for data that is built once and then only read.
+ * the elements are kept in one sorted array for iteration, and their keys once more
+ *   in Eytzinger order: the implicit complete binary search tree laid out breadth first, slot k
+ *   with children 2k and 2k + 1. a lookup descends without branches on the comparison
+ *   and prefetches the cache line of its descendants four levels down,
+ *   so the first levels stay in cache and the later ones are in flight before they are read.
+ * find_batch interleaves the descents of several keys to keep more cache misses in flight.
+ *
+ * there are no pointers between elements, a copy is three array copies.
+ */
+template<
+	class Key,
+	class T,
+	class Compare = std::less<Key>
+> class frozen_map : private functor_holder<Compare, 0> {
+public:
+	typedef pair<const Key, T> value_type;
+
+private:
+    // slot k prefetches the slots from prefetch_stride * k on, which are the descendants four levels down
+    static const size_t prefetch_stride=16;
+    // the number of keys that find_batch descends with at once
+    static const size_t batch_width=16;
+
+    // elems[0, length) in key order
+    value_type *elems;
+    // keys[1, length] and rank[1, length] in Eytzinger order, rank[k] is the index in elems of keys[k]
+    Key *keys;
+    size_t *rank;
+    size_t length;
+
+    /**
+     * the comparator of this map, it takes no space if it is empty
+     */
+    inline const Compare &compare() const {return functor_holder<Compare, 0>::get();}
+    inline bool key_less(const Key &a,const Key &b) const {return compare()(a,b);}
+    static inline void prefetch(const void *p){
+#if defined(__GNUC__)
+        __builtin_prefetch(p);
+#else
+        (void) p;
+#endif
+    }
+    /**
+     * undo the trailing right turns of a descent that ended below the leaves:
+     *   the last left turn was at the answer, 0 if there was none
+     */
+    static inline size_t last_left_turn(size_t k){
+#if defined(__GNUC__)
+        return k>>(__builtin_ctzll(~(unsigned long long) k)+1);
+#else
+        while (k&1) k>>=1;
+        return k>>1;
+#endif
+    }
+    /**
+     * the index in elems of the first key not less than x (greater than x if strict), length if none
+     */
+    size_t bound_index(const Key &x,bool strict) const{
+        size_t k=1;
+        while (k<=length){
+            if (prefetch_stride*k<=length) prefetch(keys+prefetch_stride*k);
+            k=2*k+(strict?!key_less(x,keys[k]):key_less(keys[k],x));
+        }
+        k=last_left_turn(k);
+        return k?rank[k]:length;
+    }
+    size_t find_index(const Key &x) const{
+        size_t i=bound_index(x,false);
+        return i<length&&!key_less(x,elems[i].first)?i:length;
+    }
+    /**
+     * fill keys and rank in order over the subtree of slot k, i is the next element to place
+     */
+    void layout(size_t &i,size_t k){
+        if (k>length) return;
+        layout(i,2*k);
+        new(keys+k) Key(elems[i].first);
+        rank[k]=i++;
+        layout(i,2*k+1);
+    }
+    void destroy(){
+        for (size_t i=0;i<length;++i){
+            elems[i].~value_type();
+            keys[i+1].~Key();
+        }
+        free(elems);
+        free(keys);
+        free(rank);
+    }
+    /**
+     * copy the n sorted elements from first on, keys strictly increasing
+     */
+    template<class It>
+    void build(It first,size_t n){
+        length=0;
+        elems=(value_type *) malloc(sizeof(value_type)*(n?n:1));
+        keys=(Key *) malloc(sizeof(Key)*(n+1));
+        rank=(size_t *) malloc(sizeof(size_t)*(n+1));
+        if (!elems||!keys||!rank){
+            free(elems);
+            free(keys);
+            free(rank);
+            throw std::bad_alloc();
+        }
+        for (size_t i=0;i<n;++i,++first) new(elems+i) value_type(*first);
+        length=n;
+        size_t i=0;
+        layout(i,1);
+    }
+
+public:
+	class const_iterator {
+    friend class frozen_map;
+    private:
+        const frozen_map *map_ptr;
+        size_t index;
+    public:
+        const_iterator():map_ptr(nullptr),index(0) {}
+        const_iterator(const const_iterator &other):map_ptr(other.map_ptr),index(other.index) {}
+        const_iterator(const frozen_map *_map_ptr,size_t _index):map_ptr(_map_ptr),index(_index) {}
+        const_iterator & operator=(const const_iterator &other) {
+            map_ptr=other.map_ptr;
+            index=other.index;
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator tmp=*this;
+            ++*this;
+            return tmp;
+        }
+        const_iterator & operator++() {
+            if (!map_ptr||index==map_ptr->length) throw invalid_iterator();
+            ++index;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator tmp=*this;
+            --*this;
+            return tmp;
+        }
+        const_iterator & operator--() {
+            if (!map_ptr||index==0) throw invalid_iterator();
+            --index;
+            return *this;
+        }
+        const value_type & operator*() const {
+            if (!map_ptr||index==map_ptr->length) throw invalid_iterator();
+            return map_ptr->elems[index];
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&index==rhs.index;
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this==rhs);
+        }
+        const value_type* operator->() const noexcept {
+            return map_ptr->elems+index;
+        }
+	};
+	typedef const_iterator iterator;
+
+	frozen_map() {
+        build((const value_type *) nullptr,0);
+    }
+	/**
+	 * an empty map ordered by comp, which is copied into the map and used for every comparison.
+	 */
+	explicit frozen_map(const Compare &comp):functor_holder<Compare, 0>(comp) {
+        build((const value_type *) nullptr,0);
+    }
+	/**
+	 * freeze the contents of a map, searched with its comparator
+	 */
+	template<class Augment>
+	explicit frozen_map(const map<Key, T, Compare, Augment> &other):functor_holder<Compare, 0>(other.key_comp()) {
+        build(other.cbegin(),other.size());
+    }
+	/**
+	 * freeze the elements in [first, last) ordered by comp,
+	 *   a repeated key keeps its first element like in map::insert
+	 */
+	template<class InputIt>
+	frozen_map(InputIt first, InputIt last, const Compare &comp = Compare()):functor_holder<Compare, 0>(comp) {
+        map<Key, T, Compare> tmp(first,last,comp);
+        build(tmp.cbegin(),tmp.size());
+    }
+	frozen_map(const frozen_map &other):functor_holder<Compare, 0>(other) {
+        build(other.elems,other.length);
+    }
+	frozen_map & operator=(const frozen_map &other) {
+        if (this==&other) return *this;
+        destroy();
+        functor_holder<Compare, 0>::operator=(other);
+        build(other.elems,other.length);
+        return *this;
+    }
+	~frozen_map() {
+        destroy();
+    }
+	/**
+	 * access specified element with bounds checking, throw index_out_of_bound if key is not found.
+	 */
+	const T & at(const Key &key) const {
+        size_t i=find_index(key);
+        if (i==length) throw index_out_of_bound();
+        return elems[i].second;
+    }
+	const T & operator[](const Key &key) const {
+        return at(key);
+    }
+	const_iterator begin() const {
+        return const_iterator(this,0);
+    }
+	const_iterator cbegin() const {
+        return begin();
+    }
+	const_iterator end() const {
+        return const_iterator(this,length);
+    }
+	const_iterator cend() const {
+        return end();
+    }
+	bool empty() const {
+        return !length;
+    }
+	size_t size() const {
+        return length;
+    }
+	/**
+	 * returns a copy of the comparator that orders the keys.
+	 */
+	Compare key_comp() const {
+        return compare();
+    }
+	size_t count(const Key &key) const {
+        return find_index(key)<length?1:0;
+    }
+	const_iterator find(const Key &key) const {
+        return const_iterator(this,find_index(key));
+    }
+	const_iterator lower_bound(const Key &key) const {
+        return const_iterator(this,bound_index(key,false));
+    }
+	const_iterator upper_bound(const Key &key) const {
+        return const_iterator(this,bound_index(key,true));
+    }
+	/**
+	 * find every key in [first, last) and write its iterator (end() if not found) to out, in order.
+	 * batch_width descents run in lockstep, so their cache misses overlap.
+	 * KeyIt has to be a forward iterator, the keys are read through it more than once.
+	 */
+	template<class KeyIt, class OutputIt>
+	void find_batch(KeyIt first, KeyIt last, OutputIt out) const {
+        const Key *query[batch_width];
+        size_t k[batch_width];
+        while (first!=last){
+            size_t n=0;
+            for (;n<batch_width&&first!=last;++n,++first){
+                query[n]=&*first;
+                k[n]=1;
+            }
+            // every descent takes the same number of steps, give or take the last level
+            for (bool active=true;active;){
+                active=false;
+                for (size_t j=0;j<n;++j)
+                    if (k[j]<=length){
+                        if (prefetch_stride*k[j]<=length) prefetch(keys+prefetch_stride*k[j]);
+                        k[j]=2*k[j]+key_less(keys[k[j]],*query[j]);
+                        active=true;
+                    }
+            }
+            for (size_t j=0;j<n;++j,++out){
+                size_t i=last_left_turn(k[j]);
+                i=i?rank[i]:length;
+                *out=const_iterator(this,i<length&&!key_less(*query[j],elems[i].first)?i:length);
+            }
+        }
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ * a map from half-open intervals to values that finds the intervals overlapping a point or a range
+ */
+#ifndef SJTU_INTERVAL_MAP_HPP
+#define SJTU_INTERVAL_MAP_HPP
+
+#include <functional>
+#include <cstddef>
+#include "map.hpp"
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * the order of the intervals of interval_map: by start, then by end, with the order of the ends it holds
+ */
+template<class Key, class Compare>
+struct interval_less : private functor_holder<Compare> {
+    interval_less() {}
+    explicit interval_less(const Compare &comp):functor_holder<Compare>(comp) {}
+    const Compare &end_less() const {return functor_holder<Compare>::get();}
+    bool operator()(const pair<Key, Key> &a,const pair<Key, Key> &b) const {
+        const Compare &less=end_less();
+        if (less(a.first,b.first)) return true;
+        if (less(b.first,a.first)) return false;
+        return less(a.second,b.second);
+    }
+};
+
+/**
+ * the node augmentation behind interval_map: the greatest end of the intervals in a subtree.
+ * it points at the end inside that interval's element, which lives as long as its node,
+ *   so no Key is copied and Key needs no default constructor.
+ */
+template<class Key, class Compare>
+struct max_end_augment : private functor_holder<Compare> {
+    struct node_data{
+        const Key *max_end;
+        node_data():max_end(nullptr){}
+    };
+    static const bool enabled=true;
+    max_end_augment() {}
+    explicit max_end_augment(const Compare &comp):functor_holder<Compare>(comp) {}
+    template<class Node>
+    void operator()(Node *rt) const {
+        const Compare &less=functor_holder<Compare>::get();
+        const Key *res=&rt->data->first.second;
+        if (rt->left&&less(*res,*rt->left->max_end)) res=rt->left->max_end;
+        if (rt->right&&less(*res,*rt->right->max_end)) res=rt->right->max_end;
+        rt->max_end=res;
+    }
+};
+
+/**
+ * a sjtu::map whose keys are half-open intervals [first, second), first < second,
+ *   ordered by start and then by end, so equal intervals share one element.
+ * every subtree knows the greatest end in it, kept up by the rotations, erasure, split and join of map,
+ *   so overlap and stab skip the subtrees that end too early and the ones that start too late.
+ * a query reporting k intervals takes O(log n + k) when the matches sit together in the tree,
+ *   and never more than O((k + 1) log n).
+ *
+ * the whole interface of map is there, the values are not part of the augmentation and may be changed freely.
+ */
+template<
+	class Key,
+	class T,
+	class Compare = std::less<Key>
+> class interval_map : public map<pair<Key, Key>, T, interval_less<Key, Compare>, max_end_augment<Key, Compare> > {
+private:
+    typedef map<pair<Key, Key>, T, interval_less<Key, Compare>, max_end_augment<Key, Compare> > base;
+    typedef typename base::AvlNode AvlNode;
+
+    inline bool less(const Key &a,const Key &b) const {return this->compare().end_less()(a,b);}
+    /**
+     * report the intervals in the subtree rt that start before hi (or at point if closed)
+     *   and end after lo, in order
+     */
+    template<class F>
+    void collect(AvlNode *rt,const Key &lo,const Key &hi,bool closed,F &f) const{
+        while (rt&&less(lo,*rt->max_end)){
+            collect(rt->left,lo,hi,closed,f);
+            const pair<Key, Key> &x=rt->data->first;
+            if (closed?less(hi,x.first):!less(x.first,hi)) return;
+            if (less(lo,x.second)) f(const_cast<const typename base::value_type &>(*rt->data));
+            rt=rt->right;
+        }
+    }
+
+public:
+    typedef pair<Key, Key> interval_type;
+    typedef typename base::value_type value_type;
+
+	interval_map() {}
+	/**
+	 * an empty map whose interval ends are ordered by comp
+	 */
+	explicit interval_map(const Compare &comp)
+        :base(interval_less<Key, Compare>(comp),max_end_augment<Key, Compare>(comp)) {}
+	interval_map(const interval_map &other):base(other) {}
+	interval_map & operator=(const interval_map &other) {
+        base::operator=(other);
+        return *this;
+    }
+	/**
+	 * call f(const value_type &) on every element whose interval overlaps [lo, hi), in order
+	 */
+	template<class F>
+	void overlap(const Key &lo, const Key &hi, F f) const {
+        collect(this->end_node->left,lo,hi,false,f);
+    }
+	/**
+	 * call f(const value_type &) on every element whose interval contains point, in order
+	 */
+	template<class F>
+	void stab(const Key &point, F f) const {
+        collect(this->end_node->left,point,point,true,f);
+    }
+	/**
+	 * whether any interval overlaps [lo, hi), in O(log n)
+	 */
+	bool overlaps(const Key &lo, const Key &hi) const {
+        AvlNode *rt=this->end_node->left;
+        while (rt){
+            const interval_type &x=rt->data->first;
+            if (less(x.first,hi)&&less(lo,x.second)) return true;
+            // if the left subtree ends after lo but has no overlap, its latest interval starts at hi or later,
+            //   and so does everything on the right
+            rt=rt->left&&less(lo,*rt->left->max_end)?rt->left:rt->right;
+        }
+        return false;
+    }
+};
+
+}
+
+#endif
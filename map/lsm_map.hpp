@@ -0,0 +1,678 @@
+/**
+ * implement a write-optimized ordered map as an in-memory log-structured merge tree
+ */
+#ifndef SJTU_LSM_MAP_HPP
+#define SJTU_LSM_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * an ordered map for ingest-heavy workloads.
+ * writes go into a small sorted buffer that stays in cache. a full buffer becomes an immutable sorted run,
+ *   and runs of similar size are merged with sequential passes, so every entry is copied
+ *   O(log n) times in total instead of paying O(log n) cache misses and a rebalance on every insert.
+ * an erase writes a tombstone, which shadows the older entries of its key until the merge into the oldest run.
+ *   everything is merged once tombstones are the majority, or once iterators have stepped over
+ *   more of them than there are entries, so the merge is paid for by the work it saves.
+ * a lookup searches the buffer and then the runs from the newest on and stops at the first entry of its key.
+ * an iterator merges the runs on the fly.
+ *
+ * insert and erase(key) look the key up first to return what sjtu::map returns.
+ * put and remove write blindly and are the fast path. after them the next size() counts the keys
+ *   with a merging scan, which moves nothing.
+ * compact merges every run by hand, after a bulk load for example.
+ *
+ * any write invalidates all iterators and the references returned by at and operator[].
+ */
+template<
+	class Key,
+	class T,
+	class Compare = std::less<Key>
+> class lsm_map : private functor_holder<Compare, 0> {
+public:
+	typedef pair<const Key, T> value_type;
+
+private:
+    // entries in the write buffer
+    static const size_t buffer_size=512;
+    // a run is merged into the next older one while that is not more than growth times larger
+    static const size_t growth=2;
+    // the runs grow geometrically, their number stays near log2(n / buffer_size)
+    static const size_t max_runs=40;
+
+    struct Entry{
+        value_type data;
+        // a tombstone: the key was erased
+        bool dead;
+        Entry(const value_type &x,bool d):data(x),dead(d){}
+    };
+    // elems[0, size) sorted by key, keys unique, dead of them tombstones
+    struct Run{
+        Entry *elems;
+        size_t size;
+        size_t dead;
+    };
+    /**
+     * a position in the merged order: the entry src, idx it shows, src = npos for end.
+     * pos, the position in every source, is worked out on the first move only,
+     *   so find and insert stop at the first source that has the key
+     */
+    static const size_t npos=(size_t) -1;
+    struct Cursor{
+        size_t src;
+        size_t idx;
+        bool resolved;
+        size_t sources;
+        size_t pos[max_runs+1];
+        Cursor():src(npos),idx(0),resolved(false),sources(0){}
+        Cursor(size_t _src,size_t _idx):src(_src),idx(_idx),resolved(false),sources(0){}
+        Cursor(const Cursor &other):src(other.src),idx(other.idx),resolved(other.resolved),sources(other.sources){
+            for (size_t i=0;i<sources;++i) pos[i]=other.pos[i];
+        }
+        Cursor &operator=(const Cursor &other){
+            src=other.src;
+            idx=other.idx;
+            resolved=other.resolved;
+            sources=other.sources;
+            for (size_t i=0;i<sources;++i) pos[i]=other.pos[i];
+            return *this;
+        }
+    };
+
+    // source 0 is the buffer, source i > 0 the i-th newest run
+    Run buffer;
+    // runs[0] is the oldest and largest
+    Run runs[max_runs];
+    size_t run_count;
+    // the number of live keys, unless a blind write has made it unknown until size() counts again
+    mutable size_t length;
+    mutable bool counted;
+    // the tombstones iterators stepped over since the last full merge
+    mutable size_t skipped;
+
+    /**
+     * the comparator of this map, it takes no space if it is empty
+     */
+    inline const Compare &compare() const {return functor_holder<Compare, 0>::get();}
+    inline bool key_less(const Key &a,const Key &b) const {return compare()(a,b);}
+
+    static Entry *allocate(size_t n){
+        Entry *p=(Entry *) malloc(sizeof(Entry)*(n?n:1));
+        if (!p) throw std::bad_alloc();
+        return p;
+    }
+    static void free_run(Run &r){
+        for (size_t i=0;i<r.size;++i) r.elems[i].~Entry();
+        free(r.elems);
+        r.elems=nullptr;
+        r.size=r.dead=0;
+    }
+    size_t source_count() const {return run_count+1;}
+    const Run &source(size_t i) const {return i?runs[run_count-i]:buffer;}
+    Entry &entry(size_t i,size_t idx) const {return source(i).elems[idx];}
+
+    /**
+     * the index of the first entry of r not less than key (greater than key if strict)
+     */
+    size_t bound(const Run &r,const Key &key,bool strict) const{
+        size_t lo=0,n=r.size;
+        while (n){
+            size_t half=n/2;
+            if (strict?!key_less(key,r.elems[lo+half].data.first):key_less(r.elems[lo+half].data.first,key)){
+                lo+=half+1;
+                n-=half+1;
+            }else
+                n=half;
+        }
+        return lo;
+    }
+    /**
+     * the newest entry of key, dead or alive, as a cursor, src = npos if there is none
+     */
+    Cursor newest(const Key &key) const{
+        for (size_t i=0;i<source_count();++i){
+            const Run &r=source(i);
+            size_t idx=bound(r,key,false);
+            if (idx<r.size&&!key_less(key,r.elems[idx].data.first)) return Cursor(i,idx);
+        }
+        return Cursor();
+    }
+
+    /**
+     * merge newer into older, the entry of newer wins on equal keys. tombstones are dropped
+     *   if older is the oldest run, nothing below can be shadowed then
+     */
+    Run merge(const Run &older,const Run &newer,bool drop_dead){
+        Run res;
+        res.elems=allocate(older.size+newer.size);
+        res.size=res.dead=0;
+        size_t i=0,j=0;
+        try{
+            while (i<older.size||j<newer.size){
+                const Entry *e;
+                if (j==newer.size||(i<older.size&&key_less(older.elems[i].data.first,newer.elems[j].data.first)))
+                    e=older.elems+i++;
+                else{
+                    if (i<older.size&&!key_less(newer.elems[j].data.first,older.elems[i].data.first)) ++i;
+                    e=newer.elems+j++;
+                }
+                if (drop_dead&&e->dead) continue;
+                new(res.elems+res.size) Entry(*e);
+                ++res.size;
+                res.dead+=e->dead;
+            }
+        }catch (...){
+            free_run(res);
+            throw;
+        }
+        return res;
+    }
+    /**
+     * merge the two newest runs
+     */
+    void merge_newest(){
+        Run res=merge(runs[run_count-2],runs[run_count-1],run_count==2);
+        free_run(runs[run_count-2]);
+        free_run(runs[run_count-1]);
+        --run_count;
+        runs[run_count-1]=res;
+        if (!res.size){
+            free_run(runs[run_count-1]);
+            --run_count;
+        }
+    }
+    /**
+     * turn the buffer into the newest run and merge the runs that got too close in size
+     */
+    void flush(){
+        if (!buffer.size) return;
+        Entry *fresh=allocate(buffer_size);
+        if (run_count==max_runs) merge_newest();
+        runs[run_count++]=buffer;
+        buffer.elems=fresh;
+        buffer.size=buffer.dead=0;
+        while (run_count>=2&&runs[run_count-2].size<=growth*runs[run_count-1].size) merge_newest();
+    }
+    /**
+     * merge everything into one run, which has no tombstones, and count it
+     */
+    void merge_all(){
+        flush();
+        while (run_count>=2) merge_newest();
+        if (run_count==1){
+            Run res=merge(runs[0],Run{nullptr,0,0},true);
+            free_run(runs[0]);
+            runs[0]=res;
+            if (!res.size){
+                free_run(runs[0]);
+                run_count=0;
+            }
+        }
+        length=run_count?runs[0].size:0;
+        counted=true;
+        skipped=0;
+    }
+    /**
+     * write a tombstone, and merge everything once tombstones outnumber the live entries:
+     *   iterators step over them, and nothing but the merge into the oldest run drops them
+     */
+    void write_dead(const value_type &value){
+        write(value,true);
+        size_t dead=buffer.dead;
+        for (size_t i=0;i<run_count;++i) dead+=runs[i].dead;
+        if (2*dead>entries()+buffer_size) merge_all();
+    }
+    /**
+     * before a write: scans that stepped over more tombstones than there are entries have paid for a full merge
+     */
+    void tidy(){
+        if (skipped>buffer_size&&skipped>entries()) merge_all();
+    }
+    size_t entries() const{
+        size_t res=buffer.size;
+        for (size_t i=0;i<run_count;++i) res+=runs[i].size;
+        return res;
+    }
+    /**
+     * write an entry into the buffer, replacing the buffered one of its key, and return it
+     */
+    Entry *write(const value_type &value,bool dead){
+        // value may live in the buffer, copy it before anything moves
+        Entry e(value,dead);
+        size_t idx=bound(buffer,e.data.first,false);
+        if (idx<buffer.size&&!key_less(e.data.first,buffer.elems[idx].data.first)){
+            buffer.dead+=(size_t) dead-buffer.elems[idx].dead;
+            buffer.elems[idx].~Entry();
+            return new(buffer.elems+idx) Entry(e);
+        }
+        if (buffer.size==buffer_size){
+            flush();
+            idx=0;
+        }
+        for (size_t i=buffer.size;i>idx;--i){
+            new(buffer.elems+i) Entry(buffer.elems[i-1]);
+            buffer.elems[i-1].~Entry();
+        }
+        ++buffer.size;
+        buffer.dead+=dead;
+        return new(buffer.elems+idx) Entry(e);
+    }
+    /**
+     * the source holding the newest entry of the least key at the positions of c, npos if all are at their end
+     */
+    size_t front(const Cursor &c) const{
+        size_t best=npos;
+        for (size_t i=0;i<c.sources;++i)
+            if (c.pos[i]<source(i).size&&(best==npos||key_less(entry(i,c.pos[i]).data.first,entry(best,c.pos[best]).data.first)))
+                best=i;
+        return best;
+    }
+    void settle(Cursor &c) const{
+        c.src=front(c);
+        c.idx=c.src==npos?0:c.pos[c.src];
+    }
+    /**
+     * place every source at the first entry not less than key (greater if strict), skip tombstones forward
+     */
+    Cursor seek(const Key &key,bool strict) const{
+        Cursor c;
+        c.resolved=true;
+        c.sources=source_count();
+        for (size_t i=0;i<c.sources;++i) c.pos[i]=bound(source(i),key,strict);
+        settle(c);
+        skip_forward(c);
+        return c;
+    }
+    void resolve(Cursor &c) const{
+        if (c.resolved) return;
+        c=c.src==npos?end_cursor():seek(entry(c.src,c.idx).data.first,false);
+    }
+    Cursor end_cursor() const{
+        Cursor c;
+        c.resolved=true;
+        c.sources=source_count();
+        for (size_t i=0;i<c.sources;++i) c.pos[i]=source(i).size;
+        return c;
+    }
+    /**
+     * move every source past the key of c
+     */
+    void step_forward(Cursor &c) const{
+        const Key &key=entry(c.src,c.idx).data.first;
+        for (size_t i=0;i<c.sources;++i)
+            if (i!=c.src&&c.pos[i]<source(i).size&&!key_less(key,entry(i,c.pos[i]).data.first)) ++c.pos[i];
+        ++c.pos[c.src];
+        settle(c);
+    }
+    void skip_forward(Cursor &c) const{
+        while (c.src!=npos&&entry(c.src,c.idx).dead){
+            step_forward(c);
+            ++skipped;
+        }
+    }
+    /**
+     * move c to the greatest live key before it, return false and leave c as it was if there is none
+     */
+    bool step_backward(Cursor &c) const{
+        Cursor save=c;
+        while (true){
+            size_t best=npos;
+            for (size_t i=0;i<c.sources;++i)
+                if (c.pos[i]&&(best==npos||key_less(entry(best,c.pos[best]-1).data.first,entry(i,c.pos[i]-1).data.first)))
+                    best=i;
+            if (best==npos){
+                c=save;
+                return false;
+            }
+            const Key &key=entry(best,c.pos[best]-1).data.first;
+            for (size_t i=0;i<c.sources;++i)
+                if (i!=best&&c.pos[i]&&!key_less(entry(i,c.pos[i]-1).data.first,key)) --c.pos[i];
+            --c.pos[best];
+            settle(c);
+            if (!entry(c.src,c.idx).dead) return true;
+            ++skipped;
+        }
+    }
+    Cursor begin_cursor() const{
+        Cursor c;
+        c.resolved=true;
+        c.sources=source_count();
+        for (size_t i=0;i<c.sources;++i) c.pos[i]=0;
+        settle(c);
+        skip_forward(c);
+        return c;
+    }
+    /**
+     * the number of live keys by a merging scan over every source, iterators stay valid
+     */
+    size_t count_live() const{
+        size_t res=0;
+        Cursor c;
+        c.resolved=true;
+        c.sources=source_count();
+        for (size_t i=0;i<c.sources;++i) c.pos[i]=0;
+        for (settle(c);c.src!=npos;step_forward(c)) res+=!entry(c.src,c.idx).dead;
+        return res;
+    }
+    Entry *current(const Cursor &c) const{
+        return c.src==npos?nullptr:&entry(c.src,c.idx);
+    }
+    void init(){
+        buffer.elems=allocate(buffer_size);
+        buffer.size=buffer.dead=0;
+        run_count=0;
+        length=0;
+        counted=true;
+        skipped=0;
+    }
+    void destroy(){
+        free_run(buffer);
+        for (size_t i=0;i<run_count;++i) free_run(runs[i]);
+        run_count=0;
+    }
+    void copy_from(const lsm_map &other){
+        for (size_t i=0;i<other.buffer.size;++i){
+            new(buffer.elems+i) Entry(other.buffer.elems[i]);
+            ++buffer.size;
+        }
+        buffer.dead=other.buffer.dead;
+        for (size_t i=0;i<other.run_count;++i){
+            runs[i]=merge(other.runs[i],Run{nullptr,0,0},false);
+            ++run_count;
+        }
+        length=other.length;
+        counted=other.counted;
+    }
+
+public:
+	class const_iterator;
+	class iterator {
+        friend class lsm_map;
+	private:
+        lsm_map *map_ptr;
+        Cursor cur;
+	public:
+		iterator():map_ptr(nullptr) {}
+		iterator(const iterator &other):map_ptr(other.map_ptr),cur(other.cur) {}
+        iterator(lsm_map *_map_ptr,const Cursor &_cur):map_ptr(_map_ptr),cur(_cur) {}
+		iterator operator++(int) {
+            iterator tmp=*this;
+            ++*this;
+            return tmp;
+        }
+		iterator & operator++() {
+            if (!map_ptr||cur.src==npos) throw invalid_iterator();
+            map_ptr->resolve(cur);
+            map_ptr->step_forward(cur);
+            map_ptr->skip_forward(cur);
+            return *this;
+        }
+		iterator operator--(int) {
+            iterator tmp=*this;
+            --*this;
+            return tmp;
+        }
+		iterator & operator--() {
+            if (!map_ptr) throw invalid_iterator();
+            map_ptr->resolve(cur);
+            if (!map_ptr->step_backward(cur)) throw invalid_iterator();
+            return *this;
+        }
+		value_type & operator*() const {
+            if (!map_ptr||cur.src==npos) throw invalid_iterator();
+            return map_ptr->current(cur)->data;
+        }
+		bool operator==(const iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&(!map_ptr||map_ptr->current(cur)==map_ptr->current(rhs.cur));
+        }
+		bool operator==(const const_iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&(!map_ptr||map_ptr->current(cur)==map_ptr->current(rhs.cur));
+        }
+		bool operator!=(const iterator &rhs) const {
+            return !(*this==rhs);
+        }
+		bool operator!=(const const_iterator &rhs) const {
+            return !(*this==rhs);
+        }
+		value_type* operator->() const noexcept {
+            return &map_ptr->current(cur)->data;
+        }
+	};
+	class const_iterator {
+    friend class lsm_map;
+    private:
+        const lsm_map *map_ptr;
+        Cursor cur;
+    public:
+        const_iterator():map_ptr(nullptr) {}
+        const_iterator(const const_iterator &other):map_ptr(other.map_ptr),cur(other.cur) {}
+        const_iterator(const iterator &other):map_ptr(other.map_ptr),cur(other.cur) {}
+        const_iterator(const lsm_map *_map_ptr,const Cursor &_cur):map_ptr(_map_ptr),cur(_cur) {}
+        const_iterator operator++(int) {
+            const_iterator tmp=*this;
+            ++*this;
+            return tmp;
+        }
+        const_iterator & operator++() {
+            if (!map_ptr||cur.src==npos) throw invalid_iterator();
+            map_ptr->resolve(cur);
+            map_ptr->step_forward(cur);
+            map_ptr->skip_forward(cur);
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator tmp=*this;
+            --*this;
+            return tmp;
+        }
+        const_iterator & operator--() {
+            if (!map_ptr) throw invalid_iterator();
+            map_ptr->resolve(cur);
+            if (!map_ptr->step_backward(cur)) throw invalid_iterator();
+            return *this;
+        }
+        const value_type & operator*() const {
+            if (!map_ptr||cur.src==npos) throw invalid_iterator();
+            return map_ptr->current(cur)->data;
+        }
+        bool operator==(const iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&(!map_ptr||map_ptr->current(cur)==map_ptr->current(rhs.cur));
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&(!map_ptr||map_ptr->current(cur)==map_ptr->current(rhs.cur));
+        }
+        bool operator!=(const iterator &rhs) const {
+            return !(*this==rhs);
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this==rhs);
+        }
+        const value_type* operator->() const noexcept {
+            return &map_ptr->current(cur)->data;
+        }
+	};
+
+	lsm_map() {
+        init();
+    }
+	/**
+	 * an empty map ordered by comp, which is copied into the map and used for every comparison.
+	 */
+	explicit lsm_map(const Compare &comp):functor_holder<Compare, 0>(comp) {
+        init();
+    }
+	lsm_map(const lsm_map &other):functor_holder<Compare, 0>(other) {
+        init();
+        try{
+            copy_from(other);
+        }catch (...){
+            destroy();
+            throw;
+        }
+    }
+	lsm_map & operator=(const lsm_map &other) {
+        if (this==&other) return *this;
+        clear();
+        functor_holder<Compare, 0>::operator=(other);
+        copy_from(other);
+        return *this;
+    }
+	~lsm_map() {
+        destroy();
+    }
+	/**
+	 * access specified element with bounds checking, throw index_out_of_bound if key is not found.
+	 */
+	T & at(const Key &key) {
+        Entry *e=current(newest(key));
+        if (!e||e->dead) throw index_out_of_bound();
+        return e->data.second;
+    }
+	const T & at(const Key &key) const {
+        Entry *e=current(newest(key));
+        if (!e||e->dead) throw index_out_of_bound();
+        return e->data.second;
+    }
+	/**
+	 * access specified element, inserting a default constructed value if key does not exist.
+	 */
+	T & operator[](const Key &key) {
+        tidy();
+        Entry *e=current(newest(key));
+        if (e&&!e->dead) return e->data.second;
+        if (counted) ++length;
+        return write(value_type(key,T()),false)->data.second;
+    }
+	const T & operator[](const Key &key) const {
+        return at(key);
+    }
+	iterator begin() {
+        return iterator(this,begin_cursor());
+    }
+	const_iterator cbegin() const {
+        return const_iterator(this,begin_cursor());
+    }
+	iterator end() {
+        return iterator(this,Cursor());
+    }
+	const_iterator cend() const {
+        return const_iterator(this,Cursor());
+    }
+	bool empty() const {
+        return !size();
+    }
+	/**
+	 * the number of elements, counted by a scan if put or remove was called since the last count
+	 */
+	size_t size() const {
+        if (!counted){
+            length=count_live();
+            counted=true;
+        }
+        return length;
+    }
+	/**
+	 * returns a copy of the comparator that orders the keys.
+	 */
+	Compare key_comp() const {
+        return compare();
+    }
+	void clear() {
+        destroy();
+        buffer.elems=allocate(buffer_size);
+        length=0;
+        counted=true;
+        skipped=0;
+    }
+	/**
+	 * insert an element, return the iterator to the element with its key and whether it was inserted.
+	 */
+	pair<iterator, bool> insert(const value_type &value) {
+        tidy();
+        Cursor c=newest(value.first);
+        if (c.src!=npos&&!current(c)->dead) return pair<iterator, bool>(iterator(this,c),false);
+        if (counted) ++length;
+        write(value,false);
+        return pair<iterator, bool>(iterator(this,newest(value.first)),true);
+    }
+	/**
+	 * set the value of value.first without looking it up, inserting or overwriting
+	 */
+	void put(const value_type &value) {
+        tidy();
+        counted=false;
+        write(value,false);
+    }
+	/**
+	 * erase key without looking it up, whether it exists or not
+	 */
+	void remove(const Key &key) {
+        tidy();
+        counted=false;
+        write_dead(value_type(key,T()));
+    }
+	/**
+	 * erase the element at pos, throw invalid_iterator if pos is end() or belongs to another map.
+	 */
+	void erase(iterator pos) {
+        if (pos.map_ptr!=this||pos.cur.src==npos) throw invalid_iterator();
+        // a merge moves the element of pos
+        value_type value(current(pos.cur)->data);
+        tidy();
+        if (counted) --length;
+        write_dead(value);
+    }
+	/**
+	 * erase the element with key, return the number of erased elements (0 or 1).
+	 */
+	size_t erase(const Key &key) {
+        tidy();
+        Entry *e=current(newest(key));
+        if (!e||e->dead) return 0;
+        if (counted) --length;
+        write_dead(e->data);
+        return 1;
+    }
+	size_t count(const Key &key) const {
+        Entry *e=current(newest(key));
+        return e&&!e->dead?1:0;
+    }
+	iterator find(const Key &key) {
+        Cursor c=newest(key);
+        return iterator(this,c.src!=npos&&!current(c)->dead?c:Cursor());
+    }
+	const_iterator find(const Key &key) const {
+        Cursor c=newest(key);
+        return const_iterator(this,c.src!=npos&&!current(c)->dead?c:Cursor());
+    }
+	iterator lower_bound(const Key &key) {
+        return iterator(this,seek(key,false));
+    }
+	const_iterator lower_bound(const Key &key) const {
+        return const_iterator(this,seek(key,false));
+    }
+	iterator upper_bound(const Key &key) {
+        return iterator(this,seek(key,true));
+    }
+	const_iterator upper_bound(const Key &key) const {
+        return const_iterator(this,seek(key,true));
+    }
+	/**
+	 * merge every run into one, which makes the following reads as fast as they get
+	 */
+	void compact() {
+        merge_all();
+    }
+};
+
+}
+
+#endif
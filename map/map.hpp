@@ -7,16 +7,50 @@
 // only for std::less<T>
 #include <functional>
 #include <cstddef>
+#include <new>
+#include <type_traits>
 #include "utility.hpp"
 #include "exceptions.hpp"
 
+/**
+ * keep the size of every subtree in the nodes, so that select, rank and iterator distance take O(log n).
+ * define it to 0 before including this header to save the field and its upkeep,
+ *   then those operations walk the elements in O(n).
+ */
+#ifndef SJTU_MAP_ORDER_STATISTICS
+#define SJTU_MAP_ORDER_STATISTICS 1
+#endif
+
 namespace sjtu {
 
+namespace detail {
+// runs the two halves of a set operation of map one after the other
+struct serial_fork{
+    template<class F,class G> static void run(F &&f,G &&g){ f(); g(); }
+};
+// runs them on two threads for the set operations with a thread count, defined in parallel.hpp
+template<class Map> struct thread_fork;
+}
+
+/**
+ * the default node augmentation of map, which keeps nothing.
+ * an augmentation adds node_data to every node and recomputes it with operator()
+ *   from the node and its children whenever the subtree of the node changes.
+ * the map keeps a copy of it like of the comparator, so it may carry state.
+ */
+struct map_no_augment{
+    struct node_data{};
+    static const bool enabled=false;
+    template<class Node>
+    void operator()(Node *) const {}
+};
+
 template<
 	class Key,
 	class T,
-	class Compare = std::less<Key>
-> class map {
+	class Compare = std::less<Key>,
+	class Augment = map_no_augment
+> class map : private functor_holder<Compare, 0>, private functor_holder<Augment, 1> {
 public:
 	/**
 	 * the internal type of data.
@@ -31,18 +65,45 @@ public:
 	 *     like it = map.begin(); --it;
 	 *       or it = map.end(); ++end();
 	 */
-private:
-    struct AvlNode{
+protected:
+    template<class Map> friend struct detail::thread_fork;
+    // selects the node constructor that builds the element in place from its arguments
+    struct emplace_tag{};
+    struct AvlNode:Augment::node_data{
         value_type *data;
         AvlNode *parent;
         AvlNode *left;
         AvlNode *right;
+        // neighbours in key order, the list is closed into a ring by end_node
+        AvlNode *prev;
+        AvlNode *next;
         size_t height;
-        AvlNode():data(nullptr),parent(nullptr),left(nullptr),right(nullptr),height(0){}
-        AvlNode(const value_type &x,AvlNode *p=nullptr,AvlNode *l=nullptr,AvlNode *r=nullptr,size_t h=1):parent(p),left(l),right(r),height(h){
+#if SJTU_MAP_ORDER_STATISTICS
+        size_t size;
+        AvlNode():data(nullptr),parent(nullptr),left(nullptr),right(nullptr),prev(nullptr),next(nullptr),height(0),size(0){}
+        AvlNode(const value_type &x,AvlNode *p=nullptr,AvlNode *l=nullptr,AvlNode *r=nullptr,size_t h=1):parent(p),left(l),right(r),prev(nullptr),next(nullptr),height(h),size(1){
+#else
+        AvlNode():data(nullptr),parent(nullptr),left(nullptr),right(nullptr),prev(nullptr),next(nullptr),height(0){}
+        AvlNode(const value_type &x,AvlNode *p=nullptr,AvlNode *l=nullptr,AvlNode *r=nullptr,size_t h=1):parent(p),left(l),right(r),prev(nullptr),next(nullptr),height(h){
+#endif
             data=(value_type *) malloc(sizeof(value_type));
             new(data) value_type(x.first,x.second);
         }
+        template<class... Args>
+#if SJTU_MAP_ORDER_STATISTICS
+        AvlNode(emplace_tag,AvlNode *p,Args&&... args):parent(p),left(nullptr),right(nullptr),prev(nullptr),next(nullptr),height(1),size(1){
+#else
+        AvlNode(emplace_tag,AvlNode *p,Args&&... args):parent(p),left(nullptr),right(nullptr),prev(nullptr),next(nullptr),height(1){
+#endif
+            data=(value_type *) malloc(sizeof(value_type));
+            if (!data) throw std::bad_alloc();
+            try{
+                new(data) value_type(std::forward<Args>(args)...);
+            }catch (...){
+                free(data);
+                throw;
+            }
+        }
         ~AvlNode(){
             if (data){
                 data->first.~Key();
@@ -52,173 +113,698 @@ private:
         }
     };
 
-    // AvlNode *root;
+    /**
+     * end_node is the header: the root hangs on end_node->left,
+     * end_node->next is the leftmost node and end_node->prev the rightmost one
+     */
     AvlNode *end_node;
     size_t length;
+    static const size_t range_erase_limit=16;
 
     inline size_t maxHeight(size_t x,size_t y) const {return x>y?x:y;}
-    inline bool equal_key(Key x,Key y) const {return !(Compare()(x,y)||Compare()(y,x));}
     inline size_t height(AvlNode *rt) const {return rt?rt->height:0;}
-    AvlNode *find_begin() const{
-        AvlNode *p=end_node;
-        while (p->left) p=p->left;
-        return p;
+    /**
+     * the link in the parent of rt that points to rt
+     * the root hangs on end_node->left, so this also works for the root
+     */
+    inline AvlNode *&link(AvlNode *rt) const {return rt->parent->left==rt?rt->parent->left:rt->parent->right;}
+#if SJTU_MAP_ORDER_STATISTICS
+    inline size_t subtree_size(AvlNode *rt) const {return rt?rt->size:0;}
+    inline void update_size(AvlNode *rt) const {rt->size=subtree_size(rt->left)+subtree_size(rt->right)+1;}
+#else
+    inline void update_size(AvlNode *) const {}
+#endif
+    /**
+     * whether anything besides the height has to be kept up to date on the way to the root
+     */
+    static const bool summarized=SJTU_MAP_ORDER_STATISTICS||Augment::enabled;
+    inline void update_summary(AvlNode *rt) const {
+        update_size(rt);
+        augment()(rt);
+    }
+    inline void update(AvlNode *rt) const {
+        rt->height=maxHeight(height(rt->left),height(rt->right))+1;
+        update_summary(rt);
+    }
+    inline void init_header(){
+        end_node->left=nullptr;
+        end_node->prev=end_node->next=end_node;
     }
-    void copy(AvlNode *&rt,AvlNode *other) const{
+    /**
+     * copy the subtree of other under pa, threading the new nodes in order after last
+     */
+    void copy(AvlNode *&rt,AvlNode *other,AvlNode *pa,AvlNode *&last) const{
         if (!other) return;
-        rt=new AvlNode(*(other->data));
+        rt=new AvlNode(*(other->data),pa);
         rt->height=other->height;
-        copy(rt->left,other->left);
-        if (rt->left) rt->left->parent=rt;
-        copy(rt->right,other->right);
-        if (rt->right) rt->right->parent=rt;
+        copy(rt->left,other->left,rt,last);
+        last->next=rt;
+        rt->prev=last;
+        last=rt;
+        copy(rt->right,other->right,rt,last);
+        update_summary(rt);
     }
-    void clear(AvlNode *rt){
-        if (!rt) return;
-        clear(rt->left);
-        clear(rt->right);
-        delete rt;
+    void copy(const map &other){
+        AvlNode *last=end_node;
+        copy(end_node->left,other.end_node->left,end_node,last);
+        last->next=end_node;
+        end_node->prev=last;
     }
-    AvlNode *find_node(const Key &x,AvlNode *&rt) const{
-        if (!rt||equal_key(rt->data->first,x)) return rt;
-        if (Compare()(x,rt->data->first))
-            return find_node(x,rt->left);
-        else
-            return find_node(x,rt->right);
+    /**
+     * free every node along the thread, no recursion needed
+     */
+    void clear_nodes(){
+        AvlNode *p=end_node->next;
+        while (p!=end_node){
+            AvlNode *q=p->next;
+            delete p;
+            p=q;
+        }
+        init_header();
     }
-    void LL(AvlNode *&rt){
+    template<class...> struct void_type{ typedef void type; };
+    /**
+     * a comparator that declares is_three_way returns an int-like value: <0, 0 or >0,
+     * so every visited node needs only one comparison
+     */
+    template<class C,class=void> struct is_three_way:std::false_type{};
+    template<class C> struct is_three_way<C,typename void_type<typename C::is_three_way>::type>:std::true_type{};
+    typedef is_three_way<Compare> three_way;
+
+    /**
+     * the comparator of this map, it takes no space if it is empty
+     */
+    inline const Compare &compare() const {return functor_holder<Compare, 0>::get();}
+    /**
+     * the node augmentation of this map, kept like the comparator
+     */
+    inline const Augment &augment() const {return functor_holder<Augment, 1>::get();}
+    template<class A,class B>
+    inline bool key_less(const A &x,const B &y,std::false_type) const {return compare()(x,y);}
+    template<class A,class B>
+    inline bool key_less(const A &x,const B &y,std::true_type) const {return compare()(x,y)<0;}
+    template<class A,class B>
+    inline bool key_less(const A &x,const B &y) const {return key_less(x,y,three_way());}
+    /**
+     * the first node whose key is not less than x, or nullptr
+     * K is Key, or any type Compare accepts if it is transparent
+     */
+    template<class K>
+    AvlNode *lower_bound_node(const K &x) const{
+        AvlNode *p=end_node->left,*res=nullptr;
+        while (p){
+            if (key_less(p->data->first,x))
+                p=p->right;
+            else{
+                res=p;
+                p=p->left;
+            }
+        }
+        return res;
+    }
+    /**
+     * the first node whose key is greater than x, or nullptr
+     */
+    template<class K>
+    AvlNode *upper_bound_node(const K &x) const{
+        AvlNode *p=end_node->left,*res=nullptr;
+        while (p){
+            if (key_less(x,p->data->first)){
+                res=p;
+                p=p->left;
+            }else
+                p=p->right;
+        }
+        return res;
+    }
+    /**
+     * with a two-way comparator descend to the lower bound and test equality once at the end,
+     * with a three-way one stop at the first equal key
+     */
+    template<class K>
+    AvlNode *find_node(const K &x,std::false_type) const{
+        AvlNode *p=lower_bound_node(x);
+        return p&&!compare()(x,p->data->first)?p:nullptr;
+    }
+    template<class K>
+    AvlNode *find_node(const K &x,std::true_type) const{
+        AvlNode *p=end_node->left;
+        while (p){
+            auto c=compare()(x,p->data->first);
+            if (c<0)
+                p=p->left;
+            else if (c>0)
+                p=p->right;
+            else
+                return p;
+        }
+        return nullptr;
+    }
+    template<class K>
+    AvlNode *find_node(const K &x) const{
+        return find_node(x,three_way());
+    }
+    /**
+     * the link where a node with key x is to be inserted, and its parent in pa,
+     * or nullptr and the node with an equal key in pa
+     */
+    AvlNode **insert_pos(const Key &x,AvlNode *&pa,std::false_type) const{
+        AvlNode **pos=&end_node->left,*prev=nullptr;
+        pa=end_node;
+        while (*pos){
+            pa=*pos;
+            if (compare()(x,pa->data->first))
+                pos=&pa->left;
+            else{
+                prev=pa;
+                pos=&pa->right;
+            }
+        }
+        if (prev&&!compare()(prev->data->first,x)){
+            pa=prev;
+            return nullptr;
+        }
+        return pos;
+    }
+    AvlNode **insert_pos(const Key &x,AvlNode *&pa,std::true_type) const{
+        AvlNode **pos=&end_node->left;
+        pa=end_node;
+        while (*pos){
+            pa=*pos;
+            auto c=compare()(x,pa->data->first);
+            if (c<0)
+                pos=&pa->left;
+            else if (c>0)
+                pos=&pa->right;
+            else
+                return nullptr;
+        }
+        return pos;
+    }
+    /**
+     * rotations keep the parent links and the link from the parent of rt,
+     * and return the new root of the subtree
+     */
+    AvlNode *LL(AvlNode *rt){
         AvlNode *rt1=rt->left;
+        link(rt)=rt1;
         rt1->parent=rt->parent;
         rt->left=rt1->right;
         if (rt1->right) rt1->right->parent=rt;
         rt1->right=rt;
         rt->parent=rt1;
-        rt->height=maxHeight(height(rt->left),height(rt->right))+1;
-        rt1->height=maxHeight(height(rt1->left),height(rt))+1;
-        rt=rt1;
+        update(rt);
+        update(rt1);
+        return rt1;
     }
-    void RR(AvlNode *&rt){
+    AvlNode *RR(AvlNode *rt){
         AvlNode *rt1=rt->right;
+        link(rt)=rt1;
         rt1->parent=rt->parent;
         rt->right=rt1->left;
         if (rt1->left) rt1->left->parent=rt;
         rt1->left=rt;
         rt->parent=rt1;
-        rt->height=maxHeight(height(rt->left),height(rt->right))+1;
-        rt1->height=maxHeight(height(rt1->right),height(rt))+1;
-        rt=rt1;
+        update(rt);
+        update(rt1);
+        return rt1;
     }
-    void LR(AvlNode *&rt){
+    AvlNode *LR(AvlNode *rt){
         RR(rt->left);
-        LL(rt);
+        return LL(rt);
     }
-    void RL(AvlNode *&rt){
+    AvlNode *RL(AvlNode *rt){
         LL(rt->right);
-        RR(rt);
-    }
-    pair<AvlNode*, bool> insert(const value_type &value,AvlNode *&rt,AvlNode *pa){
-        if (!rt) {
-            rt=new AvlNode(value,pa);
-            return pair<AvlNode*,bool>(rt,true);
-        }else if (equal_key(value.first,rt->data->first)){
-            return pair<AvlNode*,bool>(rt,false);
-        }else if (Compare()(value.first,rt->data->first)){
-            pair<AvlNode*,bool> p=insert(value,rt->left,rt);
-            if (!p.second) return p;
-            if (height(rt->left)-height(rt->right)==2){
-                if (Compare()(value.first,rt->left->data->first))
-                    LL(rt);
-                else
-                    LR(rt);
-            }
-            rt->height=maxHeight(height(rt->left),height(rt->right))+1;
-            return p;
+        return RR(rt);
+    }
+    /**
+     * restore the balance of rt whose subtrees differ in height by at most 2
+     * and return the new root of the subtree
+     */
+    AvlNode *balance(AvlNode *rt){
+        size_t hl=height(rt->left),hr=height(rt->right);
+        if (hl==hr+2)
+            return height(rt->left->left)>=height(rt->left->right)?LL(rt):LR(rt);
+        if (hr==hl+2)
+            return height(rt->right->right)>=height(rt->right->left)?RR(rt):RL(rt);
+        update(rt);
+        return rt;
+    }
+    /**
+     * the subtree of rt has changed in height by one (after an insertion or an erasure below it),
+     * walk up and rebalance until a subtree keeps its old height.
+     * the walk ends at the header of the tree, the only node without a parent
+     */
+    void rebalance(AvlNode *rt){
+        while (rt->parent){
+            size_t old_height=rt->height;
+            rt=balance(rt);
+            if (rt->height==old_height) break;
+            rt=rt->parent;
+        }
+        // the heights above are settled, but every subtree on the way up has still changed in content
+        if (summarized)
+            for (;rt->parent;rt=rt->parent) update_summary(rt);
+    }
+    /**
+     * hang the new node cur on pos below pa.
+     * a new left child comes right before its parent in key order, a new right child right after it
+     */
+    AvlNode *attach(AvlNode *pa,AvlNode **pos,AvlNode *cur){
+        *pos=cur;
+        cur->parent=pa;
+        cur->next=pos==&pa->left?pa:pa->next;
+        cur->prev=cur->next->prev;
+        cur->prev->next=cur;
+        cur->next->prev=cur;
+        update_summary(cur);
+        rebalance(pa);
+        return cur;
+    }
+    /**
+     * link a node whose element is constructed in place from args
+     */
+    template<class... Args>
+    AvlNode *link_node(AvlNode *pa,AvlNode **pos,Args&&... args){
+        return attach(pa,pos,new AvlNode(emplace_tag(),pa,std::forward<Args>(args)...));
+    }
+    /**
+     * insert an element with key and the mapped value constructed from args, if key does not exist.
+     * nothing is constructed or moved from when it does
+     */
+    template<class K,class... Args>
+    pair<AvlNode*, bool> emplace_key(K &&key,Args&&... args){
+        AvlNode *pa,**pos=insert_pos(key,pa,three_way());
+        if (!pos) return pair<AvlNode*,bool>(pa,false);
+        return pair<AvlNode*,bool>(link_node(pa,pos,std::piecewise_construct,std::forward_as_tuple(std::forward<K>(key)),
+                                             std::forward_as_tuple(std::forward<Args>(args)...)),true);
+    }
+    pair<AvlNode*, bool> insert_node(const value_type &value){
+        AvlNode *pa,**pos=insert_pos(value.first,pa,three_way());
+        if (!pos) return pair<AvlNode*,bool>(pa,false);
+        return pair<AvlNode*,bool>(link_node(pa,pos,value),true);
+    }
+    /**
+     * exchange the places of rt and its in-order successor nd (the leftmost node of rt->right) in the tree,
+     * only tree links are changed, the payloads stay in their nodes and the order thread is unchanged
+     */
+    void swap_successor(AvlNode *rt,AvlNode *nd){
+        AvlNode *nd_parent=nd->parent,*nd_right=nd->right;
+        link(rt)=nd;
+        nd->parent=rt->parent;
+        nd->left=rt->left;
+        nd->left->parent=nd;
+        if (nd_parent==rt){
+            nd->right=rt;
+            rt->parent=nd;
         }else{
-            pair<AvlNode*,bool> p=insert(value,rt->right,rt);
-            if (!p.second) return p;
-            if (height(rt->right)-height(rt->left)==2){
-                if (Compare()(rt->right->data->first,value.first))
-                    RR(rt);
-                else
-                    RL(rt);
-            }
-            rt->height=maxHeight(height(rt->left),height(rt->right))+1;
-            return p;
+            nd->right=rt->right;
+            nd->right->parent=nd;
+            nd_parent->left=rt;
+            rt->parent=nd_parent;
         }
+        rt->left=nullptr;
+        rt->right=nd_right;
+        if (nd_right) nd_right->parent=rt;
+        size_t tmp=rt->height;
+        rt->height=nd->height;
+        nd->height=tmp;
+#if SJTU_MAP_ORDER_STATISTICS
+        tmp=rt->size;
+        rt->size=nd->size;
+        nd->size=tmp;
+#endif
+    }
+    void erase_node(AvlNode *rt){
+        if (rt->left&&rt->right) swap_successor(rt,rt->next);
+        rt->prev->next=rt->next;
+        rt->next->prev=rt->prev;
+        AvlNode *pa=rt->parent,*child=rt->left?rt->left:rt->right;
+        link(rt)=child;
+        if (child) child->parent=pa;
+        delete rt;
+        rebalance(pa);
+    }
+    /**
+     * split and join work on trees that hang on the left of a header node, like the root on end_node.
+     * they only change tree links, the order thread is left to the caller
+     */
+    inline void hang(AvlNode *head,AvlNode *rt){
+        head->left=rt;
+        if (rt) rt->parent=head;
     }
-    bool adjust(AvlNode *&rt,int subTree){
-        if (subTree){
-            if (height(rt->left)==height(rt->right)){
-                --rt->height;
-                return false;
+    /**
+     * join the trees on hl and hr with k in the middle, all keys in hl are less than the key of k
+     * and that is less than all keys in hr. the result hangs on hl, hr becomes empty.
+     * k goes down the spine of the taller tree to a subtree of about the height of the other one,
+     * so the cost is O(the difference in height)
+     */
+    void join(AvlNode *hl,AvlNode *k,AvlNode *hr){
+        AvlNode *l=hl->left,*r=hr->left;
+        if (height(l)>height(r)+1){
+            AvlNode *p=hl,*c=l;
+            while (height(c)>height(r)+1){
+                p=c;
+                c=c->right;
             }
-            if (height(rt->left)-height(rt->right)==1) return true;
-            if (height(rt->left->right)>height(rt->left->left)){
-                LR(rt);
-                return false;
+            p->right=k;
+            k->parent=p;
+            k->left=c;
+            if (c) c->parent=k;
+            k->right=r;
+            if (r) r->parent=k;
+            update(k);
+            rebalance(p);
+        }else if (height(r)>height(l)+1){
+            AvlNode *p=hr,*c=r;
+            while (height(c)>height(l)+1){
+                p=c;
+                c=c->left;
             }
-            LL(rt);
-            if (height(rt->left)==height(rt->right))
-                return false;
-            else
-                return true;
+            p->left=k;
+            k->parent=p;
+            k->right=c;
+            if (c) c->parent=k;
+            k->left=l;
+            if (l) l->parent=k;
+            update(k);
+            rebalance(p);
+            hang(hl,hr->left);
+        }else{
+            k->left=l;
+            if (l) l->parent=k;
+            k->right=r;
+            if (r) r->parent=k;
+            update(k);
+            hang(hl,k);
+        }
+        hr->left=nullptr;
+    }
+    /**
+     * join the trees on hl and hr without a middle node: the leftmost node of hr is taken out to be one
+     */
+    void join(AvlNode *hl,AvlNode *hr){
+        if (!hr->left) return;
+        AvlNode *k=hr->left;
+        while (k->left) k=k->left;
+        link(k)=k->right;
+        if (k->right) k->right->parent=k->parent;
+        rebalance(k->parent);
+        join(hl,k,hr);
+    }
+    /**
+     * split the subtree rt, detached from its parent, into the keys less than x on hl
+     * and the keys not less than x on hr, in O(log n)
+     */
+    void split(AvlNode *rt,const Key &x,AvlNode *hl,AvlNode *hr){
+        if (!rt){
+            hl->left=hr->left=nullptr;
+            return;
+        }
+        AvlNode tmp,*l=rt->left,*r=rt->right;
+        if (key_less(rt->data->first,x)){
+            split(r,x,&tmp,hr);
+            hang(hl,l);
+            join(hl,rt,&tmp);
         }else{
-            if (height(rt->right)==height(rt->left)){
-                --rt->height;
-                return false;
+            split(l,x,hl,&tmp);
+            hang(hr,r);
+            join(&tmp,rt,hr);
+            hang(hr,tmp.left);
+        }
+    }
+    /**
+     * cut the nodes in [first, last) out of the tree and free them, n is their number.
+     * short ranges are erased one by one, longer ones are split off in O(log n) and freed along the thread
+     */
+    void erase_nodes(AvlNode *first,AvlNode *last,size_t n){
+        if (n<=range_erase_limit){
+            while (first!=last){
+                AvlNode *nxt=first->next;
+                erase_node(first);
+                first=nxt;
             }
-            if (height(rt->right)-height(rt->left)==1) return true;
-            if (height(rt->right->left)>height(rt->right->right)){
-                RL(rt);
-                return false;
+            return;
+        }
+        AvlNode left,mid,right;
+        split(end_node->left,first->data->first,&left,&mid);
+        if (last!=end_node){
+            AvlNode tail;
+            split(mid.left,last->data->first,&tail,&right);
+        }
+        join(&left,&right);
+        hang(end_node,left.left);
+        AvlNode *before=first->prev;
+        while (first!=last){
+            AvlNode *nxt=first->next;
+            delete first;
+            first=nxt;
+        }
+        before->next=last;
+        last->prev=before;
+    }
+    /**
+     * hang a perfectly balanced tree over the n threaded nodes from cur on, in O(n),
+     * and return its root
+     */
+    AvlNode *build(AvlNode *&cur,size_t n){
+        if (!n) return nullptr;
+        size_t ln=(n-1)/2;
+        AvlNode *l=build(cur,ln),*rt=cur;
+        cur=cur->next;
+        rt->left=l;
+        if (l) l->parent=rt;
+        rt->right=build(cur,n-1-ln);
+        if (rt->right) rt->right->parent=rt;
+        update(rt);
+        return rt;
+    }
+    /**
+     * fill the empty map from [first, last).
+     * the leading run with increasing keys is threaded as it is read and built into a tree in O(n),
+     *   a repeated key is dropped like in insert, and anything after the run is inserted one by one.
+     */
+    template<class InputIt>
+    void load(InputIt first,InputIt last){
+        AvlNode *tail=end_node;
+        size_t n=0;
+        for (;first!=last;++first){
+            const value_type &value=*first;
+            if (tail!=end_node&&!key_less(tail->data->first,value.first)){
+                if (key_less(value.first,tail->data->first)) break;
+                continue;
             }
-            RR(rt);
-            if (height(rt->left)==height(rt->right))
-                return false;
-            else
-                return true;
-        }
-    }
-    bool remove(const Key &x,AvlNode *&rt){
-        if (!rt) return true;
-        if (equal_key(x,rt->data->first)){
-            if (!rt->left||!rt->right){
-                AvlNode *tmp=rt;
-                rt=(rt->left)?rt->left:rt->right;
-                if (rt) rt->parent=tmp->parent;
-                delete tmp;
-                return false;
-            }else{
-                AvlNode *tmp=rt->right;
-                while (tmp->left) tmp=tmp->left;
+            AvlNode *p=new AvlNode(value);
+            tail->next=p;
+            p->prev=tail;
+            tail=p;
+            ++n;
+        }
+        tail->next=end_node;
+        end_node->prev=tail;
+        AvlNode *cur=end_node->next;
+        hang(end_node,build(cur,n));
+        length=n;
+        for (;first!=last;++first) insert(*first);
+    }
+    /**
+     * the set operations work on detached trees whose nodes are threaded in key order from first to last.
+     * only the two ends of the thread point outside, split and join relink the thread at the seams,
+     *   so every step costs what the tree links cost and the result comes out threaded.
+     */
+    struct Segment{
+        AvlNode *root,*first,*last;
+        Segment(AvlNode *r=nullptr,AvlNode *f=nullptr,AvlNode *l=nullptr):root(r),first(f),last(l){}
+    };
+    enum set_operation{set_union,set_assign,set_intersection,set_difference};
+    // below this height the subtrees are combined on the calling thread
+    static const size_t fork_height=12;
 
-                bool flag=tmp->parent->left==tmp;
-                AvlNode *new_node=new AvlNode(*(tmp->data),tmp->parent,tmp->left,tmp->right,tmp->height);
-                if (flag)
-                    new_node->parent->left=new_node;
-                else
-                    new_node->parent->right=new_node;
-                if (new_node->left) new_node->left->parent=new_node;
-                if (new_node->right) new_node->right->parent=new_node;
-                tmp->parent=rt->parent;
-                tmp->left=rt->left;
-                tmp->right=rt->right;
-                tmp->height=rt->height;
-                if (tmp->left) tmp->left->parent=tmp;
-                if (tmp->right) tmp->right->parent=tmp;
-                delete rt;
-                rt=tmp;
-                if (remove(tmp->data->first,rt->right)) return true;
-                return adjust(rt,1);
-            }
+    inline Segment left_segment(AvlNode *rt,AvlNode *first) const{
+        return rt->left?Segment(rt->left,first,rt->prev):Segment();
+    }
+    inline Segment right_segment(AvlNode *rt,AvlNode *last) const{
+        return rt->right?Segment(rt->right,rt->next,last):Segment();
+    }
+    Segment join_segments(const Segment &l,AvlNode *k,const Segment &r){
+        // headers off the stack, so no node is ever left pointing into a dead frame.
+        // joins do not nest, one pair per thread is enough
+        static thread_local AvlNode hl,hr;
+        hang(&hl,l.root);
+        hang(&hr,r.root);
+        join(&hl,k,&hr);
+        // the caller hangs the root somewhere else
+        hl.left->parent=nullptr;
+        Segment res(hl.left,k,k);
+        if (l.root){
+            l.last->next=k;
+            k->prev=l.last;
+            res.first=l.first;
+        }
+        if (r.root){
+            k->next=r.first;
+            r.first->prev=k;
+            res.last=r.last;
+        }
+        return res;
+    }
+    Segment join_segments(const Segment &l,const Segment &r){
+        if (!l.root) return r;
+        if (!r.root) return l;
+        static thread_local AvlNode hl,hr;
+        hang(&hl,l.root);
+        hang(&hr,r.root);
+        join(&hl,&hr);
+        hl.left->parent=nullptr;
+        l.last->next=r.first;
+        r.first->prev=l.last;
+        return Segment(hl.left,l.first,r.last);
+    }
+    /**
+     * split s into the keys less than x on l, the node with key x on eq (nullptr if there is none)
+     * and the keys greater than x on r, in O(log n)
+     */
+    void split_segment(const Segment &s,const Key &x,Segment &l,AvlNode *&eq,Segment &r){
+        if (!s.root){
+            l=r=Segment();
+            eq=nullptr;
+            return;
+        }
+        AvlNode *rt=s.root;
+        Segment sl=left_segment(rt,s.first),sr=right_segment(rt,s.last),tmp;
+        if (key_less(rt->data->first,x)){
+            split_segment(sr,x,tmp,eq,r);
+            l=join_segments(sl,rt,tmp);
+        }else if (key_less(x,rt->data->first)){
+            split_segment(sl,x,l,eq,tmp);
+            r=join_segments(tmp,rt,sr);
+        }else{
+            l=sl;
+            eq=rt;
+            r=sr;
+        }
+    }
+    size_t free_segment(const Segment &s){
+        if (!s.root) return 0;
+        size_t n=0;
+        for (AvlNode *p=s.first;;){
+            AvlNode *nxt=p->next;
+            bool done=p==s.last;
+            delete p;
+            ++n;
+            if (done) return n;
+            p=nxt;
+        }
+    }
+    /**
+     * combine the nodes of a (this map) and b (the other one) by op, every node ends up in the result or freed.
+     * the root of b splits a, both sides are combined recursively and joined again around it,
+     *   which takes O(m log(n / m + 1)) for m = |b| <= n = |a|.
+     * up to forks more threads are started by Fork for the left sides of the upper levels.
+     * dropped counts the freed nodes.
+     */
+    template<class Fork>
+    Segment combine(const Segment &a,const Segment &b,set_operation op,size_t forks,size_t &dropped){
+        if (!b.root){
+            if (op!=set_intersection) return a;
+            dropped+=free_segment(a);
+            return Segment();
         }
-        if (Compare()(x,rt->data->first)){
-            if (remove(x,rt->left)) return true;
-            return adjust(rt,0);
+        if (!a.root){
+            if (op==set_union||op==set_assign) return b;
+            dropped+=free_segment(b);
+            return Segment();
+        }
+        AvlNode *k=b.root,*eq;
+        Segment bl=left_segment(k,b.first),br=right_segment(k,b.last),al,ar,l,r;
+        split_segment(a,k->data->first,al,eq,ar);
+        if (forks&&k->height>=fork_height){
+            size_t left_dropped=0,rest=forks-1;
+            Fork::run([&]{ l=combine<Fork>(al,bl,op,rest/2,left_dropped); },
+                      [&]{ r=combine<Fork>(ar,br,op,rest-rest/2,dropped); });
+            dropped+=left_dropped;
+        }else{
+            l=combine<Fork>(al,bl,op,0,dropped);
+            r=combine<Fork>(ar,br,op,0,dropped);
+        }
+        // the node of the key of k that survives, the others are freed
+        AvlNode *mid=nullptr,*gone=nullptr;
+        if (op==set_union){
+            mid=eq?eq:k;
+            if (eq) gone=k;
+        }else if (op==set_assign){
+            mid=k;
+            gone=eq;
         }else{
-            if (remove(x,rt->right)) return true;
-            return adjust(rt,1);
+            if (op==set_intersection) mid=eq;
+            else if (eq){
+                delete eq;
+                ++dropped;
+            }
+            gone=k;
+        }
+        if (gone){
+            delete gone;
+            ++dropped;
+        }
+        return mid?join_segments(l,mid,r):join_segments(l,r);
+    }
+    /**
+     * take all nodes of other, leaving it empty, and combine them into this map by op,
+     *   on up to forks + 1 threads started by Fork
+     */
+    template<class Fork>
+    void combine_with(map &other,set_operation op,size_t forks){
+        Segment a,b;
+        if (length) a=Segment(end_node->left,end_node->next,end_node->prev);
+        if (other.length) b=Segment(other.end_node->left,other.end_node->next,other.end_node->prev);
+        size_t total=length+other.length,dropped=0;
+        other.init_header();
+        other.length=0;
+        Segment res=combine<Fork>(a,b,op,forks,dropped);
+        hang(end_node,res.root);
+        if (res.root){
+            end_node->next=res.first;
+            res.first->prev=end_node;
+            end_node->prev=res.last;
+            res.last->next=end_node;
+        }else
+            init_header();
+        length=total-dropped;
+    }
+    /**
+     * the node at index k in key order, and the index of a node (length for end_node)
+     */
+    AvlNode *select_node(size_t k) const{
+#if SJTU_MAP_ORDER_STATISTICS
+        AvlNode *p=end_node->left;
+        while (subtree_size(p->left)!=k){
+            if (k<subtree_size(p->left))
+                p=p->left;
+            else{
+                k-=subtree_size(p->left)+1;
+                p=p->right;
+            }
         }
+        return p;
+#else
+        AvlNode *p=end_node->next;
+        while (k--) p=p->next;
+        return p;
+#endif
+    }
+    size_t node_rank(AvlNode *rt) const{
+        if (rt==end_node) return length;
+#if SJTU_MAP_ORDER_STATISTICS
+        size_t res=subtree_size(rt->left);
+        for (;rt->parent!=end_node;rt=rt->parent)
+            if (rt->parent->right==rt) res+=subtree_size(rt->parent->left)+1;
+        return res;
+#else
+        size_t res=0;
+        for (;rt->prev!=end_node;rt=rt->prev) ++res;
+        return res;
+#endif
     }
 
 public:
@@ -253,13 +839,7 @@ public:
 		iterator operator++(int) {
             if (cur==map_ptr->end_node) throw invalid_iterator();
             AvlNode *tmp=cur;
-            if (cur->right){
-                cur=cur->right;
-                while (cur->left) cur=cur->left;
-            }else{
-                while (cur->parent->left!=cur) cur=cur->parent;
-                cur=cur->parent;
-            }
+            cur=cur->next;
             return iterator(map_ptr,tmp);
         }
 		/**
@@ -267,42 +847,24 @@ public:
 		 */
 		iterator & operator++() {
             if (cur==map_ptr->end_node) throw invalid_iterator();
-            if (cur->right){
-                cur=cur->right;
-                while (cur->left) cur=cur->left;
-            }else{
-                while (cur->parent->left!=cur) cur=cur->parent;
-                cur=cur->parent;
-            }
+            cur=cur->next;
             return *this;
         }
 		/**
 		 * TODO iter--
 		 */
 		iterator operator--(int) {
-            if (cur==map_ptr->find_begin()) throw invalid_iterator();
+            if (cur->prev==map_ptr->end_node) throw invalid_iterator();
             AvlNode *tmp=cur;
-            if (cur->left){
-                cur=cur->left;
-                while (cur->right) cur=cur->right;
-            }else{
-                while (cur->parent&&cur->parent->right!=cur) cur=cur->parent;
-                cur=cur->parent;
-            }
+            cur=cur->prev;
             return iterator(map_ptr,tmp);
         }
 		/**
 		 * TODO --iter
 		 */
 		iterator & operator--() {
-            if (cur==map_ptr->find_begin()) throw invalid_iterator();
-            if (cur->left){
-                cur=cur->left;
-                while (cur->right) cur=cur->right;
-            }else{
-                while (cur->parent&&cur->parent->right!=cur) cur=cur->parent;
-                cur=cur->parent;
-            }
+            if (cur->prev==map_ptr->end_node) throw invalid_iterator();
+            cur=cur->prev;
             return *this;
         }
 		/**
@@ -327,6 +889,13 @@ public:
 		bool operator!=(const const_iterator &rhs) const {
             return map_ptr!=rhs.map_ptr||cur!=rhs.cur;
         }
+		/**
+		 * the number of increments from rhs to this, negative if this comes first.
+		 * throw invalid_iterator if they belong to different maps.
+		 */
+		std::ptrdiff_t operator-(const const_iterator &rhs) const {
+            return const_iterator(*this)-rhs;
+        }
 
 		/**
 		 * for the support of it->first. 
@@ -373,13 +942,7 @@ public:
         const_iterator operator++(int) {
             if (cur==map_ptr->end_node) throw invalid_iterator();
             AvlNode *tmp=cur;
-            if (cur->right){
-                cur=cur->right;
-                while (cur->left) cur=cur->left;
-            }else{
-                while (cur->parent->left!=cur) cur=cur->parent;
-                cur=cur->parent;
-            }
+            cur=cur->next;
             return const_iterator(map_ptr,tmp);
         }
         /**
@@ -387,42 +950,24 @@ public:
          */
         const_iterator & operator++() {
             if (cur==map_ptr->end_node) throw invalid_iterator();
-            if (cur->right){
-                cur=cur->right;
-                while (cur->left) cur=cur->left;
-            }else{
-                while (cur->parent->left!=cur) cur=cur->parent;
-                cur=cur->parent;
-            }
+            cur=cur->next;
             return *this;
         }
         /**
          * TODO iter--
          */
         const_iterator operator--(int) {
-            if (cur==map_ptr->find_begin()) throw invalid_iterator();
+            if (cur->prev==map_ptr->end_node) throw invalid_iterator();
             AvlNode *tmp=cur;
-            if (cur->left){
-                cur=cur->left;
-                while (cur->right) cur=cur->right;
-            }else{
-                while (cur->parent&&cur->parent->right!=cur) cur=cur->parent;
-                cur=cur->parent;
-            }
+            cur=cur->prev;
             return const_iterator(map_ptr,tmp);
         }
         /**
          * TODO --iter
          */
         const_iterator & operator--() {
-            if (cur==map_ptr->find_begin()) throw invalid_iterator();
-            if (cur->left){
-                cur=cur->left;
-                while (cur->right) cur=cur->right;
-            }else{
-                while (cur->parent&&cur->parent->right!=cur) cur=cur->parent;
-                cur=cur->parent;
-            }
+            if (cur->prev==map_ptr->end_node) throw invalid_iterator();
+            cur=cur->prev;
             return *this;
         }
         /**
@@ -447,6 +992,10 @@ public:
         bool operator!=(const const_iterator &rhs) const {
             return map_ptr!=rhs.map_ptr||cur!=rhs.cur;
         }
+        std::ptrdiff_t operator-(const const_iterator &rhs) const {
+            if (!map_ptr||map_ptr!=rhs.map_ptr) throw invalid_iterator();
+            return (std::ptrdiff_t) map_ptr->node_rank(cur)-(std::ptrdiff_t) map_ptr->node_rank(rhs.cur);
+        }
 
         /**
          * for the support of it->first.
@@ -456,35 +1005,78 @@ public:
             return cur->data;
         }
 	};
+protected:
+	/**
+	 * the node of pos, throw invalid_iterator if pos is end() or belongs to another map
+	 */
+	AvlNode *element_node(const const_iterator &pos) const {
+        if (pos.map_ptr!=this||pos.cur==end_node) throw invalid_iterator();
+        return pos.cur;
+    }
+public:
 	/**
 	 * TODO two constructors
 	 */
 	map() {
         end_node=new AvlNode;
+        init_header();
         length=0;
     }
-	map(const map &other) {
+	/**
+	 * an empty map ordered by comp, which is copied into the map and used for every comparison.
+	 */
+	explicit map(const Compare &comp):functor_holder<Compare, 0>(comp) {
         end_node=new AvlNode;
-        copy(end_node->left,other.end_node->left);
-        if (end_node->left) end_node->left->parent=end_node;
+        init_header();
+        length=0;
+    }
+	/**
+	 * an empty map ordered by comp whose nodes are kept up by aug, both are copied into the map.
+	 */
+	map(const Compare &comp, const Augment &aug):functor_holder<Compare, 0>(comp), functor_holder<Augment, 1>(aug) {
+        end_node=new AvlNode;
+        init_header();
+        length=0;
+    }
+	map(const map &other):functor_holder<Compare, 0>(other), functor_holder<Augment, 1>(other) {
+        end_node=new AvlNode;
+        copy(other);
         length=other.length;
+    }
+	/**
+	 * construct from the elements in [first, last), in O(n) if their keys are sorted.
+	 */
+	template<class InputIt>
+	map(InputIt first, InputIt last, const Compare &comp = Compare()):functor_holder<Compare, 0>(comp) {
+        end_node=new AvlNode;
+        init_header();
+        load(first,last);
     }
 	/**
 	 * TODO assignment operator
 	 */
 	map & operator=(const map &other) {
         if (this==&other) return *this;
-        clear(end_node->left);
-        copy(end_node->left,other.end_node->left);
-        if (end_node->left) end_node->left->parent=end_node;
+        clear_nodes();
+        functor_holder<Compare, 0>::operator=(other);
+        functor_holder<Augment, 1>::operator=(other);
+        copy(other);
         length=other.length;
         return *this;
+    }
+	/**
+	 * replace the contents with the elements in [first, last), in O(n) if their keys are sorted.
+	 */
+	template<class InputIt>
+	void assign(InputIt first, InputIt last) {
+        clear_nodes();
+        load(first,last);
     }
 	/**
 	 * TODO Destructors
 	 */
 	~map() {
-        clear(end_node->left);
+        clear_nodes();
         delete end_node;
     }
 	/**
@@ -494,12 +1086,12 @@ public:
 	 * If no such element exists, an exception of type `index_out_of_bound'
 	 */
 	T & at(const Key &key) {
-        AvlNode *p=find_node(key,end_node->left);
+        AvlNode *p=find_node(key);
         if (!p) throw index_out_of_bound();
         return p->data->second;
     }
 	const T & at(const Key &key) const {
-        AvlNode *p=find_node(key,end_node->left);
+        AvlNode *p=find_node(key);
         if (!p) throw index_out_of_bound();
         return p->data->second;
     }
@@ -510,17 +1102,20 @@ public:
 	 *   performing an insertion if such key does not already exist.
 	 */
 	T & operator[](const Key &key) {
-        AvlNode *p=find_node(key,end_node->left);
-        if (p) return p->data->second;
-        pair<AvlNode*,bool> tmp=insert(value_type(key,T()),end_node->left,end_node);
-        ++length;
-        return tmp.first->data->second;
+        pair<AvlNode*,bool> p=emplace_key(key);
+        if (p.second) ++length;
+        return p.first->data->second;
+    }
+	T & operator[](Key &&key) {
+        pair<AvlNode*,bool> p=emplace_key(std::move(key));
+        if (p.second) ++length;
+        return p.first->data->second;
     }
 	/**
 	 * behave like at() throw index_out_of_bound if such key does not exist.
 	 */
 	const T & operator[](const Key &key) const {
-        AvlNode *p=find_node(key,end_node->left);
+        AvlNode *p=find_node(key);
         if (!p) throw index_out_of_bound();
         return p->data->second;
     }
@@ -528,10 +1123,10 @@ public:
 	 * return a iterator to the beginning
 	 */
 	iterator begin() {
-        return iterator(this,find_begin());
+        return iterator(this,end_node->next);
     }
 	const_iterator cbegin() const {
-        return const_iterator(this,find_begin());
+        return const_iterator(this,end_node->next);
     }
 	/**
 	 * return a iterator to the end
@@ -555,13 +1150,18 @@ public:
 	 */
 	size_t size() const {
         return length;
+    }
+	/**
+	 * returns a copy of the comparator that orders the keys.
+	 */
+	Compare key_comp() const {
+        return compare();
     }
 	/**
 	 * clears the contents
 	 */
 	void clear() {
-        clear(end_node->left);
-        end_node->left=nullptr;
+        clear_nodes();
         length=0;
     }
 	/**
@@ -571,9 +1171,91 @@ public:
 	 *   the second one is true if insert successfully, or false.
 	 */
 	pair<iterator, bool> insert(const value_type &value) {
-        pair<AvlNode*,bool> p=insert(value,end_node->left,end_node);
+        pair<AvlNode*,bool> p=insert_node(value);
+        if (p.second) ++length;
+        return pair<iterator, bool>(iterator(this,p.first),p.second);
+    }
+	pair<iterator, bool> insert(value_type &&value) {
+        AvlNode *pa,**pos=insert_pos(value.first,pa,three_way());
+        if (!pos) return pair<iterator, bool>(iterator(this,pa),false);
+        ++length;
+        return pair<iterator, bool>(iterator(this,link_node(pa,pos,std::move(value))),true);
+    }
+	/**
+	 * construct an element in place from args and insert it if its key does not exist, like insert.
+	 * the element is built once, before the search, so it is destroyed again if the key exists.
+	 */
+	template<class... Args>
+	pair<iterator, bool> emplace(Args&&... args) {
+        AvlNode *cur=new AvlNode(emplace_tag(),nullptr,std::forward<Args>(args)...);
+        AvlNode *pa,**pos=insert_pos(cur->data->first,pa,three_way());
+        if (!pos){
+            delete cur;
+            return pair<iterator, bool>(iterator(this,pa),false);
+        }
+        ++length;
+        return pair<iterator, bool>(iterator(this,attach(pa,pos,cur)),true);
+    }
+	/**
+	 * insert an element with key and the value constructed in place from args if key does not exist.
+	 * if it does, nothing is constructed and args are not moved from.
+	 */
+	template<class... Args>
+	pair<iterator, bool> try_emplace(const Key &key, Args&&... args) {
+        pair<AvlNode*,bool> p=emplace_key(key,std::forward<Args>(args)...);
+        if (p.second) ++length;
+        return pair<iterator, bool>(iterator(this,p.first),p.second);
+    }
+	template<class... Args>
+	pair<iterator, bool> try_emplace(Key &&key, Args&&... args) {
+        pair<AvlNode*,bool> p=emplace_key(std::move(key),std::forward<Args>(args)...);
         if (p.second) ++length;
         return pair<iterator, bool>(iterator(this,p.first),p.second);
+    }
+	/**
+	 * assign obj to the mapped value of key, or insert an element constructed from key and obj if key does not exist.
+	 * the second one of the result is true if an element was inserted.
+	 */
+	template<class M>
+	pair<iterator, bool> insert_or_assign(const Key &key, M &&obj) {
+        pair<AvlNode*,bool> p=emplace_key(key,std::forward<M>(obj));
+        if (p.second) ++length;
+        else p.first->data->second=std::forward<M>(obj);
+        return pair<iterator, bool>(iterator(this,p.first),p.second);
+    }
+	template<class M>
+	pair<iterator, bool> insert_or_assign(Key &&key, M &&obj) {
+        pair<AvlNode*,bool> p=emplace_key(std::move(key),std::forward<M>(obj));
+        if (p.second) ++length;
+        else p.first->data->second=std::forward<M>(obj);
+        return pair<iterator, bool>(iterator(this,p.first),p.second);
+    }
+	/**
+	 * insert an element right before hint if its key belongs there,
+	 *   otherwise like insert(value).
+	 * return the iterator to the new element (or the element that prevented the insertion).
+	 * with hint = end() for keys in ascending order this skips the search from the root.
+	 * the rebalancing is amortized O(1) only with SJTU_MAP_ORDER_STATISTICS=0 and no augmentation;
+	 *   in the default configuration every insertion still updates the subtree sizes
+	 *   up to the root, so it stays O(log n).
+	 *
+	 * throw invalid_iterator if hint belongs to another map.
+	 */
+	iterator insert(const_iterator hint, const value_type &value) {
+        if (hint.map_ptr!=this) throw invalid_iterator();
+        AvlNode *h=hint.cur,*pv=h->prev;
+        if ((h==end_node||key_less(value.first,h->data->first))&&(pv==end_node||key_less(pv->data->first,value.first))){
+            AvlNode *cur;
+            if (h!=end_node&&!h->left)
+                cur=link_node(h,&h->left,value);
+            else if (pv!=end_node)
+                cur=link_node(pv,&pv->right,value);
+            else
+                cur=link_node(end_node,&end_node->left,value);
+            ++length;
+            return iterator(this,cur);
+        }
+        return insert(value).first;
     }
 	/**
 	 * erase the element at pos.
@@ -581,9 +1263,103 @@ public:
 	 * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
 	 */
 	void erase(iterator pos) {
-        if (pos.map_ptr!=this||pos.cur==end_node) throw invalid_iterator();
-        length-=count(pos->first);
-        remove(pos->first,end_node->left);
+        erase_node(element_node(pos));
+        --length;
+    }
+	/**
+	 * erase the elements in [first, last) in O(log n + the number of erased elements).
+	 *
+	 * throw if first or last is not an iterator of this, or first is end() while last is not.
+	 */
+	void erase(iterator first, iterator last) {
+        if (first.map_ptr!=this||last.map_ptr!=this) throw invalid_iterator();
+        if (first.cur==last.cur) return;
+        if (first.cur==end_node) throw invalid_iterator();
+        size_t n=0;
+        for (AvlNode *p=first.cur;p!=last.cur;p=p->next){
+            if (p==end_node) throw invalid_iterator();
+            ++n;
+        }
+        erase_nodes(first.cur,last.cur,n);
+        length-=n;
+    }
+	/**
+	 * set operations by key, in O(m log(n / m + 1)) for sizes m <= n, plus O(m) to copy other
+	 *   unless it is passed as an rvalue, whose nodes are then taken over and which is left empty.
+	 * union_with adds the elements of other whose keys are not in this map,
+	 * intersect_with keeps the elements whose keys are in other,
+	 * difference_with removes the elements whose keys are in other,
+	 * apply_batch adds the elements of other and overwrites the mapped values of the keys already here.
+	 * the elements kept from this map stay where they are, so iterators to them stay valid;
+	 *   apply_batch replaces the elements of the keys it overwrites.
+	 */
+	void union_with(const map &other) {
+        map tmp(other);
+        combine_with<detail::serial_fork>(tmp,set_union,0);
+    }
+	void union_with(map &&other) {
+        combine_with<detail::serial_fork>(other,set_union,0);
+    }
+	void intersect_with(const map &other) {
+        map tmp(other);
+        combine_with<detail::serial_fork>(tmp,set_intersection,0);
+    }
+	void intersect_with(map &&other) {
+        combine_with<detail::serial_fork>(other,set_intersection,0);
+    }
+	void difference_with(const map &other) {
+        map tmp(other);
+        combine_with<detail::serial_fork>(tmp,set_difference,0);
+    }
+	void difference_with(map &&other) {
+        combine_with<detail::serial_fork>(other,set_difference,0);
+    }
+	void apply_batch(const map &batch) {
+        map tmp(batch);
+        combine_with<detail::serial_fork>(tmp,set_assign,0);
+    }
+	void apply_batch(map &&batch) {
+        combine_with<detail::serial_fork>(batch,set_assign,0);
+    }
+	/**
+	 * same as above, but the upper levels of the recursion run on up to the given number of threads
+	 *   (0 for all hardware threads). include parallel.hpp to use them, map.hpp does not pull in threads.
+	 */
+	template<class M = map>
+	void union_with(const map &other, size_t threads) {
+        map tmp(other);
+        detail::thread_fork<M>::combine(*this,tmp,set_union,threads);
+    }
+	template<class M = map>
+	void union_with(map &&other, size_t threads) {
+        detail::thread_fork<M>::combine(*this,other,set_union,threads);
+    }
+	template<class M = map>
+	void intersect_with(const map &other, size_t threads) {
+        map tmp(other);
+        detail::thread_fork<M>::combine(*this,tmp,set_intersection,threads);
+    }
+	template<class M = map>
+	void intersect_with(map &&other, size_t threads) {
+        detail::thread_fork<M>::combine(*this,other,set_intersection,threads);
+    }
+	template<class M = map>
+	void difference_with(const map &other, size_t threads) {
+        map tmp(other);
+        detail::thread_fork<M>::combine(*this,tmp,set_difference,threads);
+    }
+	template<class M = map>
+	void difference_with(map &&other, size_t threads) {
+        detail::thread_fork<M>::combine(*this,other,set_difference,threads);
+    }
+	template<class M = map>
+	void apply_batch(const map &batch, size_t threads) {
+        map tmp(batch);
+        detail::thread_fork<M>::combine(*this,tmp,set_assign,threads);
+    }
+	template<class M = map>
+	void apply_batch(map &&batch, size_t threads) {
+        detail::thread_fork<M>::combine(*this,batch,set_assign,threads);
     }
 	/**
 	 * Returns the number of elements with key 
@@ -593,7 +1369,7 @@ public:
 	 * The default method of check the equivalence is !(a < b || b > a)
 	 */
 	size_t count(const Key &key) const {
-        if (find_node(key,end_node->left))
+        if (find_node(key))
             return 1;
         else
             return 0;
@@ -605,19 +1381,107 @@ public:
 	 *   If no such element is found, past-the-end (see end()) iterator is returned.
 	 */
 	iterator find(const Key &key) {
-        AvlNode *p=find_node(key,end_node->left);
+        AvlNode *p=find_node(key);
         if (p)
             return iterator(this,p);
         else
             return iterator(this,end_node);
     }
 	const_iterator find(const Key &key) const {
-        AvlNode *p=find_node(key,end_node->left);
+        AvlNode *p=find_node(key);
         if (p)
             return const_iterator(this,p);
         else
             return const_iterator(this,end_node);
     }
+	/**
+	 * lower_bound returns an iterator to the first element whose key is not less than key,
+	 *   upper_bound to the first element whose key is greater than key,
+	 *   past-the-end if there is no such element.
+	 * equal_range returns both.
+	 */
+	iterator lower_bound(const Key &key) {
+        AvlNode *p=lower_bound_node(key);
+        return iterator(this,p?p:end_node);
+    }
+	const_iterator lower_bound(const Key &key) const {
+        AvlNode *p=lower_bound_node(key);
+        return const_iterator(this,p?p:end_node);
+    }
+	iterator upper_bound(const Key &key) {
+        AvlNode *p=upper_bound_node(key);
+        return iterator(this,p?p:end_node);
+    }
+	const_iterator upper_bound(const Key &key) const {
+        AvlNode *p=upper_bound_node(key);
+        return const_iterator(this,p?p:end_node);
+    }
+	pair<iterator, iterator> equal_range(const Key &key) {
+        return pair<iterator, iterator>(lower_bound(key),upper_bound(key));
+    }
+	pair<const_iterator, const_iterator> equal_range(const Key &key) const {
+        return pair<const_iterator, const_iterator>(lower_bound(key),upper_bound(key));
+    }
+	/**
+	 * select returns an iterator to the element at index k in key order (0-based),
+	 *   throw index_out_of_bound if k >= size().
+	 * rank returns the number of elements whose key is less than key.
+	 */
+	iterator select(size_t k) {
+        if (k>=length) throw index_out_of_bound();
+        return iterator(this,select_node(k));
+    }
+	const_iterator select(size_t k) const {
+        if (k>=length) throw index_out_of_bound();
+        return const_iterator(this,select_node(k));
+    }
+	size_t rank(const Key &key) const {
+        AvlNode *p=lower_bound_node(key);
+        return node_rank(p?p:end_node);
+    }
+	/**
+	 * if Compare is transparent (declares is_transparent), find, count, lower_bound, upper_bound and rank
+	 *   also accept any K that Compare can compare with Key, without constructing a Key.
+	 */
+	template<class K,class C=Compare,class=typename C::is_transparent>
+	size_t count(const K &key) const {
+        return find_node(key)?1:0;
+    }
+	template<class K,class C=Compare,class=typename C::is_transparent>
+	iterator find(const K &key) {
+        AvlNode *p=find_node(key);
+        return iterator(this,p?p:end_node);
+    }
+	template<class K,class C=Compare,class=typename C::is_transparent>
+	const_iterator find(const K &key) const {
+        AvlNode *p=find_node(key);
+        return const_iterator(this,p?p:end_node);
+    }
+	template<class K,class C=Compare,class=typename C::is_transparent>
+	iterator lower_bound(const K &key) {
+        AvlNode *p=lower_bound_node(key);
+        return iterator(this,p?p:end_node);
+    }
+	template<class K,class C=Compare,class=typename C::is_transparent>
+	const_iterator lower_bound(const K &key) const {
+        AvlNode *p=lower_bound_node(key);
+        return const_iterator(this,p?p:end_node);
+    }
+	template<class K,class C=Compare,class=typename C::is_transparent>
+	iterator upper_bound(const K &key) {
+        AvlNode *p=upper_bound_node(key);
+        return iterator(this,p?p:end_node);
+    }
+	template<class K,class C=Compare,class=typename C::is_transparent>
+	const_iterator upper_bound(const K &key) const {
+        AvlNode *p=upper_bound_node(key);
+        return const_iterator(this,p?p:end_node);
+    }
+	template<class K,class C=Compare,class=typename C::is_transparent>
+	size_t rank(const K &key) const {
+        AvlNode *p=lower_bound_node(key);
+        return node_rank(p?p:end_node);
+    }
 };
 
 }
@@ -0,0 +1,36 @@
+#ifndef SJTU_MAP_PARALLEL_HPP
+#define SJTU_MAP_PARALLEL_HPP
+
+#include "map.hpp"
+
+#include <cstddef>
+#include <thread>
+
+namespace sjtu{
+
+namespace detail{
+
+/**
+ * the fork of the set operations of map with a thread count:
+ * the first half runs on a new thread while the calling thread runs the second one.
+ */
+template<class Map>
+struct thread_fork{
+    template<class F, class G>
+    static void run(F &&f, G &&g){
+        std::thread worker(f);
+        g();
+        worker.join();
+    }
+    static void combine(Map &map, Map &other, typename Map::set_operation op, size_t threads){
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 1;
+        map.template combine_with<thread_fork>(other, op, threads - 1);
+    }
+};
+
+}
+
+}
+
+#endif //SJTU_MAP_PARALLEL_HPP
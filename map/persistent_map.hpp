@@ -0,0 +1,402 @@
+/**
+ * implement a persistent ordered map: an AVL tree with reference counted nodes shared between copies
+ */
+#ifndef SJTU_PERSISTENT_MAP_HPP
+#define SJTU_PERSISTENT_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <atomic>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * an ordered map whose copies are O(1) snapshots.
+ * a copy shares the whole tree, and a write copies only the nodes on its O(log n) path
+ *   that are still shared with another copy, so every copy keeps seeing its own contents.
+ * a node referenced once is changed in place, so a batch of writes after a snapshot
+ *   copies every node at most once and then edits the private copies like a plain map.
+ *
+ * the reference counts are atomic: copies sharing nodes may be read, written and destroyed
+ *   on different threads, as long as every single map is used by one thread at a time.
+ *
+ * there are only const iterators, and ++ and -- find the neighbour from the root in O(log n).
+ * a write to a map invalidates its iterators and the references returned by at and operator[],
+ *   those of its other copies stay valid.
+ */
+template<
+	class Key,
+	class T,
+	class Compare = std::less<Key>
+> class persistent_map : private functor_holder<Compare, 0> {
+public:
+	typedef pair<const Key, T> value_type;
+
+private:
+    struct Node{
+        value_type data;
+        Node *left;
+        Node *right;
+        size_t height;
+        // the number of links and roots pointing here
+        std::atomic<size_t> refs;
+        explicit Node(const value_type &x):data(x),left(nullptr),right(nullptr),height(1),refs(1){}
+        // a private copy of other sharing its children
+        Node(const Node &other):data(other.data),left(other.left),right(other.right),height(other.height),refs(1){
+            retain(left);
+            retain(right);
+        }
+    };
+
+    Node *root;
+    size_t length;
+
+    static void retain(Node *rt){
+        if (rt) rt->refs.fetch_add(1,std::memory_order_relaxed);
+    }
+    static void release(Node *rt){
+        if (!rt||rt->refs.fetch_sub(1,std::memory_order_acq_rel)!=1) return;
+        release(rt->left);
+        release(rt->right);
+        delete rt;
+    }
+    /**
+     * make the node on link private to this map before it is changed, copying it if it is shared.
+     * the link has to be private already
+     */
+    static Node *&own(Node *&link){
+        if (link->refs.load(std::memory_order_acquire)!=1){
+            Node *old=link;
+            link=new Node(*old);
+            release(old);
+        }
+        return link;
+    }
+
+    /**
+     * the comparator of this map, it takes no space if it is empty
+     */
+    inline const Compare &compare() const {return functor_holder<Compare, 0>::get();}
+    inline bool key_less(const Key &a,const Key &b) const {return compare()(a,b);}
+    static inline size_t height(Node *rt) {return rt?rt->height:0;}
+    static inline void update(Node *rt){
+        size_t hl=height(rt->left),hr=height(rt->right);
+        rt->height=(hl>hr?hl:hr)+1;
+    }
+    /**
+     * rotations and balance work on private nodes and make the children they move private
+     */
+    static void rotate_right(Node *&rt){
+        Node *l=own(rt->left);
+        rt->left=l->right;
+        l->right=rt;
+        update(rt);
+        update(l);
+        rt=l;
+    }
+    static void rotate_left(Node *&rt){
+        Node *r=own(rt->right);
+        rt->right=r->left;
+        r->left=rt;
+        update(rt);
+        update(r);
+        rt=r;
+    }
+    static void balance(Node *&rt){
+        update(rt);
+        if (height(rt->left)>height(rt->right)+1){
+            if (height(rt->left->left)<height(rt->left->right)) rotate_left(own(rt->left));
+            rotate_right(rt);
+        }else if (height(rt->right)>height(rt->left)+1){
+            if (height(rt->right->right)<height(rt->right->left)) rotate_right(own(rt->right));
+            rotate_left(rt);
+        }
+    }
+
+    Node *find_node(const Key &key) const{
+        Node *p=root;
+        while (p){
+            if (key_less(key,p->data.first)) p=p->left;
+            else if (key_less(p->data.first,key)) p=p->right;
+            else return p;
+        }
+        return nullptr;
+    }
+    /**
+     * the first node whose key is not less than key (greater than key if strict), nullptr if there is none
+     */
+    Node *bound_node(const Key &key,bool strict) const{
+        Node *p=root,*res=nullptr;
+        while (p){
+            if (strict?key_less(key,p->data.first):!key_less(p->data.first,key)){
+                res=p;
+                p=p->left;
+            }else
+                p=p->right;
+        }
+        return res;
+    }
+    Node *last_node() const{
+        Node *p=root;
+        while (p&&p->right) p=p->right;
+        return p;
+    }
+    /**
+     * the node with key, which has to exist, after making the path to it private
+     */
+    Node *own_path(const Key &key){
+        Node **link=&root;
+        while (true){
+            Node *p=own(*link);
+            if (key_less(key,p->data.first)) link=&p->left;
+            else if (key_less(p->data.first,key)) link=&p->right;
+            else return p;
+        }
+    }
+    /**
+     * insert value, whose key is not in the subtree, and return its node
+     */
+    Node *insert_node(Node *&rt,const value_type &value){
+        if (!rt) return rt=new Node(value);
+        own(rt);
+        Node *res=key_less(value.first,rt->data.first)?insert_node(rt->left,value):insert_node(rt->right,value);
+        balance(rt);
+        return res;
+    }
+    /**
+     * take the leftmost node out of the subtree and return it, private and without children
+     */
+    Node *remove_min(Node *&rt){
+        own(rt);
+        if (!rt->left){
+            Node *res=rt;
+            rt=res->right;
+            res->right=nullptr;
+            return res;
+        }
+        Node *res=remove_min(rt->left);
+        balance(rt);
+        return res;
+    }
+    /**
+     * erase key, which has to be in the subtree
+     */
+    void erase_node(Node *&rt,const Key &key){
+        own(rt);
+        if (key_less(key,rt->data.first))
+            erase_node(rt->left,key);
+        else if (key_less(rt->data.first,key))
+            erase_node(rt->right,key);
+        else{
+            Node *old=rt;
+            if (old->left&&old->right){
+                rt=remove_min(old->right);
+                rt->left=old->left;
+                rt->right=old->right;
+            }else
+                rt=old->left?old->left:old->right;
+            old->left=old->right=nullptr;
+            release(old);
+            if (!rt) return;
+        }
+        balance(rt);
+    }
+
+public:
+	class const_iterator {
+    friend class persistent_map;
+    private:
+        const persistent_map *map_ptr;
+        // nullptr for end()
+        Node *cur;
+    public:
+        const_iterator():map_ptr(nullptr),cur(nullptr) {}
+        const_iterator(const const_iterator &other):map_ptr(other.map_ptr),cur(other.cur) {}
+        const_iterator(const persistent_map *_map_ptr,Node *_cur):map_ptr(_map_ptr),cur(_cur) {}
+        const_iterator operator++(int) {
+            const_iterator tmp=*this;
+            ++*this;
+            return tmp;
+        }
+        const_iterator & operator++() {
+            if (!cur) throw invalid_iterator();
+            cur=map_ptr->bound_node(cur->data.first,true);
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator tmp=*this;
+            --*this;
+            return tmp;
+        }
+        const_iterator & operator--() {
+            if (!map_ptr) throw invalid_iterator();
+            Node *p=map_ptr->root,*res=nullptr;
+            if (!cur)
+                res=map_ptr->last_node();
+            else
+                while (p){
+                    if (map_ptr->key_less(p->data.first,cur->data.first)){
+                        res=p;
+                        p=p->right;
+                    }else
+                        p=p->left;
+                }
+            if (!res) throw invalid_iterator();
+            cur=res;
+            return *this;
+        }
+        const value_type & operator*() const {
+            if (!cur) throw invalid_iterator();
+            return cur->data;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&cur==rhs.cur;
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this==rhs);
+        }
+        const value_type* operator->() const noexcept {
+            return &cur->data;
+        }
+	};
+	typedef const_iterator iterator;
+
+	persistent_map():root(nullptr),length(0) {}
+	/**
+	 * an empty map ordered by comp, which is copied into the map and used for every comparison.
+	 */
+	explicit persistent_map(const Compare &comp):functor_holder<Compare, 0>(comp),root(nullptr),length(0) {}
+	/**
+	 * a snapshot of other in O(1)
+	 */
+	persistent_map(const persistent_map &other):functor_holder<Compare, 0>(other),root(other.root),length(other.length) {
+        retain(root);
+    }
+	persistent_map & operator=(const persistent_map &other) {
+        retain(other.root);
+        release(root);
+        root=other.root;
+        length=other.length;
+        functor_holder<Compare, 0>::operator=(other);
+        return *this;
+    }
+	~persistent_map() {
+        release(root);
+    }
+	/**
+	 * access specified element with bounds checking, throw index_out_of_bound if key is not found.
+	 * the non-const versions make the path to the element private first.
+	 */
+	T & at(const Key &key) {
+        if (!find_node(key)) throw index_out_of_bound();
+        return own_path(key)->data.second;
+    }
+	const T & at(const Key &key) const {
+        Node *p=find_node(key);
+        if (!p) throw index_out_of_bound();
+        return p->data.second;
+    }
+	/**
+	 * access specified element, inserting a default constructed value if key does not exist.
+	 */
+	T & operator[](const Key &key) {
+        if (find_node(key)) return own_path(key)->data.second;
+        ++length;
+        return insert_node(root,value_type(key,T()))->data.second;
+    }
+	const T & operator[](const Key &key) const {
+        return at(key);
+    }
+	const_iterator begin() const {
+        Node *p=root;
+        while (p&&p->left) p=p->left;
+        return const_iterator(this,p);
+    }
+	const_iterator cbegin() const {
+        return begin();
+    }
+	const_iterator end() const {
+        return const_iterator(this,nullptr);
+    }
+	const_iterator cend() const {
+        return end();
+    }
+	bool empty() const {
+        return !length;
+    }
+	size_t size() const {
+        return length;
+    }
+	/**
+	 * returns a copy of the comparator that orders the keys.
+	 */
+	Compare key_comp() const {
+        return compare();
+    }
+	void clear() {
+        release(root);
+        root=nullptr;
+        length=0;
+    }
+	/**
+	 * insert value if its key does not exist, copying the shared nodes on the path.
+	 * return the iterator to the element with the key and whether value was inserted.
+	 */
+	pair<const_iterator, bool> insert(const value_type &value) {
+        Node *p=find_node(value.first);
+        if (p) return pair<const_iterator, bool>(const_iterator(this,p),false);
+        ++length;
+        return pair<const_iterator, bool>(const_iterator(this,insert_node(root,value)),true);
+    }
+	/**
+	 * set the mapped value of key to value, inserting it if key does not exist.
+	 * return true if a new element was inserted.
+	 */
+	bool assign(const Key &key, const T &value) {
+        if (find_node(key)){
+            own_path(key)->data.second=value;
+            return false;
+        }
+        ++length;
+        insert_node(root,value_type(key,value));
+        return true;
+    }
+	/**
+	 * erase the element at pos, throw invalid_iterator if pos is end() or belongs to another map.
+	 */
+	void erase(const_iterator pos) {
+        if (pos.map_ptr!=this||!pos.cur) throw invalid_iterator();
+        // the node of pos may be copied and freed on the way down
+        Key key(pos.cur->data.first);
+        erase_node(root,key);
+        --length;
+    }
+	/**
+	 * erase the element with key, return the number of erased elements (0 or 1).
+	 */
+	size_t erase(const Key &key) {
+        if (!find_node(key)) return 0;
+        erase_node(root,key);
+        --length;
+        return 1;
+    }
+	size_t count(const Key &key) const {
+        return find_node(key)?1:0;
+    }
+	const_iterator find(const Key &key) const {
+        return const_iterator(this,find_node(key));
+    }
+	const_iterator lower_bound(const Key &key) const {
+        return const_iterator(this,bound_node(key,false));
+    }
+	const_iterator upper_bound(const Key &key) const {
+        return const_iterator(this,bound_node(key,true));
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,905 @@
+/**
+ * implement an ordered map on integer and string keys as an adaptive radix tree
+ */
+#ifndef SJTU_RADIX_MAP_HPP
+#define SJTU_RADIX_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace sjtu {
+
+/**
+ * the byte string of a key for radix_map, whose byte order is the key order.
+ * encode stores the bytes in buf (up to 16) or points data at them elsewhere, and returns their number.
+ * specialize it for other key types.
+ */
+template<class Key, class Enable = void>
+struct radix_traits;
+
+/**
+ * integers in big endian, signed ones with the sign bit flipped so that negative numbers come first
+ */
+template<class Key>
+struct radix_traits<Key, typename std::enable_if<std::is_integral<Key>::value>::type>{
+    static size_t encode(const Key &key,unsigned char *buf,const unsigned char *&data){
+        typedef typename std::make_unsigned<Key>::type U;
+        U x=(U) key;
+        if (std::is_signed<Key>::value) x^=(U) 1<<(sizeof(Key)*8-1);
+        for (size_t i=sizeof(Key);i-->0;x>>=8) buf[i]=(unsigned char) (x&0xff);
+        data=buf;
+        return sizeof(Key);
+    }
+};
+
+/**
+ * strings as they are, compared like std::string by unsigned bytes
+ */
+template<>
+struct radix_traits<std::string>{
+    static size_t encode(const std::string &key,unsigned char *,const unsigned char *&data){
+        data=(const unsigned char *) key.data();
+        return key.size();
+    }
+};
+
+/**
+ * an ordered map with the interface and the exceptions of sjtu::map on keys that are byte strings:
+ *   integers and std::string, or anything radix_traits is specialized for. the order is the order of the bytes.
+ * a lookup walks the bytes of the key instead of comparing whole keys at every level:
+ *   inner nodes have 4, 16, 48 or 256 child slots and change size as they fill and empty,
+ *   a Node16 is searched with one SSE2 comparison, and a chain of nodes with one child each
+ *   is compressed into a prefix of its parent.
+ * the first max_prefix bytes of a prefix are kept in the node, longer ones are checked against a leaf below.
+ * a key that is a proper prefix of others hangs on the node where it ends, before its children.
+ * the leaves are threaded into a list in key order like the nodes of sjtu::map, for iteration.
+ */
+template<
+	class Key,
+	class T
+> class radix_map {
+public:
+	typedef pair<const Key, T> value_type;
+
+private:
+    typedef radix_traits<Key> traits;
+    static const size_t max_prefix=8;
+
+    struct Link{
+        Link *prev;
+        Link *next;
+    };
+    struct Leaf:Link{
+        value_type data;
+        explicit Leaf(const value_type &x):data(x){}
+    };
+    /**
+     * the bytes of a key, data may point into buf, so it is neither copied nor moved
+     */
+    struct Encoded{
+        unsigned char buf[16];
+        const unsigned char *data;
+        size_t len;
+        explicit Encoded(const Key &key){
+            len=traits::encode(key,buf,data);
+        }
+        Encoded(const Encoded &other) = delete;
+        unsigned char operator[](size_t i) const {return data[i];}
+    };
+
+    enum node_type{node4,node16,node48,node256};
+    /**
+     * a child is a Node or a Leaf with the lowest bit of the pointer set
+     */
+    struct Node{
+        uint8_t type;
+        uint16_t count;
+        uint32_t prefix_len;
+        unsigned char prefix[max_prefix];
+        Leaf *end_leaf;
+        explicit Node(uint8_t t):type(t),count(0),prefix_len(0),end_leaf(nullptr){}
+    };
+    // keys sorted, children[i] under keys[i]
+    struct Node4:Node{
+        unsigned char keys[4];
+        Node *children[4];
+        Node4():Node(node4){}
+    };
+    struct Node16:Node{
+        unsigned char keys[16];
+        Node *children[16];
+        Node16():Node(node16){}
+    };
+    // index[b] is 1 + the slot of the child under b, 0 for none
+    struct Node48:Node{
+        unsigned char index[256];
+        Node *children[48];
+        Node48():Node(node48){
+            memset(index,0,sizeof(index));
+            memset(children,0,sizeof(children));
+        }
+    };
+    struct Node256:Node{
+        Node *children[256];
+        Node256():Node(node256){
+            memset(children,0,sizeof(children));
+        }
+    };
+
+    Node *root;
+    // the header of the leaf list, end() points here
+    Link *head;
+    size_t length;
+
+    static inline bool is_leaf(Node *p) {return (uintptr_t) p&1;}
+    static inline Leaf *as_leaf(Node *p) {return (Leaf *) ((uintptr_t) p-1);}
+    static inline Node *tag(Leaf *l) {return (Node *) ((uintptr_t) l+1);}
+
+    /**
+     * the bytes of a and b compared like memcmp, a shorter string first
+     */
+    static int compare(const Encoded &a,const Encoded &b){
+        size_t n=a.len<b.len?a.len:b.len;
+        int c=n?memcmp(a.data,b.data,n):0;
+        if (c) return c;
+        return a.len<b.len?-1:(a.len>b.len?1:0);
+    }
+    static void link_before(Link *pos,Leaf *l){
+        l->next=pos;
+        l->prev=pos->prev;
+        l->prev->next=l;
+        pos->prev=l;
+    }
+    static void link_after(Link *pos,Leaf *l){
+        link_before(pos->next,l);
+    }
+    static void unlink(Leaf *l){
+        l->prev->next=l->next;
+        l->next->prev=l->prev;
+    }
+
+    static void free_node(Node *n){
+        switch (n->type){
+            case node4: delete (Node4 *) n; break;
+            case node16: delete (Node16 *) n; break;
+            case node48: delete (Node48 *) n; break;
+            default: delete (Node256 *) n; break;
+        }
+    }
+    static void copy_header(Node *to,Node *from){
+        to->count=from->count;
+        to->prefix_len=from->prefix_len;
+        memcpy(to->prefix,from->prefix,max_prefix);
+        to->end_leaf=from->end_leaf;
+    }
+
+    /**
+     * the slot of the child under byte b, nullptr if there is none
+     */
+    static Node **find_child(Node *n,unsigned char b){
+        switch (n->type){
+            case node4:{
+                Node4 *p=(Node4 *) n;
+                for (size_t i=0;i<p->count;++i)
+                    if (p->keys[i]==b) return &p->children[i];
+                return nullptr;
+            }
+            case node16:{
+                Node16 *p=(Node16 *) n;
+#if defined(__SSE2__)
+                __m128i cmp=_mm_cmpeq_epi8(_mm_set1_epi8((char) b),_mm_loadu_si128((const __m128i *) p->keys));
+                unsigned mask=(unsigned) _mm_movemask_epi8(cmp)&((1u<<p->count)-1);
+                return mask?&p->children[__builtin_ctz(mask)]:nullptr;
+#else
+                for (size_t i=0;i<p->count;++i)
+                    if (p->keys[i]==b) return &p->children[i];
+                return nullptr;
+#endif
+            }
+            case node48:{
+                Node48 *p=(Node48 *) n;
+                return p->index[b]?&p->children[p->index[b]-1]:nullptr;
+            }
+            default:{
+                Node256 *p=(Node256 *) n;
+                return p->children[b]?&p->children[b]:nullptr;
+            }
+        }
+    }
+    /**
+     * the child under the greatest byte less than b (below) or the least byte greater than b (above),
+     *   nullptr if there is none. b = 256 below gives the last child, b = -1 above the first one
+     */
+    static Node *child_below(Node *n,int b){
+        switch (n->type){
+            case node4:
+            case node16:{
+                const unsigned char *keys=n->type==node4?((Node4 *) n)->keys:((Node16 *) n)->keys;
+                Node **children=n->type==node4?((Node4 *) n)->children:((Node16 *) n)->children;
+                for (size_t i=n->count;i-->0;)
+                    if (keys[i]<b) return children[i];
+                return nullptr;
+            }
+            case node48:{
+                Node48 *p=(Node48 *) n;
+                for (int i=b-1;i>=0;--i)
+                    if (p->index[i]) return p->children[p->index[i]-1];
+                return nullptr;
+            }
+            default:{
+                Node256 *p=(Node256 *) n;
+                for (int i=b-1;i>=0;--i)
+                    if (p->children[i]) return p->children[i];
+                return nullptr;
+            }
+        }
+    }
+    static Node *child_above(Node *n,int b){
+        switch (n->type){
+            case node4:
+            case node16:{
+                const unsigned char *keys=n->type==node4?((Node4 *) n)->keys:((Node16 *) n)->keys;
+                Node **children=n->type==node4?((Node4 *) n)->children:((Node16 *) n)->children;
+                for (size_t i=0;i<n->count;++i)
+                    if (keys[i]>b) return children[i];
+                return nullptr;
+            }
+            case node48:{
+                Node48 *p=(Node48 *) n;
+                for (int i=b+1;i<256;++i)
+                    if (p->index[i]) return p->children[p->index[i]-1];
+                return nullptr;
+            }
+            default:{
+                Node256 *p=(Node256 *) n;
+                for (int i=b+1;i<256;++i)
+                    if (p->children[i]) return p->children[i];
+                return nullptr;
+            }
+        }
+    }
+    static Leaf *min_leaf(Node *n){
+        while (!is_leaf(n)){
+            if (n->end_leaf) return n->end_leaf;
+            n=child_above(n,-1);
+        }
+        return as_leaf(n);
+    }
+    static Leaf *max_leaf(Node *n){
+        while (!is_leaf(n)){
+            Node *c=child_below(n,256);
+            if (!c) return n->end_leaf;
+            n=c;
+        }
+        return as_leaf(n);
+    }
+
+    /**
+     * put child under byte b of the node on ref, which is replaced by a larger one when it is full
+     */
+    static void add_child(Node *&ref,unsigned char b,Node *child){
+        Node *n=ref;
+        switch (n->type){
+            case node4:
+            case node16:{
+                size_t cap=n->type==node4?4:16;
+                if (n->count==cap){
+                    if (n->type==node4){
+                        Node4 *p=(Node4 *) n;
+                        Node16 *q=new Node16;
+                        copy_header(q,p);
+                        memcpy(q->keys,p->keys,4);
+                        memcpy(q->children,p->children,4*sizeof(Node *));
+                        delete p;
+                        ref=n=q;
+                    }else{
+                        Node16 *p=(Node16 *) n;
+                        Node48 *q=new Node48;
+                        copy_header(q,p);
+                        for (size_t i=0;i<16;++i){
+                            q->children[i]=p->children[i];
+                            q->index[p->keys[i]]=(unsigned char) (i+1);
+                        }
+                        delete p;
+                        ref=q;
+                        add_child(ref,b,child);
+                        return;
+                    }
+                }
+                unsigned char *keys=n->type==node4?((Node4 *) n)->keys:((Node16 *) n)->keys;
+                Node **children=n->type==node4?((Node4 *) n)->children:((Node16 *) n)->children;
+                size_t i=n->count;
+                while (i&&keys[i-1]>b){
+                    keys[i]=keys[i-1];
+                    children[i]=children[i-1];
+                    --i;
+                }
+                keys[i]=b;
+                children[i]=child;
+                ++n->count;
+                return;
+            }
+            case node48:{
+                Node48 *p=(Node48 *) n;
+                if (p->count==48){
+                    Node256 *q=new Node256;
+                    copy_header(q,p);
+                    for (size_t i=0;i<256;++i)
+                        if (p->index[i]) q->children[i]=p->children[p->index[i]-1];
+                    delete p;
+                    ref=q;
+                    q->children[b]=child;
+                    ++q->count;
+                    return;
+                }
+                size_t slot=0;
+                while (p->children[slot]) ++slot;
+                p->children[slot]=child;
+                p->index[b]=(unsigned char) (slot+1);
+                ++p->count;
+                return;
+            }
+            default:{
+                Node256 *p=(Node256 *) n;
+                p->children[b]=child;
+                ++p->count;
+                return;
+            }
+        }
+    }
+    /**
+     * take the child under byte b out of the node on ref
+     */
+    static void remove_child(Node *ref,unsigned char b){
+        Node *n=ref;
+        switch (n->type){
+            case node4:
+            case node16:{
+                unsigned char *keys=n->type==node4?((Node4 *) n)->keys:((Node16 *) n)->keys;
+                Node **children=n->type==node4?((Node4 *) n)->children:((Node16 *) n)->children;
+                size_t i=0;
+                while (keys[i]!=b) ++i;
+                for (;i+1<n->count;++i){
+                    keys[i]=keys[i+1];
+                    children[i]=children[i+1];
+                }
+                break;
+            }
+            case node48:{
+                Node48 *p=(Node48 *) n;
+                p->children[p->index[b]-1]=nullptr;
+                p->index[b]=0;
+                break;
+            }
+            default:
+                ((Node256 *) n)->children[b]=nullptr;
+                break;
+        }
+        --n->count;
+    }
+    /**
+     * after a removal, move the node on ref into a smaller one, or replace it
+     *   by its only leaf or merge it with its only child node
+     */
+    static void shrink(Node *&ref){
+        Node *n=ref;
+        switch (n->type){
+            case node4:{
+                Node4 *p=(Node4 *) n;
+                if (p->count==0){
+                    ref=p->end_leaf?tag(p->end_leaf):nullptr;
+                    delete p;
+                }else if (p->count==1&&!p->end_leaf){
+                    Node *c=p->children[0];
+                    if (!is_leaf(c)){
+                        // the prefix of c grows by the prefix of p and the byte between them
+                        unsigned char buf[max_prefix];
+                        size_t len=p->prefix_len<max_prefix?p->prefix_len:max_prefix;
+                        memcpy(buf,p->prefix,len);
+                        if (len<max_prefix) buf[len++]=p->keys[0];
+                        for (size_t i=0;len<max_prefix&&i<c->prefix_len&&i<max_prefix;++i) buf[len++]=c->prefix[i];
+                        memcpy(c->prefix,buf,len);
+                        c->prefix_len+=p->prefix_len+1;
+                    }
+                    ref=c;
+                    delete p;
+                }
+                return;
+            }
+            case node16:{
+                Node16 *p=(Node16 *) n;
+                if (p->count>3) return;
+                Node4 *q=new Node4;
+                copy_header(q,p);
+                memcpy(q->keys,p->keys,p->count);
+                memcpy(q->children,p->children,p->count*sizeof(Node *));
+                delete p;
+                ref=q;
+                return;
+            }
+            case node48:{
+                Node48 *p=(Node48 *) n;
+                if (p->count>12) return;
+                Node16 *q=new Node16;
+                copy_header(q,p);
+                size_t k=0;
+                for (size_t i=0;i<256;++i)
+                    if (p->index[i]){
+                        q->keys[k]=(unsigned char) i;
+                        q->children[k++]=p->children[p->index[i]-1];
+                    }
+                delete p;
+                ref=q;
+                return;
+            }
+            default:{
+                Node256 *p=(Node256 *) n;
+                if (p->count>37) return;
+                Node48 *q=new Node48;
+                copy_header(q,p);
+                size_t k=0;
+                for (size_t i=0;i<256;++i)
+                    if (p->children[i]){
+                        q->children[k]=p->children[i];
+                        q->index[i]=(unsigned char) (++k);
+                    }
+                delete p;
+                ref=q;
+                return;
+            }
+        }
+    }
+
+    /**
+     * the number of bytes of the prefix of n that x matches from depth on,
+     *   the bytes past max_prefix are read from a leaf below n
+     */
+    static size_t prefix_match(Node *n,const Encoded &x,size_t depth){
+        size_t stored=n->prefix_len<max_prefix?n->prefix_len:max_prefix,i=0;
+        for (;i<stored&&depth+i<x.len;++i)
+            if (n->prefix[i]!=x[depth+i]) return i;
+        if (i==stored&&n->prefix_len>max_prefix){
+            Encoded k(min_leaf(n)->data.first);
+            for (;i<n->prefix_len&&depth+i<x.len;++i)
+                if (k[depth+i]!=x[depth+i]) return i;
+        }
+        return i;
+    }
+    /**
+     * the byte at index i of the prefix of n, which starts at depth
+     */
+    static unsigned char prefix_byte(Node *n,size_t i,size_t depth){
+        if (n->prefix_len<=max_prefix) return n->prefix[i];
+        Encoded k(min_leaf(n)->data.first);
+        return k[depth+i];
+    }
+
+    Leaf *find_leaf(const Encoded &x) const{
+        Node *n=root;
+        size_t depth=0;
+        while (n&&!is_leaf(n)){
+            // only the stored part of the prefix is checked here, the leaf is compared in full below
+            size_t stored=n->prefix_len<max_prefix?n->prefix_len:max_prefix;
+            if (depth+n->prefix_len>x.len) return nullptr;
+            for (size_t i=0;i<stored;++i)
+                if (n->prefix[i]!=x[depth+i]) return nullptr;
+            depth+=n->prefix_len;
+            if (depth==x.len) return n->end_leaf&&compare(Encoded(n->end_leaf->data.first),x)==0?n->end_leaf:nullptr;
+            Node **c=find_child(n,x[depth]);
+            n=c?*c:nullptr;
+            ++depth;
+        }
+        if (!n) return nullptr;
+        Leaf *l=as_leaf(n);
+        return compare(Encoded(l->data.first),x)==0?l:nullptr;
+    }
+    /**
+     * the first leaf whose key is not less than x, head if there is none
+     */
+    Link *lower_bound_leaf(const Encoded &x) const{
+        Node *n=root;
+        size_t depth=0;
+        if (!n) return head;
+        while (!is_leaf(n)){
+            size_t m=prefix_match(n,x,depth);
+            if (m<n->prefix_len){
+                // x ends inside the prefix, or differs from it: the whole subtree is on one side of x
+                if (depth+m==x.len||x[depth+m]<prefix_byte(n,m,depth)) return min_leaf(n);
+                return max_leaf(n)->next;
+            }
+            depth+=n->prefix_len;
+            if (depth==x.len) return min_leaf(n);
+            Node **c=find_child(n,x[depth]);
+            if (!c){
+                Node *above=child_above(n,x[depth]);
+                return above?min_leaf(above):max_leaf(n)->next;
+            }
+            n=*c;
+            ++depth;
+        }
+        Leaf *l=as_leaf(n);
+        return compare(Encoded(l->data.first),x)>=0?l:l->next;
+    }
+    /**
+     * insert value with key bytes x under the subtree on ref, whose keys share x[0, depth).
+     * return the leaf with the key and set inserted if it is new
+     */
+    Leaf *insert_leaf(Node *&ref,const Encoded &x,const value_type &value,size_t depth,bool &inserted){
+        Node *n=ref;
+        if (is_leaf(n)){
+            Leaf *l=as_leaf(n);
+            Encoded k(l->data.first);
+            int c=compare(k,x);
+            if (c==0) return l;
+            size_t i=depth;
+            while (i<k.len&&i<x.len&&k[i]==x[i]) ++i;
+            Node4 *p=new Node4;
+            p->prefix_len=(uint32_t) (i-depth);
+            memcpy(p->prefix,x.data+depth,p->prefix_len<max_prefix?p->prefix_len:max_prefix);
+            Node *q=p;
+            Leaf *nl=new Leaf(value);
+            if (i==x.len) p->end_leaf=nl;
+            else add_child(q,x[i],tag(nl));
+            if (i==k.len) p->end_leaf=l;
+            else add_child(q,k[i],n);
+            if (c>0) link_before(l,nl);
+            else link_after(l,nl);
+            ref=q;
+            inserted=true;
+            return nl;
+        }
+        if (n->prefix_len){
+            size_t m=prefix_match(n,x,depth);
+            if (m<n->prefix_len){
+                // split the prefix at m: a new node takes the bytes before it, n keeps the ones after
+                Node4 *p=new Node4;
+                p->prefix_len=(uint32_t) m;
+                memcpy(p->prefix,n->prefix,m<max_prefix?m:max_prefix);
+                Leaf *first=min_leaf(n),*last=max_leaf(n);
+                unsigned char b;
+                if (n->prefix_len<=max_prefix){
+                    b=n->prefix[m];
+                    n->prefix_len-=(uint32_t) (m+1);
+                    memmove(n->prefix,n->prefix+m+1,n->prefix_len);
+                }else{
+                    Encoded k(first->data.first);
+                    b=k[depth+m];
+                    n->prefix_len-=(uint32_t) (m+1);
+                    memcpy(n->prefix,k.data+depth+m+1,n->prefix_len<max_prefix?n->prefix_len:max_prefix);
+                }
+                Node *q=p;
+                add_child(q,b,n);
+                Leaf *nl=new Leaf(value);
+                if (depth+m==x.len){
+                    p->end_leaf=nl;
+                    link_before(first,nl);
+                }else{
+                    add_child(q,x[depth+m],tag(nl));
+                    if (x[depth+m]<b) link_before(first,nl);
+                    else link_after(last,nl);
+                }
+                ref=q;
+                inserted=true;
+                return nl;
+            }
+            depth+=n->prefix_len;
+        }
+        if (depth==x.len){
+            if (n->end_leaf) return n->end_leaf;
+            Leaf *nl=new Leaf(value);
+            link_before(min_leaf(n),nl);
+            n->end_leaf=nl;
+            inserted=true;
+            return nl;
+        }
+        Node **c=find_child(n,x[depth]);
+        if (c) return insert_leaf(*c,x,value,depth+1,inserted);
+        Node *below=child_below(n,x[depth]);
+        Leaf *nl=new Leaf(value);
+        if (below) link_after(max_leaf(below),nl);
+        else if (n->end_leaf) link_after(n->end_leaf,nl);
+        else link_before(min_leaf(n),nl);
+        add_child(ref,x[depth],tag(nl));
+        inserted=true;
+        return nl;
+    }
+    /**
+     * erase the leaf with key bytes x from the subtree on ref, return whether there was one
+     */
+    bool erase_leaf(Node *&ref,const Encoded &x,size_t depth){
+        Node *n=ref;
+        if (is_leaf(n)){
+            Leaf *l=as_leaf(n);
+            if (compare(Encoded(l->data.first),x)!=0) return false;
+            unlink(l);
+            delete l;
+            ref=nullptr;
+            return true;
+        }
+        if (prefix_match(n,x,depth)<n->prefix_len) return false;
+        depth+=n->prefix_len;
+        if (depth==x.len){
+            if (!n->end_leaf) return false;
+            unlink(n->end_leaf);
+            delete n->end_leaf;
+            n->end_leaf=nullptr;
+            shrink(ref);
+            return true;
+        }
+        Node **c=find_child(n,x[depth]);
+        if (!c) return false;
+        if (!is_leaf(*c)) return erase_leaf(*c,x,depth+1);
+        Leaf *l=as_leaf(*c);
+        if (compare(Encoded(l->data.first),x)!=0) return false;
+        unlink(l);
+        delete l;
+        remove_child(n,x[depth]);
+        shrink(ref);
+        return true;
+    }
+    void destroy(Node *n){
+        if (!n) return;
+        if (is_leaf(n)){
+            delete as_leaf(n);
+            return;
+        }
+        if (n->end_leaf) delete n->end_leaf;
+        switch (n->type){
+            case node4: for (size_t i=0;i<n->count;++i) destroy(((Node4 *) n)->children[i]); break;
+            case node16: for (size_t i=0;i<n->count;++i) destroy(((Node16 *) n)->children[i]); break;
+            case node48: for (size_t i=0;i<48;++i) destroy(((Node48 *) n)->children[i]); break;
+            default: for (size_t i=0;i<256;++i) destroy(((Node256 *) n)->children[i]); break;
+        }
+        free_node(n);
+    }
+    void init(){
+        root=nullptr;
+        head=new Link;
+        head->prev=head->next=head;
+        length=0;
+    }
+
+public:
+	class const_iterator;
+	class iterator {
+        friend class radix_map;
+	private:
+        radix_map *map_ptr;
+        Link *cur;
+	public:
+		iterator():map_ptr(nullptr),cur(nullptr) {}
+		iterator(const iterator &other):map_ptr(other.map_ptr),cur(other.cur) {}
+        iterator(radix_map *_map_ptr,Link *_cur):map_ptr(_map_ptr),cur(_cur) {}
+		iterator operator++(int) {
+            iterator tmp=*this;
+            ++*this;
+            return tmp;
+        }
+		iterator & operator++() {
+            if (!map_ptr||cur==map_ptr->head) throw invalid_iterator();
+            cur=cur->next;
+            return *this;
+        }
+		iterator operator--(int) {
+            iterator tmp=*this;
+            --*this;
+            return tmp;
+        }
+		iterator & operator--() {
+            if (!map_ptr||cur->prev==map_ptr->head) throw invalid_iterator();
+            cur=cur->prev;
+            return *this;
+        }
+		value_type & operator*() const {
+            if (!map_ptr||cur==map_ptr->head) throw invalid_iterator();
+            return static_cast<Leaf *>(cur)->data;
+        }
+		bool operator==(const iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&cur==rhs.cur;
+        }
+		bool operator==(const const_iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&cur==rhs.cur;
+        }
+		bool operator!=(const iterator &rhs) const {
+            return !(*this==rhs);
+        }
+		bool operator!=(const const_iterator &rhs) const {
+            return !(*this==rhs);
+        }
+		value_type* operator->() const noexcept {
+            return &static_cast<Leaf *>(cur)->data;
+        }
+	};
+	class const_iterator {
+    friend class radix_map;
+    private:
+        const radix_map *map_ptr;
+        Link *cur;
+    public:
+        const_iterator():map_ptr(nullptr),cur(nullptr) {}
+        const_iterator(const const_iterator &other):map_ptr(other.map_ptr),cur(other.cur) {}
+        const_iterator(const iterator &other):map_ptr(other.map_ptr),cur(other.cur) {}
+        const_iterator(const radix_map *_map_ptr,Link *_cur):map_ptr(_map_ptr),cur(_cur) {}
+        const_iterator operator++(int) {
+            const_iterator tmp=*this;
+            ++*this;
+            return tmp;
+        }
+        const_iterator & operator++() {
+            if (!map_ptr||cur==map_ptr->head) throw invalid_iterator();
+            cur=cur->next;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator tmp=*this;
+            --*this;
+            return tmp;
+        }
+        const_iterator & operator--() {
+            if (!map_ptr||cur->prev==map_ptr->head) throw invalid_iterator();
+            cur=cur->prev;
+            return *this;
+        }
+        const value_type & operator*() const {
+            if (!map_ptr||cur==map_ptr->head) throw invalid_iterator();
+            return static_cast<Leaf *>(cur)->data;
+        }
+        bool operator==(const iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&cur==rhs.cur;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return map_ptr==rhs.map_ptr&&cur==rhs.cur;
+        }
+        bool operator!=(const iterator &rhs) const {
+            return !(*this==rhs);
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this==rhs);
+        }
+        const value_type* operator->() const noexcept {
+            return &static_cast<Leaf *>(cur)->data;
+        }
+	};
+
+	radix_map() {
+        init();
+    }
+	radix_map(const radix_map &other) {
+        init();
+        for (Link *p=other.head->next;p!=other.head;p=p->next) insert(static_cast<Leaf *>(p)->data);
+    }
+	radix_map & operator=(const radix_map &other) {
+        if (this==&other) return *this;
+        clear();
+        for (Link *p=other.head->next;p!=other.head;p=p->next) insert(static_cast<Leaf *>(p)->data);
+        return *this;
+    }
+	~radix_map() {
+        destroy(root);
+        delete head;
+    }
+	/**
+	 * access specified element with bounds checking, throw index_out_of_bound if key is not found.
+	 */
+	T & at(const Key &key) {
+        Leaf *l=find_leaf(Encoded(key));
+        if (!l) throw index_out_of_bound();
+        return l->data.second;
+    }
+	const T & at(const Key &key) const {
+        Leaf *l=find_leaf(Encoded(key));
+        if (!l) throw index_out_of_bound();
+        return l->data.second;
+    }
+	/**
+	 * access specified element, inserting a default constructed value if key does not exist.
+	 */
+	T & operator[](const Key &key) {
+        Leaf *l=find_leaf(Encoded(key));
+        if (!l) l=static_cast<Leaf *>(insert(value_type(key,T())).first.cur);
+        return l->data.second;
+    }
+	const T & operator[](const Key &key) const {
+        return at(key);
+    }
+	iterator begin() {
+        return iterator(this,head->next);
+    }
+	const_iterator cbegin() const {
+        return const_iterator(this,head->next);
+    }
+	iterator end() {
+        return iterator(this,head);
+    }
+	const_iterator cend() const {
+        return const_iterator(this,head);
+    }
+	bool empty() const {
+        return !length;
+    }
+	size_t size() const {
+        return length;
+    }
+	void clear() {
+        destroy(root);
+        root=nullptr;
+        head->prev=head->next=head;
+        length=0;
+    }
+	/**
+	 * insert an element, return the iterator to the element with its key and whether it was inserted.
+	 */
+	pair<iterator, bool> insert(const value_type &value) {
+        Encoded x(value.first);
+        if (!root){
+            Leaf *l=new Leaf(value);
+            link_before(head,l);
+            root=tag(l);
+            ++length;
+            return pair<iterator, bool>(iterator(this,l),true);
+        }
+        bool inserted=false;
+        Leaf *l=insert_leaf(root,x,value,0,inserted);
+        if (inserted) ++length;
+        return pair<iterator, bool>(iterator(this,l),inserted);
+    }
+	/**
+	 * erase the element at pos, throw invalid_iterator if pos is end() or belongs to another map.
+	 */
+	void erase(iterator pos) {
+        if (pos.map_ptr!=this||pos.cur==head) throw invalid_iterator();
+        // the key is encoded before its leaf goes away
+        Key key(static_cast<Leaf *>(pos.cur)->data.first);
+        erase_leaf(root,Encoded(key),0);
+        --length;
+    }
+	/**
+	 * erase the element with key, return the number of erased elements (0 or 1).
+	 */
+	size_t erase(const Key &key) {
+        if (!root||!erase_leaf(root,Encoded(key),0)) return 0;
+        --length;
+        return 1;
+    }
+	size_t count(const Key &key) const {
+        return find_leaf(Encoded(key))?1:0;
+    }
+	iterator find(const Key &key) {
+        Leaf *l=find_leaf(Encoded(key));
+        return iterator(this,l?l:head);
+    }
+	const_iterator find(const Key &key) const {
+        Leaf *l=find_leaf(Encoded(key));
+        return const_iterator(this,l?l:head);
+    }
+	iterator lower_bound(const Key &key) {
+        return iterator(this,lower_bound_leaf(Encoded(key)));
+    }
+	const_iterator lower_bound(const Key &key) const {
+        return const_iterator(this,lower_bound_leaf(Encoded(key)));
+    }
+	iterator upper_bound(const Key &key) {
+        Encoded x(key);
+        Link *p=lower_bound_leaf(x);
+        if (p!=head&&compare(Encoded(static_cast<Leaf *>(p)->data.first),x)==0) p=p->next;
+        return iterator(this,p);
+    }
+	const_iterator upper_bound(const Key &key) const {
+        Encoded x(key);
+        Link *p=lower_bound_leaf(x);
+        if (p!=head&&compare(Encoded(static_cast<Leaf *>(p)->data.first),x)==0) p=p->next;
+        return const_iterator(this,p);
+    }
+};
+
+}
+
+#endif